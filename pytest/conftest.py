@@ -56,6 +56,23 @@ def nexus_output_file_no_strings(output_tmpdir, base_name_no_strings):
     return os.path.join(output_tmpdir, base_name_no_strings + '.h5')
 
 
+@pytest.fixture(scope = 'session')
+def base_name_debug_steps():
+    return 'NEXT100_debug_steps'
+@pytest.fixture(scope = 'session')
+def nexus_output_file_debug_steps(output_tmpdir, base_name_debug_steps):
+    return os.path.join(output_tmpdir, base_name_debug_steps + '.h5')
+
+
+@pytest.fixture(scope = 'session')
+def base_name_rollover():
+    return 'NEXT100_rollover'
+@pytest.fixture(scope = 'session')
+def nexus_output_files_rollover(output_tmpdir, base_name_rollover):
+    return [os.path.join(output_tmpdir, f'{base_name_rollover}_{i:03d}.h5')
+            for i in range(3)]
+
+
 
 @pytest.fixture(scope = 'session')
 def new_detector(nexus_full_output_file_new):
@@ -0,0 +1,98 @@
+import pytest
+
+import os
+import subprocess
+
+import numpy  as np
+import pandas as pd
+
+
+def run_el(config_tmpdir, output_tmpdir, NEXUSDIR, name, el_config, nevents=6):
+    base_name = f'NEXT100_el_{name}'
+    output    = os.path.join(output_tmpdir, base_name)
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+/nexus/RegisterStackingAction DefaultStackingAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield true
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 5. keV
+/Generator/SingleParticle/max_energy 5. keV
+/Generator/SingleParticle/region CENTER
+
+{el_config}
+
+/nexus/persistency/output_file {output}
+/nexus/random_seed 31
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', str(nevents), init_path],
+                   check=True, cwd=output_tmpdir)
+
+    sns = pd.read_hdf(output + '.h5', 'MC/sns_response')
+    charge = sns.groupby('event_id').charge.sum()
+    return charge.reindex(range(nevents), fill_value=0)
+
+
+def test_lazy_emission_keeps_the_detected_light(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    Generating the EL photons in small batches once the
+    stack is empty detects, on average, the same light as
+    generating them along with the ionization electrons.
+    """
+    eager = run_el(config_tmpdir, output_tmpdir, NEXUSDIR, 'eager', '')
+    lazy  = run_el(config_tmpdir, output_tmpdir, NEXUSDIR, 'lazy', """
+/Physics/Electroluminescence/lazy_emission true
+/Physics/Electroluminescence/lazy_memory_budget 0.1
+""")
+
+    assert (eager > 0).all()
+    assert (lazy  > 0).all()
+    assert np.isclose(lazy.sum(), eager.sum(), rtol=0.05)
+
+
+@pytest.mark.parametrize('lazy', ('false', 'true'))
+def test_cached_el_response_agrees_with_tracking(config_tmpdir, output_tmpdir, NEXUSDIR, lazy):
+    """
+    Once the response of the cells has been learned in the first event,
+    sampling it gives, on average, the light of the tracked photons.
+    This holds as well with lazy emission, whose photons are only
+    tracked at the end of the event.
+    """
+    tracked = run_el(config_tmpdir, output_tmpdir, NEXUSDIR, f'tracked_{lazy}', f"""
+/Physics/Electroluminescence/lazy_emission {lazy}
+""")
+    cached  = run_el(config_tmpdir, output_tmpdir, NEXUSDIR, f'cached_{lazy}', f"""
+/Physics/Electroluminescence/lazy_emission {lazy}
+/Physics/Electroluminescence/response_cache true
+/Physics/Electroluminescence/response_cache_file el_cache_{lazy}.csv
+/Physics/Electroluminescence/response_cache_cell_size 50. mm
+/Physics/Electroluminescence/response_cache_electrons 20
+""")
+
+    # The first event only learns
+    assert (cached > 0).all()
+    assert np.isclose(cached[1:].sum(), tracked[1:].sum(), rtol=0.05)
@@ -0,0 +1,76 @@
+import pytest
+
+import os
+import subprocess
+
+import pandas as pd
+
+
+def run_seeds(config_tmpdir, output_tmpdir, NEXUSDIR, name, seed, nevents, save_seeds):
+    base_name = f'NEXT100_event_seed_{name}'
+    output    = os.path.join(output_tmpdir, base_name)
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 10. keV
+/Generator/SingleParticle/max_energy 100. keV
+/Generator/SingleParticle/region CENTER
+
+/nexus/persistency/output_file {output}
+/nexus/persistency/save_rng_seeds {save_seeds}
+/nexus/random_seed {seed}
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', str(nevents), init_path], check=True)
+
+    particles = pd.read_hdf(output + '.h5', 'MC/particles')
+    index     = pd.read_hdf(output + '.h5', 'MC/event_index')
+    return particles, index
+
+
+def test_event_seed_reproduces_the_event(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The seed stored for an event is captured before any of its random
+    numbers is drawn, so a job started with it repeats the event.
+    """
+    particles, index = run_seeds(config_tmpdir, output_tmpdir, NEXUSDIR,
+                                 'all', 41, 3, 'true')
+
+    assert (index.rng_seed > 0).all()
+    assert len(index.rng_seed.unique()) == 3
+
+    seed = index[index.event_id == 2].rng_seed.values[0]
+    replay, _ = run_seeds(config_tmpdir, output_tmpdir, NEXUSDIR,
+                          'replay', seed, 1, 'false')
+
+    columns = ['particle_id', 'particle_name', 'kin_energy',
+               'initial_x', 'initial_y', 'initial_z',
+               'final_x', 'final_y', 'final_z', 'length']
+    original = particles[particles.event_id == 2][columns].reset_index(drop=True)
+    repeated = replay[columns].reset_index(drop=True)
+    pd.testing.assert_frame_equal(original, repeated)
@@ -0,0 +1,91 @@
+import pytest
+
+import os
+import subprocess
+
+import numpy  as np
+import pandas as pd
+
+
+def run_fibers(config_tmpdir, output_tmpdir, NEXUSDIR, fast):
+    base_name = f'FLEX_fibers_fast_{fast}'
+    output    = os.path.join(output_tmpdir, base_name)
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry NextFlex
+/nexus/RegisterGenerator ScintillationGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/NextFlex/gas              enrichedXe
+/Geometry/NextFlex/gas_pressure     15. bar
+/Geometry/NextFlex/active_length    116. cm
+/Geometry/NextFlex/active_diam      100. cm
+/Geometry/NextFlex/fc_wls_mat       TPB
+/Geometry/NextFlex/fc_with_fibers   true
+/Geometry/NextFlex/fiber_mat        EJ280
+/Geometry/NextFlex/fiber_claddings  2
+/Geometry/NextFlex/fiber_fast_transport {fast}
+/Geometry/NextFlex/fiber_sensor_time_binning 1. ns
+/Geometry/NextFlex/ep_with_PMTs     false
+/Geometry/NextFlex/ep_with_teflon   true
+
+/Geometry/NextFlex/specific_vertex  300. 200. 200. mm
+/Generator/ScintGenerator/region    AD_HOC
+/Generator/ScintGenerator/nphotons  100000
+
+/nexus/persistency/output_file {output}
+/nexus/random_seed 71
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', '5', init_path], check=True)
+
+    sns = pd.read_hdf(output + '.h5', 'MC/sns_response')
+    pos = pd.read_hdf(output + '.h5', 'MC/sns_positions')
+    pos = pos[pos.sensor_name.str.startswith('F_SENSOR')]
+    pos = pos.assign(phi = np.arctan2(pos.y, pos.x))
+    return sns.merge(pos[['sensor_id', 'phi']], on='sensor_id')
+
+
+def test_fiber_fast_transport_agrees_with_tracking(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The light detected by the fiber sensors when the photons trapped in
+    the fibers are moved to their ends by the fast model is distributed
+    in azimuth and in time as the one of the photons tracked all along.
+    The light is emitted off the axis, so that it is not uniform in azimuth.
+    """
+    full = run_fibers(config_tmpdir, output_tmpdir, NEXUSDIR, 'false')
+    fast = run_fibers(config_tmpdir, output_tmpdir, NEXUSDIR, 'true')
+
+    assert full.charge.sum() > 1000
+    assert fast.charge.sum() == pytest.approx(full.charge.sum(), rel=0.05)
+
+    bins = np.linspace(-np.pi, np.pi, 13)
+    full_phi, _ = np.histogram(full.phi, bins=bins, weights=full.charge, density=True)
+    fast_phi, _ = np.histogram(fast.phi, bins=bins, weights=fast.charge, density=True)
+    np.testing.assert_allclose(fast_phi, full_phi, atol=0.1 * full_phi.max())
+
+    full_time = np.average(full.time_bin, weights=full.charge)
+    fast_time = np.average(fast.time_bin, weights=fast.charge)
+    assert fast_time == pytest.approx(full_time, rel=0.05)
+
+    full_spread = np.sqrt(np.average((full.time_bin - full_time)**2, weights=full.charge))
+    fast_spread = np.sqrt(np.average((fast.time_bin - fast_time)**2, weights=fast.charge))
+    assert fast_spread == pytest.approx(full_spread, rel=0.1)
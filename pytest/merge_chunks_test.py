@@ -0,0 +1,149 @@
+import pytest
+
+import os
+import importlib.util
+import subprocess
+
+import numpy  as np
+import pandas as pd
+import tables as tb
+
+
+INIT = """
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator {generator}
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+/nexus/RegisterStackingAction DefaultStackingAction
+
+/nexus/RegisterMacro {config}
+"""
+
+
+def run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR, base_name, generator, config, nevents):
+    output      = os.path.join(output_tmpdir, base_name)
+    init_path   = os.path.join(config_tmpdir, base_name + '.init.mac')
+    config_path = os.path.join(config_tmpdir, base_name + '.config.mac')
+
+    with open(init_path, 'w') as f:
+        f.write(INIT.format(generator=generator, config=config_path))
+    with open(config_path, 'w') as f:
+        f.write(f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield true
+/PhysicsList/Nexus/photon_weight 50.
+{config}
+/nexus/persistency/output_file {output}
+""")
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', str(nevents), init_path], check=True)
+    return output + '.h5'
+
+
+@pytest.fixture(scope='module')
+def merge_chunks(NEXUSDIR):
+    path = os.path.join(NEXUSDIR, 'scripts', 'merge_chunks.py')
+    spec = importlib.util.spec_from_file_location('merge_chunks', path)
+    module = importlib.util.module_from_spec(spec)
+    spec.loader.exec_module(module)
+    return module.merge_chunks
+
+
+@pytest.fixture(scope='module')
+def chunk_files(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    Transport-only job storing the ionization hits of 3 events,
+    numbered from 10, and the two chunks of their replay.
+    """
+    source = run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR, 'NEXT100_chunks_source',
+                       'SingleParticleGenerator', """
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 10. keV
+/Generator/SingleParticle/max_energy 10. keV
+/Generator/SingleParticle/region CENTER
+/Actions/DefaultStackingAction/ionization_only true
+/nexus/persistency/save_rng_seeds true
+/nexus/persistency/start_id 10
+/nexus/random_seed 61
+""", 3)
+
+    chunks = []
+    for chunk in range(2):
+        chunks.append(run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR,
+                                f'NEXT100_chunks_{chunk}', 'HitsReplayGenerator', f"""
+/Generator/HitsReplay/input_file {source}
+/Generator/HitsReplay/num_chunks 2
+/Generator/HitsReplay/chunk {chunk}
+/nexus/random_seed 62
+""", 3))
+
+    return source, chunks
+
+
+def test_merge_sums_the_chunks(output_tmpdir, chunk_files, merge_chunks):
+    """
+    The sensor responses of the chunks are summed per sensor and time bin,
+    their hits concatenated and the event index points to the merged rows.
+    """
+    source, chunks = chunk_files
+    merged = os.path.join(output_tmpdir, 'NEXT100_chunks_merged.h5')
+    merge_chunks(merged, chunks)
+
+    responses = [pd.read_hdf(f, 'MC/sns_response') for f in chunks]
+    response  = pd.read_hdf(merged, 'MC/sns_response')
+
+    assert all(r.charge.sum() > 0 for r in responses)
+    assert response.charge.sum() == sum(r.charge.sum() for r in responses)
+    assert not response.duplicated(['event_id', 'sensor_id', 'time_bin']).any()
+
+    index = pd.read_hdf(merged, 'MC/event_index')
+    assert list(index.event_id) == [0, 1, 2]
+
+    with tb.open_file(merged) as h5:
+        has_hits = 'hits' in h5.root.MC
+    if has_hits:
+        hits = pd.read_hdf(merged, 'MC/hits')
+        assert len(hits) == sum(len(pd.read_hdf(f, 'MC/hits')) for f in chunks)
+        for _, evt in index.iterrows():
+            first, count = int(evt.hits_first), int(evt.hits_count)
+            assert np.all(hits.event_id.values[first:first+count] == evt.event_id)
+
+    # The merged file stands for all the chunks
+    config = pd.read_hdf(merged, 'MC/configuration')
+    assert '/Generator/HitsReplay/chunk' not in config.param_key.values
+    assert '/Generator/HitsReplay/num_chunks' in config.param_key.values
+
+
+def test_merge_renumbers_the_events(output_tmpdir, chunk_files, merge_chunks):
+    """
+    With the replayed file, the merged events take their original IDs.
+    """
+    source, chunks = chunk_files
+    merged = os.path.join(output_tmpdir, 'NEXT100_chunks_renumbered.h5')
+    merge_chunks(merged, chunks, source)
+
+    source_ids = pd.read_hdf(source, 'MC/event_index').event_id.values
+    assert list(source_ids) == [10, 11, 12]
+
+    for table in ('sns_response', 'event_index'):
+        ids = pd.read_hdf(merged, 'MC/' + table).event_id.unique()
+        assert set(ids) <= set(source_ids)
+    assert list(pd.read_hdf(merged, 'MC/event_index').event_id) == [10, 11, 12]
+
+
+def test_merge_rejects_missing_chunks(output_tmpdir, chunk_files, merge_chunks):
+    """
+    Merging only some of the chunks of the events is an error.
+    """
+    _, chunks = chunk_files
+    with pytest.raises(ValueError):
+        merge_chunks(os.path.join(output_tmpdir, 'NEXT100_chunks_partial.h5'), chunks[:1])
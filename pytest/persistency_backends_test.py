@@ -0,0 +1,72 @@
+import pytest
+
+import os
+import subprocess
+
+
+@pytest.mark.parametrize('backend', ['PersistencyManager',
+                                     'NullPersistencyManager',
+                                     'MemoryPersistencyManager'])
+def test_backends_accept_the_same_macro(config_tmpdir, output_tmpdir, NEXUSDIR, backend):
+    """
+    A configuration macro using all the commands of the default persistency
+    manager runs with each backend, the others ignoring what does not apply.
+    """
+    base_name = f'NEXT100_{backend}'
+    output    = os.path.join(output_tmpdir, base_name)
+    nexus_exe = NEXUSDIR + '/bin/nexus'
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager {backend}
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 10. keV
+/Generator/SingleParticle/max_energy 10. keV
+/Generator/SingleParticle/region CENTER
+
+/nexus/persistency/output_file {output}
+/nexus/persistency/event_type background
+/nexus/persistency/start_id 0
+/nexus/persistency/save_strings true
+/nexus/persistency/save_particles true
+/nexus/persistency/swmr false
+/nexus/persistency/swmr_flush_interval 10
+/nexus/persistency/max_file_size 0
+/nexus/persistency/events_per_file 0
+/nexus/persistency/save_rng_seeds true
+/nexus/random_seed 17
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    log = subprocess.run([nexus_exe, '-b', '-n', '2', init_path], check=True,
+                         capture_output=True, text=True)
+
+    # Geant4 reports unknown commands and stops the macro, without failing
+    for output_text in (log.stdout, log.stderr):
+        assert 'COMMAND NOT FOUND' not in output_text
+        assert 'Batch is interrupted' not in output_text
+
+    # Only the default backend writes an output file
+    assert os.path.exists(output + '.h5') == (backend == 'PersistencyManager')
@@ -15,6 +15,7 @@ def test_hdf5_structure(detectors):
             assert 'sns_response'  in h5out.root.MC
             assert 'configuration' in h5out.root.MC
             assert 'sns_positions' in h5out.root.MC
+            assert 'event_index'   in h5out.root.MC
 
 
             pcolumns = h5out.root.MC.particles.colnames
@@ -76,6 +77,16 @@ def test_hdf5_structure(detectors):
             assert 'z'           in sposcolumns
 
 
+            icolumns = h5out.root.MC.event_index.colnames
+
+            assert 'event_id'        in icolumns
+            assert 'hits_first'      in icolumns
+            assert 'hits_count'      in icolumns
+            assert 'particles_first' in icolumns
+            assert 'particles_count' in icolumns
+            assert 'rng_seed'        in icolumns
+
+
     filename, _, _, _, _ = detectors
     if "DEMOPP" in filename:
         for run in ["run5", "run7", "run8", "run9", "run10"]:
@@ -107,6 +118,34 @@ def test_particle_ids_of_hits_exist_in_particle_table(detectors):
         test(filename)
 
 
+def test_event_index_points_to_the_event_rows(detectors):
+    """
+    Check that the event index gives the rows of the hits
+    and particles tables of each event.
+    """
+
+    def test(filename):
+        index     = pd.read_hdf(filename, 'MC/event_index')
+        hits      = pd.read_hdf(filename, 'MC/hits')
+        particles = pd.read_hdf(filename, 'MC/particles')
+
+        assert index.hits_count     .sum() == len(hits)
+        assert index.particles_count.sum() == len(particles)
+
+        for evt in index.itertuples():
+            first, count = int(evt.hits_first), int(evt.hits_count)
+            assert np.all(hits.event_id.values[first:first+count] == evt.event_id)
+            first, count = int(evt.particles_first), int(evt.particles_count)
+            assert np.all(particles.event_id.values[first:first+count] == evt.event_id)
+
+    filename, _, _, _, _ = detectors
+    if "DEMOPP" in filename:
+        for run in ["run5", "run7", "run8", "run9", "run10"]:
+            test(filename.format(run=run))
+    else:
+        test(filename)
+
+
 def test_hit_labels(detectors):
     """Check that there is at least one hit in the ACTIVE volume."""
 
@@ -209,3 +248,66 @@ def test_string_map_ids_are_in_hits_particles_tables(nexus_output_file_no_string
     assert np.all(np.isin(particles.final_volume.values, map_ids))
     assert np.all(np.isin(particles.creator_proc.values, map_ids))
     assert np.all(np.isin(particles.final_proc.values, map_ids))
+
+
+def test_rollover_files_are_self_contained(nexus_output_files_rollover):
+    """Check that each file of a split output has its own configuration
+    and string map, and that event IDs continue across files."""
+
+    event_ids = []
+    for filename in nexus_output_files_rollover:
+        conf      = pd.read_hdf(filename, 'MC/configuration')
+        particles = pd.read_hdf(filename, 'MC/particles')
+        str_map   = pd.read_hdf(filename, 'MC/string_map')
+
+        conf = conf.set_index('param_key')
+        assert conf.loc['saved_events'].param_value == '1'
+        assert conf.loc['/nexus/persistency/events_per_file'].param_value == '1'
+
+        assert np.all(np.isin(particles.particle_name.values, str_map.name_id.values))
+
+        event_ids.extend(np.unique(particles.event_id.values))
+
+    assert event_ids == list(range(10, 10 + len(nexus_output_files_rollover)))
+
+
+def test_telemetry_summary_is_saved(nexus_output_file_no_strings):
+    """Check that the run telemetry summary is saved in the configuration table."""
+
+    conf = pd.read_hdf(nexus_output_file_no_strings, 'MC/configuration')
+    conf = conf.set_index('param_key')
+
+    assert 'telemetry_wall_time'         in conf.index
+    assert 'telemetry_events_per_second' in conf.index
+    assert 'telemetry_peak_rss'          in conf.index
+    assert 'telemetry_event_time_max'    in conf.index
+    assert conf.loc['telemetry_events'].param_value == conf.loc['num_events'].param_value
+
+
+def test_debug_steps_are_saved(nexus_output_file_debug_steps):
+    """Check that the steps stored by SaveAllSteppingAction are read back
+    with their names, step numbering and event IDs."""
+
+    steps   = pd.read_hdf(nexus_output_file_debug_steps, 'DEBUG/steps')
+    str_map = pd.read_hdf(nexus_output_file_debug_steps, 'DEBUG/string_map')
+
+    for column in ['event_id', 'particle_id', 'particle_name', 'step_id',
+                   'initial_volume', 'final_volume', 'proc_name',
+                   'initial_x', 'initial_y', 'initial_z',
+                   'final_x', 'final_y', 'final_z', 'time']:
+        assert column in steps.columns
+
+    assert len(steps) > 0
+    assert sorted(steps.event_id.unique()) == [0, 1]
+
+    # Names are stored as IDs of the string map
+    names = str_map.set_index('name_id').name
+    for column in ['particle_name', 'initial_volume', 'final_volume', 'proc_name']:
+        assert np.all(np.isin(steps[column].values, names.index.values))
+    particle_names = {n.decode() if isinstance(n, bytes) else n
+                      for n in names[steps.particle_name.unique()]}
+    assert particle_names == {'e-'}
+
+    # Steps are numbered from 0 for each track of each event
+    for _, track in steps.groupby(['event_id', 'particle_id']):
+        assert list(track.step_id) == list(range(len(track)))
@@ -0,0 +1,76 @@
+import os
+import subprocess
+
+
+def run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR, cache, pressure):
+    base_name = f'NEXT100_physics_table_cache_{pressure}bar'
+    output    = os.path.join(output_tmpdir, base_name)
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure {pressure} bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 100. keV
+/Generator/SingleParticle/max_energy 100. keV
+/Generator/SingleParticle/region CENTER
+
+/nexus/physics_table_cache {cache}
+/nexus/persistency/output_file {output}
+/nexus/random_seed 13
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    result = subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', '1', init_path],
+                            check=True, capture_output=True, text=True)
+    return result.stdout
+
+
+def test_physics_table_cache_is_keyed_by_configuration(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The physics tables (including the integral tables of the optical
+    processes) are stored by the first job, retrieved by a job with the
+    same configuration and built and stored again when the materials
+    and their optical properties change.
+    """
+    cache = os.path.join(output_tmpdir, 'physics_table_cache')
+
+    first = run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR, cache, 15)
+    assert 'Retrieving physics tables' not in first
+    assert 'Physics tables stored' in first
+
+    entries = os.listdir(cache)
+    assert len(entries) == 1
+    assert any(f.startswith('WLSIntegral') for f in os.listdir(os.path.join(cache, entries[0])))
+
+    second = run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR, cache, 15)
+    assert 'Retrieving physics tables' in second
+    assert 'Physics tables stored' not in second
+    assert 'could not be retrieved' not in second
+    assert os.listdir(cache) == entries
+
+    third = run_nexus(config_tmpdir, output_tmpdir, NEXUSDIR, cache, 10)
+    assert 'Retrieving physics tables' not in third
+    assert 'Physics tables stored' in third
+    assert len(os.listdir(cache)) == 2
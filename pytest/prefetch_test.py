@@ -0,0 +1,102 @@
+import pytest
+
+import os
+import subprocess
+
+import pandas as pd
+
+
+single_particle = """
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 10. keV
+/Generator/SingleParticle/max_energy 100. keV
+/Generator/SingleParticle/region CENTER
+"""
+
+ion = """
+/Generator/IonGenerator/atomic_number 55
+/Generator/IonGenerator/mass_number 137
+/Generator/IonGenerator/region CENTER
+"""
+
+
+def run_prefetch(config_tmpdir, output_tmpdir, NEXUSDIR, depth,
+                 generator='SingleParticleGenerator', generator_config=single_particle):
+    base_name = f'NEXT100_prefetch_{generator}_{depth}'
+    output    = os.path.join(output_tmpdir, base_name)
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator {generator}
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/prefetch_events {depth}
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+{generator_config}
+/nexus/persistency/output_file {output}
+/nexus/random_seed 23
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    result = subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', '5', init_path],
+                            check=True, capture_output=True, text=True)
+
+    if 'without multithreading support' in result.stdout + result.stderr:
+        pytest.skip('Geant4 was built without multithreading support')
+
+    # All the events got primaries produced in advance
+    assert '[PrefetchGenerator] 5 events generated in advance' in result.stdout
+
+    return pd.read_hdf(output + '.h5', 'MC/particles')
+
+
+def test_prefetch_does_not_depend_on_depth(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The primaries generated in a helper thread only depend
+    on the seed, not on how many events are generated in advance.
+    The test is skipped if Geant4 cannot run the helper thread.
+    """
+    one  = run_prefetch(config_tmpdir, output_tmpdir, NEXUSDIR, 1)
+    four = run_prefetch(config_tmpdir, output_tmpdir, NEXUSDIR, 4)
+    one  = one [one .primary == 1].reset_index(drop=True)
+    four = four[four.primary == 1].reset_index(drop=True)
+
+    assert len(one.event_id.unique()) == 5
+    columns = ['event_id', 'kin_energy',
+               'initial_momentum_x', 'initial_momentum_y', 'initial_momentum_z']
+    pd.testing.assert_frame_equal(one[columns], four[columns])
+
+
+def test_prefetched_ions_are_tracked(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The ion of the IonGenerator, defined in the main thread before the
+    run, is given to the events by the helper thread and decays in them.
+    """
+    particles = run_prefetch(config_tmpdir, output_tmpdir, NEXUSDIR, 2, 'IonGenerator', ion)
+
+    primaries = particles[particles.primary == 1]
+    assert len(primaries.event_id.unique()) == 5
+    assert primaries.particle_name.str.startswith('Cs137').all()
+
+    # Every event has the products of the decay
+    secondaries = particles[particles.primary == 0]
+    assert len(secondaries.event_id.unique()) == 5
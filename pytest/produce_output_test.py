@@ -35,10 +35,10 @@ next100_params = """
 
 """
 
-def run_simulation(NEXUSDIR, init_path):
+def run_simulation(NEXUSDIR, init_path, nevents=1):
     my_env    = os.environ
     nexus_exe = NEXUSDIR + '/bin/nexus'
-    command   = [nexus_exe, '-b', '-n', '1', init_path]
+    command   = [nexus_exe, '-b', '-n', str(nevents), init_path]
     p         = subprocess.run(command, check=True, env=my_env)
 
 @pytest.mark.order(1)
@@ -319,3 +319,106 @@ def test_create_nexus_output_file_no_strings(config_tmpdir, output_tmpdir,
     run_simulation(NEXUSDIR, init_path)
 
     return nexus_output_file_no_strings
+
+
+@pytest.mark.order(6)
+def test_create_nexus_output_files_rollover(config_tmpdir, output_tmpdir,
+                                            NEXUSDIR,
+                                            base_name_rollover,
+                                            nexus_output_files_rollover):
+    # Init file
+    init_text = f"""
+/nexus/RegisterGeometry Next100
+
+/nexus/RegisterGenerator SingleParticleGenerator
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name_rollover}.config.mac
+"""
+    init_text = f'{common_init_params} {init_text}'
+    init_path = os.path.join(config_tmpdir, base_name_rollover+'.init.mac')
+    init_file = open(init_path,'w')
+    init_file.write(init_text)
+    init_file.close()
+
+    # Config file
+    config_text = f"""
+/run/verbose 1
+/event/verbose 0
+/tracking/verbose 0
+
+/process/em/verbose 0
+
+/Generator/SingleParticle/region CENTER
+
+/Geometry/Next100/elfield false
+/Geometry/Next100/max_step_size 1. mm
+/Geometry/Next100/pressure 15. bar
+
+/nexus/persistency/save_strings false
+/nexus/persistency/events_per_file 1
+/nexus/persistency/start_id 10
+/nexus/persistency/output_file {output_tmpdir}/{base_name_rollover}
+/nexus/random_seed 21051817
+"""
+    config_text = f'{config_text} {single_part_params}'
+    config_path = os.path.join(config_tmpdir, base_name_rollover+'.config.mac')
+    config_file = open(config_path,'w')
+    config_file.write(config_text)
+    config_file.close()
+
+    # Running the simulation
+    run_simulation(NEXUSDIR, init_path, len(nexus_output_files_rollover))
+
+    return nexus_output_files_rollover
+
+
+@pytest.mark.order(7)
+def test_create_nexus_output_file_debug_steps(config_tmpdir, output_tmpdir,
+                                              NEXUSDIR,
+                                              base_name_debug_steps,
+                                              nexus_output_file_debug_steps):
+    # Init file
+    init_text = f"""
+/nexus/RegisterGeometry Next100OpticalGeometry
+
+/nexus/RegisterGenerator SingleParticleGenerator
+
+/nexus/RegisterSteppingAction SaveAllSteppingAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name_debug_steps}.config.mac
+"""
+    init_text = f'{common_init_params} {init_text}'
+    init_path = os.path.join(config_tmpdir, base_name_debug_steps+'.init.mac')
+    init_file = open(init_path,'w')
+    init_file.write(init_text)
+    init_file.close()
+
+    # Config file
+    config_text = f"""
+/run/verbose 1
+/event/verbose 0
+/tracking/verbose 0
+
+/process/em/verbose 0
+
+/Geometry/Next100/elfield false
+/Geometry/Next100/max_step_size 1. mm
+/Geometry/Next100/pressure 15. bar
+
+/Generator/SingleParticle/region CENTER
+
+/Actions/SaveAllSteppingAction/select_particle e-
+
+/nexus/persistency/output_file {output_tmpdir}/{base_name_debug_steps}
+/nexus/random_seed 21051817
+"""
+    config_text = f'{config_text} {single_part_params}'
+    config_path = os.path.join(config_tmpdir, base_name_debug_steps+'.config.mac')
+    config_file = open(config_path,'w')
+    config_file.write(config_text)
+    config_file.close()
+
+    # Running the simulation
+    run_simulation(NEXUSDIR, init_path, 2)
+
+    return nexus_output_file_debug_steps
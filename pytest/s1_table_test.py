@@ -0,0 +1,107 @@
+import pytest
+
+import os
+import subprocess
+
+import numpy  as np
+import pandas as pd
+
+
+def run_s1(config_tmpdir, output_tmpdir, NEXUSDIR, name, generator, config, nevents):
+    base_name = f'NEXT100_s1_{name}'
+    output    = os.path.join(output_tmpdir, base_name)
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator {generator}
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+{config}
+
+/nexus/persistency/output_file {output}
+/nexus/random_seed 53
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', str(nevents), init_path], check=True)
+    return output + '.h5'
+
+
+def charge_per_sensor_type(filename):
+    sns = pd.read_hdf(filename, 'MC/sns_response')
+    pos = pd.read_hdf(filename, 'MC/sns_positions')
+    sns = sns.merge(pos[['sensor_id', 'sensor_name']], on='sensor_id')
+    return sns.groupby('sensor_name').charge.sum()
+
+
+def test_s1_table_agrees_with_tracking(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The S1 detected per type of sensor when the scintillation photons are
+    sampled from a light table agrees with the one of the tracked photons.
+    The table is calibrated with photons emitted at the same point as the
+    electrons, and taken as constant around it.
+    """
+    nphotons = 200000
+    calibration = run_s1(config_tmpdir, output_tmpdir, NEXUSDIR, 'calibration',
+                         'ScintillationGenerator', f"""
+/Generator/ScintGenerator/region CENTER
+/Generator/ScintGenerator/nphotons {nphotons}
+""", 1)
+
+    particles = pd.read_hdf(calibration, 'MC/particles')
+    center    = particles[['initial_x', 'initial_y', 'initial_z']].values[0]
+
+    sns = pd.read_hdf(calibration, 'MC/sns_response')
+    pos = pd.read_hdf(calibration, 'MC/sns_positions')
+    probs = sns.groupby('sensor_id').charge.sum() / nphotons
+    pos = pos.set_index('sensor_id').loc[probs.index]
+
+    table = os.path.join(output_tmpdir, 'NEXT100_s1_table.csv')
+    with open(table, 'w') as f:
+        for sensor_id, sensor in pos.iterrows():
+            f.write(f'sensor,{sensor_id},{sensor.sensor_name},{sensor.x},{sensor.y},{sensor.z}\n')
+        f.write('binning,1,1,1\n')
+        lo, hi = center - 100, center + 100
+        f.write(f'region,{lo[0]},{lo[1]},{lo[2]},{hi[0]},{hi[1]},{hi[2]}\n')
+        f.write('point,0,0,0,' + ','.join(str(p) for p in probs.values) + '\n')
+
+    electrons = """
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 100. keV
+/Generator/SingleParticle/max_energy 100. keV
+/Generator/SingleParticle/region CENTER
+"""
+    tracked = run_s1(config_tmpdir, output_tmpdir, NEXUSDIR, 'tracked',
+                     'SingleParticleGenerator', electrons, 20)
+    sampled = run_s1(config_tmpdir, output_tmpdir, NEXUSDIR, 'sampled',
+                     'SingleParticleGenerator',
+                     electrons + f'/PhysicsList/Nexus/s1_table {table}\n', 20)
+
+    tracked = charge_per_sensor_type(tracked)
+    sampled = charge_per_sensor_type(sampled)
+
+    # The light table fills the hits of the same sensitive detectors
+    assert set(sampled.index) <= set(tracked.index)
+
+    for name in tracked[tracked > 200].index:
+        assert np.isclose(sampled.get(name, 0), tracked[name], rtol=0.15)
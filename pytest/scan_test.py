@@ -0,0 +1,103 @@
+import pytest
+
+import os
+import subprocess
+
+import pandas as pd
+
+
+def write_macros(config_tmpdir, base_name, output, scan):
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 1. MeV
+/Generator/SingleParticle/max_energy 1. MeV
+/Generator/SingleParticle/region CENTER
+
+{scan}
+
+/nexus/persistency/output_file {output}
+/nexus/random_seed 17
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+    return init_path
+
+
+def test_scan_writes_one_file_per_value(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    A scan of the scintillation yield runs the events once per value,
+    each run writing its own output file, which records the value.
+    The new yield reaches the physics: ten times more light is detected.
+    """
+    base_name = 'NEXT100_scan'
+    output    = os.path.join(output_tmpdir, base_name)
+    scan      = """
+/nexus/scan/parameter /Geometry/Next100/sc_yield
+/nexus/scan/values 2000 20000
+/nexus/scan/unit 1/MeV
+"""
+    init_path = write_macros(config_tmpdir, base_name, output, scan)
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', '2', init_path], check=True)
+
+    assert not os.path.exists(output + '.h5')
+
+    charges = []
+    for i, value in enumerate(('2000', '20000')):
+        output_file = f'{output}_scan_{i:03d}.h5'
+
+        particles = pd.read_hdf(output_file, 'MC/particles')
+        assert len(particles[particles.primary == 1].event_id.unique()) == 2
+
+        config = pd.read_hdf(output_file, 'MC/configuration')
+        assert f'{value} 1/MeV' in config[config.param_key == '/Geometry/Next100/sc_yield'].param_value.values
+
+        charges.append(pd.read_hdf(output_file, 'MC/sns_response').charge.sum())
+
+    assert charges[1] > 100
+    assert charges[1] > 5 * charges[0]
+
+
+def test_scan_of_unsupported_parameter_fails_before_running(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    A parameter the geometry cannot update without being built
+    again, such as the pressure, is rejected before the first run.
+    """
+    base_name = 'NEXT100_scan_pressure'
+    output    = os.path.join(output_tmpdir, base_name)
+    scan      = """
+/nexus/scan/parameter /Geometry/Next100/pressure
+/nexus/scan/values 10 15
+/nexus/scan/unit bar
+"""
+    init_path = write_macros(config_tmpdir, base_name, output, scan)
+
+    result = subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', '2', init_path],
+                            capture_output=True, text=True)
+
+    assert result.returncode != 0
+    assert 'cannot be scanned' in result.stdout + result.stderr
+    assert not os.path.exists(f'{output}_scan_000.h5')
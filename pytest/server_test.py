@@ -0,0 +1,120 @@
+import pytest
+
+import os
+import time
+import subprocess
+
+import pandas as pd
+
+
+def test_server_runs_jobs_with_their_own_output(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    A server initialized once runs jobs that differ in the generator
+    settings, each one in a process of its own that writes its own
+    output file and starts from the configuration and random state
+    left by the initialization. A job aborted by a fatal error is
+    reported as failed without stopping the server.
+    """
+    base_name = 'NEXT100_server'
+    socket    = os.path.join(config_tmpdir, base_name + '.sock')
+    nexus_exe = NEXUSDIR + '/bin/nexus'
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = """
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 30. keV
+/Generator/SingleParticle/max_energy 30. keV
+/Generator/SingleParticle/region CENTER
+
+/nexus/random_seed 17
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    # Commands of each job, besides its output file and run
+    jobs = [ ('/Generator/SingleParticle/min_energy 10. keV\n'
+              '/Generator/SingleParticle/max_energy 10. keV\n', 'OK events=2')
+           , ('/Generator/SingleParticle/region NOWHERE\n', 'ERROR job aborted')
+           , ('/Generator/SingleParticle/min_costheta 0.9\n', 'OK events=2')
+           , (''                                           , 'OK events=2')
+           , (''                                           , 'OK events=2')
+           ]
+
+    server = subprocess.Popen([nexus_exe, '-s', socket, init_path])
+    try:
+        # Wait until the server is listening
+        for _ in range(600):
+            if os.path.exists(socket) or server.poll() is not None:
+                break
+            time.sleep(0.5)
+
+        outputs = []
+        for job, (commands, expected) in enumerate(jobs):
+            output   = os.path.join(output_tmpdir, f'{base_name}_{job}')
+            job_path = os.path.join(config_tmpdir, f'{base_name}_{job}.mac')
+            with open(job_path, 'w') as f:
+                f.write(commands + f"""
+/nexus/persistency/output_file {output}
+/run/beamOn 2
+""")
+            result = subprocess.run([nexus_exe, '-c', socket, job_path],
+                                    capture_output=True, text=True)
+            assert result.stdout.startswith(expected)
+            assert (result.returncode == 0) == expected.startswith('OK')
+            outputs.append(output + '.h5')
+
+        subprocess.run([nexus_exe, '-c', socket, '--shutdown'], check=True)
+        server.wait(timeout=60)
+    finally:
+        if server.poll() is None:
+            server.kill()
+
+    assert server.returncode == 0
+
+    # The first job uses its own energy, the last two the configured one,
+    # not the energy left by the first job
+    for output, energy in ((outputs[0], 10), (outputs[3], 30), (outputs[4], 30)):
+        particles = pd.read_hdf(output, 'MC/particles')
+        primaries = particles[particles.primary == 1]
+        assert len(primaries.event_id.unique()) == 2
+        assert (primaries.kin_energy * 1000).round(3).eq(energy).all()
+
+    # Nor do they keep the direction range of the third job
+    def costheta(output):
+        particles = pd.read_hdf(output, 'MC/particles')
+        primaries = particles[particles.primary == 1]
+        momentum  = primaries[['initial_momentum_x', 'initial_momentum_y', 'initial_momentum_z']].values
+        return momentum[:, 2] / (momentum**2).sum(axis=1)**0.5
+
+    assert (costheta(outputs[2]) >= 0.9 - 1e-6).all()
+    assert (costheta(outputs[3]) <  0.9).any()
+
+    config = pd.read_hdf(outputs[0], 'MC/configuration')
+    assert '10. keV' in config[config.param_key == '/Generator/SingleParticle/min_energy'].param_value.values
+
+    # Every job starts from the same random state, so
+    # identical jobs give identical events
+    same = [pd.read_hdf(output, 'MC/particles') for output in outputs[3:]]
+    pd.testing.assert_frame_equal(same[0], same[1])
@@ -0,0 +1,89 @@
+import pytest
+
+import os
+import time
+import subprocess
+
+h5py = pytest.importorskip('h5py')
+
+
+def test_swmr_reader_sees_events_while_running(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    A reader opening the output file in SWMR mode while the job is
+    running sees the particle table grow as the events are written.
+    """
+    base_name = 'NEXT100_swmr'
+    output    = os.path.join(output_tmpdir, base_name)
+    nexus_exe = NEXUSDIR + '/bin/nexus'
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics G4OpticalPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100OpticalGeometry
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    # The scintillation light makes every event last long
+    # enough for the reader to poll the file between them
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 1. MeV
+/Generator/SingleParticle/max_energy 1. MeV
+/Generator/SingleParticle/region CENTER
+
+/nexus/persistency/swmr true
+/nexus/persistency/swmr_flush_interval 1
+/nexus/persistency/output_file {output}
+/nexus/random_seed 17
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    nevents = 10
+    job = subprocess.Popen([nexus_exe, '-b', '-n', str(nevents), init_path])
+
+    sizes = []
+    try:
+        # Wait until the file is in SWMR mode
+        h5file = None
+        while h5file is None and job.poll() is None:
+            try:
+                h5file = h5py.File(output + '.h5', 'r', libver='latest', swmr=True)
+            except OSError:
+                time.sleep(0.1)
+
+        assert h5file is not None, 'the job ended before the file could be read'
+
+        with h5file:
+            particles = h5file['MC/particles']
+            while job.poll() is None:
+                particles.refresh()
+                if not sizes or particles.shape[0] != sizes[-1]:
+                    sizes.append(particles.shape[0])
+                time.sleep(0.05)
+    finally:
+        if job.poll() is None:
+            job.kill()
+
+    assert job.returncode == 0
+
+    # The table grew at least once while the job was running
+    assert len(sizes) >= 2
+    assert sizes == sorted(sizes)
+    assert sizes[-1] > 0
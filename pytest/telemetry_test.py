@@ -0,0 +1,67 @@
+import pytest
+
+import os
+import json
+import subprocess
+
+
+def test_final_status_reports_whole_run_rate(config_tmpdir, output_tmpdir, NEXUSDIR):
+    """
+    The final record of the telemetry status file gives the
+    throughput over the whole run, not since the previous report.
+    """
+    base_name = 'NEXT100_telemetry'
+    output    = os.path.join(output_tmpdir, base_name)
+    status    = os.path.join(output_tmpdir, base_name + '.status.jsonl')
+
+    init_text = f"""
+/PhysicsList/RegisterPhysics G4EmStandardPhysics_option4
+/PhysicsList/RegisterPhysics G4DecayPhysics
+/PhysicsList/RegisterPhysics G4RadioactiveDecayPhysics
+/PhysicsList/RegisterPhysics NexusPhysics
+/PhysicsList/RegisterPhysics G4StepLimiterPhysics
+
+/nexus/RegisterGeometry Next100
+/nexus/RegisterGenerator SingleParticleGenerator
+/nexus/RegisterPersistencyManager PersistencyManager
+/nexus/RegisterTrackingAction DefaultTrackingAction
+/nexus/RegisterEventAction DefaultEventAction
+/nexus/RegisterRunAction DefaultRunAction
+
+/nexus/RegisterMacro {config_tmpdir}/{base_name}.config.mac
+"""
+    config_text = f"""
+/Geometry/Next100/pressure 15. bar
+/Geometry/Next100/elfield false
+
+/Generator/SingleParticle/particle e-
+/Generator/SingleParticle/min_energy 1. MeV
+/Generator/SingleParticle/max_energy 1. MeV
+/Generator/SingleParticle/region CENTER
+
+/nexus/telemetry/report_interval 0.001 s
+/nexus/telemetry/status_format jsonl
+/nexus/telemetry/status_file {status}
+
+/nexus/persistency/output_file {output}
+/nexus/random_seed 29
+"""
+    init_path = os.path.join(config_tmpdir, base_name + '.init.mac')
+    with open(init_path, 'w') as f:
+        f.write(init_text)
+    with open(os.path.join(config_tmpdir, base_name + '.config.mac'), 'w') as f:
+        f.write(config_text)
+
+    subprocess.run([NEXUSDIR + '/bin/nexus', '-b', '-n', '10', init_path], check=True)
+
+    with open(status) as f:
+        records = [json.loads(l) for l in f]
+
+    assert len(records) > 1
+    assert not records[-2]['final']
+
+    final = records[-1]
+    assert final['final']
+    assert final['events'] == 10
+    assert final['events_per_second'] == pytest.approx(final['events'] / final['wall_time_s'],
+                                                       rel=1e-4)
@@ -0,0 +1,171 @@
+############################################################
+#
+# Merge the nexus output files of the jobs that replay different
+# chunks of the ionization hits of the same events (see the
+# num_chunks and chunk commands of the HitsReplayGenerator).
+#
+# The chunks must be complete and replay the same events with the
+# same parameters. The sensor responses of the chunks are summed,
+# their hits and particles are concatenated event by event (the
+# particle IDs of each chunk are shifted so that they stay unique)
+# and the event index is rebuilt. The configuration is the one of
+# the chunks, without the chunk number. The rest of the tables are
+# taken from the first file.
+#
+# If the file with the replayed events is given, the events are
+# renumbered with their IDs in that file.
+#
+# Usage: python merge_chunks.py [--source <replayed file>]
+#                               <output file> <chunk files>
+#
+############################################################
+
+import argparse
+
+import numpy  as np
+import pandas as pd
+import tables as tb
+
+
+CHUNK_KEY      = '/Generator/HitsReplay/chunk'
+NUM_CHUNKS_KEY = '/Generator/HitsReplay/num_chunks'
+FIRST_KEY      = '/Generator/HitsReplay/first_event'
+START_ID_KEY   = '/nexus/persistency/start_id'
+
+
+def to_records(df, dtype):
+    """Convert a dataframe to a structured array with the given columns."""
+    records = np.empty(len(df), dtype=dtype)
+    for name in dtype.names:
+        records[name] = df[name].values
+    return records
+
+
+def parameter(config, key, default):
+    """Value of a parameter of the configuration table, as an integer."""
+    values = config[config.param_key == key].param_value.values
+    return int(float(str(values[-1]).split()[0])) if len(values) else default
+
+
+def check_chunks(configs, indices):
+    """Check that the chunks are complete and replay the same events."""
+    num_chunks = parameter(configs[0], NUM_CHUNKS_KEY, 1)
+    chunks     = sorted(parameter(c, CHUNK_KEY, 0) for c in configs)
+    if chunks != list(range(num_chunks)):
+        raise ValueError(f'Chunks {chunks} given, but the events are split in {num_chunks}.')
+
+    # Only the replay parameters must agree: the macros, output
+    # files and telemetry of the jobs are naturally different
+    def replay(config):
+        keys = config.param_key.astype(str)
+        config = config[keys.str.startswith('/Generator/HitsReplay/') & (keys != CHUNK_KEY)]
+        return config.reset_index(drop=True)
+
+    for config in configs[1:]:
+        if not replay(config).equals(replay(configs[0])):
+            raise ValueError('The chunks replay different files or with different parameters.')
+
+    for index in indices[1:]:
+        if not np.array_equal(index.event_id.values, indices[0].event_id.values):
+            raise ValueError('The chunks do not contain the same events.')
+
+
+def concatenate(tables, ids=()):
+    """
+    Concatenate the tables of the chunks event by event. The given
+    ID columns are shifted, per event, past the IDs of the previous chunks.
+    """
+    offset = None
+    shifted = []
+    for table in tables:
+        table = table.copy()
+        if offset is not None and len(table):
+            shift = table.event_id.map(offset).fillna(0).astype(table[ids[0]].dtype)
+            for column in ids:
+                nonzero = table[column] != 0
+                table.loc[nonzero, column] += shift[nonzero]
+        if ids and len(table):
+            last = table.groupby('event_id')[ids[0]].max()
+            offset = last if offset is None else pd.concat([offset, last]).groupby(level=0).max()
+        shifted.append(table)
+
+    merged = pd.concat(shifted, ignore_index=True)
+    return merged.sort_values('event_id', kind='mergesort').reset_index(drop=True)
+
+
+def rebuild_index(index, hits, particles):
+    """Event index pointing to the rows of the merged tables."""
+    index = index.copy()
+    for name, table in (('hits', hits), ('particles', particles)):
+        counts = table.groupby('event_id').size()
+        counts = index.event_id.map(counts).fillna(0).astype(np.uint64).values
+        index[name + '_count'] = counts
+        index[name + '_first'] = np.cumsum(counts) - counts
+    return index
+
+
+def merge_chunks(output_file, input_files, source_file=None):
+
+    configs = [pd.read_hdf(f, 'MC/configuration') for f in input_files]
+    indices = [pd.read_hdf(f, 'MC/event_index')   for f in input_files]
+    check_chunks(configs, indices)
+
+    response = pd.concat([pd.read_hdf(f, 'MC/sns_response') for f in input_files])
+    response = response.groupby(['event_id', 'sensor_id', 'time_bin'],
+                                as_index=False).charge.sum()
+
+    positions = pd.concat([pd.read_hdf(f, 'MC/sns_positions') for f in input_files])
+    positions = positions.drop_duplicates('sensor_id')
+
+    with tb.open_file(input_files[0]) as h5in:
+        present = set(table.name for table in h5in.root.MC)
+
+    def read_all(name, ids):
+        if name not in present: return None
+        return concatenate([pd.read_hdf(f, 'MC/' + name) for f in input_files], ids)
+
+    hits      = read_all('hits', ('particle_id',))
+    particles = read_all('particles', ('particle_id', 'mother_id'))
+
+    empty = pd.DataFrame({'event_id': []})
+    index = rebuild_index(indices[0],
+                          hits      if hits      is not None else empty,
+                          particles if particles is not None else empty)
+
+    config = configs[0][configs[0].param_key != CHUNK_KEY]
+
+    tables = {'sns_response': response, 'sns_positions': positions,
+              'hits': hits, 'particles': particles,
+              'event_index': index, 'configuration': config}
+    tables = {name: table for name, table in tables.items() if table is not None}
+
+    # The events are numbered as in the file they were replayed from
+    if source_file:
+        source   = pd.read_hdf(source_file, 'MC/event_index').event_id.values
+        first    = parameter(configs[0], FIRST_KEY, 0)
+        start_id = parameter(configs[0], START_ID_KEY, 0)
+        for table in tables.values():
+            if 'event_id' in table:
+                table['event_id'] = source[first + table.event_id.values - start_id]
+
+    with tb.open_file(input_files[0]) as h5in, tb.open_file(output_file, 'w') as h5out:
+        group = h5out.create_group('/', 'MC')
+
+        for table in h5in.root.MC:
+            if table.name in tables: continue
+            table._f_copy(group)
+
+        for name, df in tables.items():
+            h5out.create_table(group, name,
+                               obj=to_records(df, h5in.root.MC._f_get_child(name).dtype))
+
+
+if __name__ == '__main__':
+
+    parser = argparse.ArgumentParser(description='Merge the outputs of the chunks of replayed events.')
+    parser.add_argument('--source', help='File whose events were replayed, to renumber them.')
+    parser.add_argument('output_file')
+    parser.add_argument('input_files', nargs='+')
+    args = parser.parse_args()
+
+    merge_chunks(args.output_file, args.input_files, args.source)
@@ -0,0 +1,291 @@
+
+############################################################
+#
+# Benchmark suite of nexus. Runs the fixed-seed workloads of
+# macros/bench and reports, for each of them, the initialization
+# time, events per second, peak resident memory, output bytes per
+# event and profile hotspots as JSON. The results can be stored as
+# a baseline and compared against it with tolerance thresholds.
+#
+# The numbers are taken from the run telemetry status file and
+# from the /PROFILE/steps table written by the profiling actions.
+# With --profiler-overhead, each workload is run again without the
+# profiling actions to check that they slow it down by less than 3%.
+#
+# Usage: python nexus_bench.py [-h] [--baseline FILE] [--save-baseline]
+#                              [--workloads NAME ...] [--output FILE]
+#                              [--profiler-overhead]
+#
+############################################################
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import time
+
+import pandas as pd
+
+
+# Name -> (init macro, number of events)
+WORKLOADS = {
+    'NEXT100_Kr83m_full'  : ('macros/bench/bench_NEXT100_Kr83m_full.init.mac'  , 10),
+    'NEXT100_bb0nu'       : ('macros/bench/bench_NEXT100_bb0nu.init.mac'       , 20),
+    'NEW_S2_table'        : ('macros/bench/bench_NEW_S2_table.init.mac'        ,  5),
+    'DEMO_muons'          : ('macros/bench/bench_DEMO_muons.init.mac'          , 20),
+    'FLEX100_fibers_full' : ('macros/bench/bench_FLEX100_fibers_full.init.mac' ,  5),
+}
+
+# Metric -> (better direction, relative tolerance)
+TOLERANCES = {
+    'init_time_s'       : ('lower' , 0.20),
+    'events_per_second' : ('higher', 0.10),
+    'peak_rss_bytes'    : ('lower' , 0.10),
+    'bytes_per_event'   : ('lower' , 0.05),
+}
+
+# Maximum slowdown of a workload due to the profiling actions
+PROFILER_OVERHEAD_TARGET = 0.03
+
+PROFILING_ACTIONS = {
+    '/nexus/RegisterTrackingAction' : '/Actions/ProfilingTrackingAction/wrap',
+    '/nexus/RegisterSteppingAction' : '/Actions/ProfilingSteppingAction/wrap',
+}
+
+
+def nexus_dir():
+    return os.environ.get('NEXUSDIR',
+                          os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+
+def copy_macros(init_macro, workdir, name, profiled=True):
+    """
+    Copy the init and config macros of a workload to the working
+    directory, sending all the outputs there and enabling the
+    telemetry status file. If not profiled, the profiling actions
+    are replaced by the actions they wrap.
+    """
+    config_macro = init_macro.replace('.init.mac', '.config.mac')
+
+    cp_init   = os.path.join(workdir, os.path.basename(init_macro))
+    cp_config = os.path.join(workdir, os.path.basename(config_macro))
+    status    = os.path.join(workdir, name + '.status.jsonl')
+    output    = None
+
+    with open(config_macro) as f:
+        config = f.readlines()
+
+    wrapped = {l.split()[0] : l.split()[1] for l in config
+               if l.split() and l.split()[0] in PROFILING_ACTIONS.values()}
+
+    with open(init_macro) as f, open(cp_init, 'w') as f_cp:
+        for l in f:
+            l1 = l.split()
+            if l.startswith('/nexus/RegisterMacro'):
+                f_cp.write('/nexus/RegisterMacro ' + cp_config + '\n')
+            elif not profiled and l1 and l1[0] in PROFILING_ACTIONS:
+                inner = wrapped.get(PROFILING_ACTIONS[l1[0]])
+                if inner:
+                    f_cp.write(l1[0] + ' ' + inner + '\n')
+            else:
+                f_cp.write(l)
+
+    with open(cp_config, 'w') as f_cp:
+        for l in config:
+            l1 = l.split()
+            if not profiled and l1 and l1[0] in PROFILING_ACTIONS.values():
+                continue
+            if l1 and l1[0] in ('/nexus/persistency/output_file',
+                                '/Generator/Decay0Interface/decay_file'):
+                path = os.path.join(workdir, os.path.basename(l1[1]))
+                if l1[0] == '/nexus/persistency/output_file':
+                    output = path + '.h5'
+                f_cp.write(l1[0] + ' ' + path + '\n')
+            else:
+                f_cp.write(l)
+
+        f_cp.write('\n/nexus/telemetry/report_interval 0 s\n')
+        f_cp.write('/nexus/telemetry/status_format jsonl\n')
+        f_cp.write('/nexus/telemetry/status_file ' + status + '\n')
+
+    return cp_init, status, output
+
+
+def hotspots(output, nentries):
+    """Most expensive (particle, volume, process) entries of the profile."""
+    profile = pd.read_hdf(output, 'PROFILE/steps')
+    for col in ('particle', 'volume', 'process'):
+        profile[col] = profile[col].apply(lambda s: s.decode() if isinstance(s, bytes) else s)
+
+    total   = profile.time.sum()
+    profile = profile.sort_values('time', ascending=False).head(nentries)
+
+    return [dict(particle = row.particle,
+                 volume   = row.volume,
+                 process  = row.process,
+                 steps    = int(row.steps),
+                 tracks   = int(row.tracks),
+                 time_s   = float(row.time),
+                 fraction = float(row.time / total) if total > 0 else 0.)
+            for row in profile.itertuples()]
+
+
+def run_workload(nexus, name, workdir, nevents, nhotspots, profiled=True):
+    init_macro, default_events = WORKLOADS[name]
+    nevents = nevents or default_events
+
+    cp_init, status, output = copy_macros(os.path.join(nexus_dir(), init_macro),
+                                          workdir, name, profiled)
+
+    log = os.path.join(workdir, name + '.log')
+    print(f'Running {name} ({nevents} events), log in {log}')
+
+    start = time.time()
+    with open(log, 'w') as flog:
+        subprocess.run([nexus, '-b', '-n', str(nevents), cp_init], check=True,
+                       cwd=nexus_dir(), stdout=flog, stderr=subprocess.STDOUT)
+    elapsed = time.time() - start
+
+    with open(status) as f:
+        final = json.loads(f.readlines()[-1])
+
+    events = final['events']
+    return dict(events            = events,
+                process_time_s    = elapsed,
+                init_time_s       = final['init_time_s'],
+                events_per_second = events / final['wall_time_s'] if final['wall_time_s'] > 0 else 0.,
+                peak_rss_bytes    = final['peak_rss_bytes'],
+                bytes_per_event   = os.path.getsize(output) / events if events > 0 else 0.,
+                event_time_s      = final['event_time_s'],
+                hotspots          = hotspots(output, nhotspots) if profiled else [])
+
+
+def profiler_overhead(nexus, name, workdir, nevents, result):
+    """
+    Slowdown of the workload due to the profiling actions, measured
+    against a run of the same events with the actions they wrap.
+    """
+    workdir = os.path.join(workdir, 'unprofiled')
+    os.makedirs(workdir, exist_ok=True)
+
+    unprofiled = run_workload(nexus, name, workdir, nevents, 0, profiled=False)
+    if result['events_per_second'] <= 0:
+        return 0.
+    return unprofiled['events_per_second'] / result['events_per_second'] - 1.
+
+
+def compare(results, baseline, tolerances):
+    """Print the comparison with the baseline and return the regressions."""
+    regressions = []
+
+    for name, result in results['workloads'].items():
+        if name not in baseline['workloads']:
+            print(f'{name}: not in the baseline')
+            continue
+        reference = baseline['workloads'][name]
+
+        for metric, (better, tolerance) in tolerances.items():
+            value, ref = result[metric], reference[metric]
+            if ref == 0: continue
+
+            change = (value - ref) / ref
+            worse  = change > tolerance if better == 'lower' else change < -tolerance
+            flag   = 'REGRESSION' if worse else 'ok'
+            print(f'{name:22s} {metric:18s} {ref:14.4g} -> {value:14.4g} ({change:+7.1%})  {flag}')
+
+            if worse:
+                regressions.append((name, metric, ref, value))
+
+    return regressions
+
+
+def parse_tolerances(overrides):
+    tolerances = dict(TOLERANCES)
+    for override in overrides:
+        metric, value = override.split('=')
+        if metric not in tolerances:
+            sys.exit(f'Unknown metric {metric}, choose among {", ".join(tolerances)}')
+        tolerances[metric] = (tolerances[metric][0], float(value))
+    return tolerances
+
+
+if __name__ == '__main__':
+
+    parser = argparse.ArgumentParser(description='Run the nexus benchmark suite.')
+    parser.add_argument('--nexus', default=os.path.join(nexus_dir(), 'bin', 'nexus'),
+                        help='nexus executable')
+    parser.add_argument('--workloads', nargs='+', choices=list(WORKLOADS), default=list(WORKLOADS),
+                        help='workloads to run (all by default)')
+    parser.add_argument('--events', type=int, default=0,
+                        help='events per workload, instead of the default of each one')
+    parser.add_argument('--workdir', default='nexus_bench',
+                        help='directory for the macros, outputs and logs')
+    parser.add_argument('--output', default='nexus_bench.json',
+                        help='file where the results are written')
+    parser.add_argument('--baseline', default=None,
+                        help='baseline to compare with')
+    parser.add_argument('--save-baseline', action='store_true',
+                        help='store the results as the baseline instead of comparing')
+    parser.add_argument('--tolerance', action='append', default=[], metavar='METRIC=FRACTION',
+                        help='relative tolerance of a metric')
+    parser.add_argument('--hotspots', type=int, default=10,
+                        help='profile entries reported per workload')
+    parser.add_argument('--profiler-overhead', action='store_true',
+                        help=f'run each workload also without the profiling actions '
+                             f'and fail if they cost more than {PROFILER_OVERHEAD_TARGET:.0%}')
+    args = parser.parse_args()
+
+    tolerances = parse_tolerances(args.tolerance)
+
+    workdir = os.path.abspath(args.workdir)
+    os.makedirs(workdir, exist_ok=True)
+
+    results = dict(host      = platform.node(),
+                   platform  = platform.platform(),
+                   timestamp = time.strftime('%Y-%m-%dT%H:%M:%S'),
+                   workloads = {})
+
+    above_target = []
+    for name in args.workloads:
+        result = run_workload(os.path.abspath(args.nexus), name, workdir,
+                              args.events, args.hotspots)
+
+        if args.profiler_overhead:
+            overhead = profiler_overhead(os.path.abspath(args.nexus), name, workdir,
+                                         args.events, result)
+            result['profiler_overhead'] = overhead
+            flag = 'ok' if overhead <= PROFILER_OVERHEAD_TARGET else 'ABOVE TARGET'
+            print(f'{name:22s} profiler overhead {overhead:+7.1%}  {flag}')
+            if overhead > PROFILER_OVERHEAD_TARGET:
+                above_target.append(name)
+
+        results['workloads'][name] = result
+
+    with open(args.output, 'w') as f:
+        json.dump(results, f, indent=2)
+    print(f'Results written to {args.output}')
+
+    if above_target:
+        print(f'Profiler overhead above {PROFILER_OVERHEAD_TARGET:.0%} in: {", ".join(above_target)}')
+
+    if args.baseline is None:
+        if args.save_baseline:
+            sys.exit('--save-baseline requires --baseline')
+        sys.exit(1 if above_target else 0)
+
+    if args.save_baseline:
+        with open(args.baseline, 'w') as f:
+            json.dump(results, f, indent=2)
+        print(f'Baseline written to {args.baseline}')
+        sys.exit(1 if above_target else 0)
+
+    with open(args.baseline) as f:
+        baseline = json.load(f)
+
+    regressions = compare(results, baseline, tolerances)
+    if regressions:
+        print(f'{len(regressions)} metrics beyond tolerance')
+    if regressions or above_target:
+        sys.exit(1)
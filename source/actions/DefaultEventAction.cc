@@ -9,8 +9,9 @@
 
 #include "DefaultEventAction.h"
 #include "Trajectory.h"
-#include "PersistencyManager.h"
+#include "PersistencyManagerBase.h"
 #include "IonizationHit.h"
+#include "ReplayedEventInformation.h"
 #include "FactoryBase.h"
 
 #include <G4Event.hh>
@@ -46,7 +47,7 @@ REGISTER_CLASS(DefaultEventAction, G4UserEventAction)
     max_energy_cmd.SetUnitCategory("Energy");
     max_energy_cmd.SetRange("max_energy>0.");
 
-    PersistencyManager* pm = dynamic_cast<PersistencyManager*>
+    PersistencyManagerBase* pm = dynamic_cast<PersistencyManagerBase*>
       (G4VPersistencyManager::GetPersistencyManager());
 
     pm->SaveNumbOfInteractingEvents(true);
@@ -81,12 +82,20 @@ REGISTER_CLASS(DefaultEventAction, G4UserEventAction)
     if (energy_min_ >= 0.) {
 
       // Get the trajectories stored for this event and loop through them
-      // to calculate the total energy deposit
+      // to calculate the total energy deposit.
+      // The events of the HitsReplayGenerator carry the energy of the
+      // replayed hits instead, as their ionization electrons are not stored
 
       G4double edep = 0.;
 
+      ReplayedEventInformation* replayed =
+        dynamic_cast<ReplayedEventInformation*>(event->GetUserInformation());
+
       G4TrajectoryContainer* tc = event->GetTrajectoryContainer();
-      if (tc) {
+      if (replayed) {
+        edep = replayed->GetEnergyDeposit();
+      }
+      else if (tc) {
         // in interactive mode, a G4TrajectoryContainer would exist
         // but the trajectories will not cast to Trajectory
         Trajectory* trj = dynamic_cast<Trajectory*>((*tc)[0]);
@@ -107,7 +116,7 @@ REGISTER_CLASS(DefaultEventAction, G4UserEventAction)
                     "and not using OpticalTrackingAction, you should not specify any event actions.");
       }
 
-      PersistencyManager* pm = dynamic_cast<PersistencyManager*>
+      PersistencyManagerBase* pm = dynamic_cast<PersistencyManagerBase*>
         (G4VPersistencyManager::GetPersistencyManager());
 
       if (!event->IsAborted() && edep>0) {
@@ -2,7 +2,9 @@
 // nexus | DefaultStackingAction.cc
 //
 // This class is an example of how to implement a stacking action, if needed.
-// At the moment, it is not used in the NEXT simulations.
+// At the moment, it is not used in the NEXT simulations, except to feed
+// the stack with the EL photons generated in lazy emission mode and to
+// stop the events after the ionization stage.
 //
 // The NEXT Collaboration
 // ----------------------------------------------------------------------------
@@ -12,23 +14,41 @@
 #include "DefaultEventAction.h"
 #include "FactoryBase.h"
 #include "IonizationElectron.h"
+#include "Electroluminescence.h"
+#include "ELResponseCache.h"
 
 #include <G4OpticalPhoton.hh>
 #include <G4EventManager.hh>
+#include <G4ProcessTable.hh>
 #include <G4Track.hh>
+#include <G4GenericMessenger.hh>
 
 using namespace nexus;
 
 REGISTER_CLASS(DefaultStackingAction, G4UserStackingAction)
 
-DefaultStackingAction::DefaultStackingAction(): G4UserStackingAction(), stage_()
+namespace {
+  Electroluminescence* FindElectroluminescence()
+  {
+    return dynamic_cast<Electroluminescence*>
+      (G4ProcessTable::GetProcessTable()->
+       FindProcess("Electroluminescence", IonizationElectron::Definition()));
+  }
+}
+
+DefaultStackingAction::DefaultStackingAction():
+  G4UserStackingAction(), msg_(0), stage_(), ionization_only_(false), el_(0)
 {
+  msg_ = new G4GenericMessenger(this, "/Actions/DefaultStackingAction/");
+  msg_->DeclareProperty("ionization_only", ionization_only_,
+                        "Stop the events after the ionization stage, before drift and light production.");
 }
 
 
 
 DefaultStackingAction::~DefaultStackingAction()
 {
+  delete msg_;
 }
 
 
@@ -46,6 +66,10 @@ DefaultStackingAction::ClassifyNewTrack(const G4Track* track)
   // particles that we have kept on hold. In this stage we don't delay particle
   // propagation any further and we track all of them eagerly.
 
+  // The photons whose detection teaches the EL response cache are followed
+  if (ELResponseCache* cache = ELResponseCache::Learning())
+    cache->RegisterTrack(track);
+
   if (stage_> 0) return G4ClassificationOfNewTrack::fUrgent;
 
   static auto opticalphoton = G4OpticalPhoton::Definition();
@@ -67,8 +91,20 @@ void DefaultStackingAction::NewStage()
   static auto event_action =
     static_cast<DefaultEventAction*>(G4EventManager::GetEventManager() -> GetUserEventAction());
 
-  if (!event_action -> IsDepositedEnergyInRange())
+  // In ionization-only mode, the delayed tracks are never propagated:
+  // the deposits are stored and the detector response is simulated
+  // later, replaying them with the HitsReplayGenerator
+  if (!event_action -> IsDepositedEnergyInRange() || ionization_only_) {
     stackManager -> ClearUrgentStack();
+    if (el_) el_ -> ClearPendingPhotons();
+  }
+  else if (el_ && el_ -> HasPendingPhotons()) {
+    // Electroluminescence photons generated lazily are
+    // added in batches whenever the stack runs empty
+    G4TrackVector photons;
+    el_ -> EmitPendingPhotons(photons);
+    G4EventManager::GetEventManager() -> StackTracks(&photons);
+  }
 
   stage_++;
 }
@@ -78,5 +114,10 @@ void DefaultStackingAction::NewStage()
 void DefaultStackingAction::PrepareNewEvent()
 {
   stage_ = 0;
+
+  // The processes do not exist yet when the action is constructed
+  el_ = FindElectroluminescence();
+  if (el_) el_ -> ClearPendingPhotons();
+
   return;
 }
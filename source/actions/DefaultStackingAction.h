@@ -2,7 +2,9 @@
 // nexus | DefaultStackingAction.h
 //
 // This class is an example of how to implement a stacking action, if needed.
-// At the moment, it is not used in the NEXT simulations.
+// At the moment, it is not used in the NEXT simulations, except to feed
+// the stack with the EL photons generated in lazy emission mode and to
+// stop the events after the ionization stage.
 //
 // The NEXT Collaboration
 // ----------------------------------------------------------------------------
@@ -12,9 +14,13 @@
 
 #include <G4UserStackingAction.hh>
 
+class G4GenericMessenger;
+
 
 namespace nexus {
 
+  class Electroluminescence;
+
   // General-purpose user stacking action
 
   class DefaultStackingAction: public G4UserStackingAction
@@ -30,7 +36,10 @@ namespace nexus {
     virtual void PrepareNewEvent();
 
   private:
+    G4GenericMessenger* msg_;
     unsigned stage_;
+    G4bool ionization_only_; ///< Discard the optical photons and ionization electrons
+    Electroluminescence* el_; ///< EL process, which may hold photons to be emitted lazily
   };
 
 } // end namespace nexus
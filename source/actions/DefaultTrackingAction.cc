@@ -15,6 +15,7 @@
 #include "TrajectoryMap.h"
 #include "IonizationElectron.h"
 #include "FactoryBase.h"
+#include "RunTelemetry.h"
 
 #include <G4Track.hh>
 #include <G4TrackingManager.hh>
@@ -40,6 +41,8 @@ void DefaultTrackingAction::PreUserTrackingAction(const G4Track *track)
   if (track->GetDefinition() == G4OpticalPhoton::Definition() ||
       track->GetDefinition() == IonizationElectron::Definition())
   {
+    if (RunTelemetry* telemetry = RunTelemetry::Instance())
+      telemetry->CountTrack(track);
     fpTrackingManager->SetStoreTrajectory(false);
     return;
   }
@@ -0,0 +1,177 @@
+// ----------------------------------------------------------------------------
+// nexus | OpticalCullingStackingAction.cc
+//
+// Stacking action that kills the new optical photons emitted from a
+// (position, direction) cell from which no photon has ever been seen to
+// reach a sensor, or keeps them with a survival probability and the
+// inverse weight. The acceptance map is built in a calibration run and
+// cached in a file. Otherwise, it behaves as the DefaultStackingAction.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "OpticalCullingStackingAction.h"
+
+#include "OpticalAcceptanceMap.h"
+#include "DefaultEventAction.h"
+#include "FactoryBase.h"
+
+#include <G4OpticalPhoton.hh>
+#include <G4Track.hh>
+#include <G4VProcess.hh>
+#include <G4GenericMessenger.hh>
+#include <G4EventManager.hh>
+#include <Randomize.hh>
+
+using namespace nexus;
+using namespace CLHEP;
+
+REGISTER_CLASS(OpticalCullingStackingAction, G4UserStackingAction)
+
+
+OpticalCullingStackingAction::OpticalCullingStackingAction():
+  DefaultStackingAction(), msg_(0), map_file_("optical_acceptance.csv"),
+  calibrate_(false), nx_(10), ny_(10), nz_(10), ncostheta_(10), nphi_(20),
+  min_photons_(100), survival_prob_(1.), map_(0), event_action_(0)
+{
+  msg_ = new G4GenericMessenger(this, "/Actions/OpticalCullingStackingAction/");
+
+  msg_->DeclareProperty("map_file", map_file_,
+                        "File with the optical acceptance map. It is built if it does not exist.");
+  msg_->DeclareProperty("calibrate", calibrate_,
+                        "Build the acceptance map even if the map file exists.");
+
+  G4GenericMessenger::Command& min_cmd =
+    msg_->DeclarePropertyWithUnit("region_min", "mm", region_min_,
+                                  "Lower corner of the region covered by the map.");
+  min_cmd.SetParameterName("region_min", false);
+
+  G4GenericMessenger::Command& max_cmd =
+    msg_->DeclarePropertyWithUnit("region_max", "mm", region_max_,
+                                  "Upper corner of the region covered by the map.");
+  max_cmd.SetParameterName("region_max", false);
+
+  msg_->DeclareProperty("x_bins", nx_, "Number of bins of the map in x.");
+  msg_->DeclareProperty("y_bins", ny_, "Number of bins of the map in y.");
+  msg_->DeclareProperty("z_bins", nz_, "Number of bins of the map in z.");
+  msg_->DeclareProperty("costheta_bins", ncostheta_,
+                        "Number of bins of the map in the cosine of the polar angle.");
+  msg_->DeclareProperty("phi_bins", nphi_,
+                        "Number of bins of the map in azimuthal angle.");
+
+  G4GenericMessenger::Command& photons_cmd =
+    msg_->DeclareProperty("min_photons", min_photons_,
+                          "Minimum number of calibration photons for a cell to be culled.");
+  photons_cmd.SetParameterName("min_photons", false);
+  photons_cmd.SetRange("min_photons>0");
+
+  // With the default of 1 no photon is culled, and the response is
+  // unbiased for any value but 0, which kills all culled photons
+  G4GenericMessenger::Command& surv_cmd =
+    msg_->DeclareProperty("survival_probability", survival_prob_,
+                          "Probability of a photon in a culled cell to be kept, with weight 1/p.");
+  surv_cmd.SetParameterName("survival_probability", false);
+  surv_cmd.SetRange("survival_probability>=0. && survival_probability<=1.");
+}
+
+
+
+OpticalCullingStackingAction::~OpticalCullingStackingAction()
+{
+  delete map_;
+  delete msg_;
+}
+
+
+
+void OpticalCullingStackingAction::Initialize()
+{
+  map_ = new OpticalAcceptanceMap(map_file_, calibrate_, region_min_, region_max_,
+                                  nx_, ny_, nz_, ncostheta_, nphi_);
+
+  if (map_->IsBuilding()) {
+    // Only the photons of the events that are tracked through
+    // count, and the event action tells which ones they are
+    event_action_ = dynamic_cast<DefaultEventAction*>
+      (G4EventManager::GetEventManager()->GetUserEventAction());
+    if (!event_action_)
+      G4Exception("[OpticalCullingStackingAction]", "Initialize()", FatalException,
+                  "Building the optical acceptance map requires the DefaultEventAction "
+                  "(or one derived from it), which selects the events by their deposited energy.");
+
+    G4cout << "[OpticalCullingStackingAction] Building the optical acceptance map "
+           << map_file_ << G4endl;
+    return;
+  }
+
+  // A cell is culled only if enough photons have been emitted from it
+  // and none of them reached a sensor
+  G4int nculled = map_->Cull(min_photons_);
+
+  G4cout << "[OpticalCullingStackingAction] " << nculled << " out of "
+         << map_->GetNumberOfCells() << " cells culled according to "
+         << map_file_ << G4endl;
+
+  if (survival_prob_ == 0.)
+    G4Exception("[OpticalCullingStackingAction]", "Initialize()", JustWarning,
+                "The survival probability is 0: the photons of the culled cells are "
+                "killed, which biases the response wherever the map is not exact.");
+}
+
+
+
+G4ClassificationOfNewTrack
+OpticalCullingStackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  static auto opticalphoton = G4OpticalPhoton::Definition();
+  if (track->GetParticleDefinition() != opticalphoton)
+    return DefaultStackingAction::ClassifyNewTrack(track);
+
+  if (map_->IsBuilding()) {
+    map_->RegisterPhoton(track, IsReemitted(track));
+  }
+  else if (survival_prob_ < 1. && !IsReemitted(track)) {
+    G4int cell = map_->FindCell(track->GetPosition(), track->GetMomentumDirection());
+    if (map_->IsCulled(cell)) {
+      // Russian roulette keeps the expected sensor response
+      if (G4UniformRand() >= survival_prob_)
+        return G4ClassificationOfNewTrack::fKill;
+      const_cast<G4Track*>(track)->SetWeight(track->GetWeight() / survival_prob_);
+    }
+  }
+
+  return DefaultStackingAction::ClassifyNewTrack(track);
+}
+
+
+
+void OpticalCullingStackingAction::NewStage()
+{
+  // The photons of events outside the energy range are discarded
+  // without being tracked, so they must not count as emitted
+  if (map_->IsBuilding() && !event_action_ -> IsDepositedEnergyInRange())
+    map_->DiscardEvent();
+
+  DefaultStackingAction::NewStage();
+}
+
+
+
+void OpticalCullingStackingAction::PrepareNewEvent()
+{
+  if (!map_) Initialize();
+
+  map_->ClearEvent();
+
+  DefaultStackingAction::PrepareNewEvent();
+}
+
+
+
+G4bool OpticalCullingStackingAction::IsReemitted(const G4Track* track) const
+{
+  // Wavelength shifting processes are the only ones
+  // that apply to optical photons and create new ones
+  const G4VProcess* creator = track->GetCreatorProcess();
+  return creator && creator->IsApplicable(*G4OpticalPhoton::Definition());
+}
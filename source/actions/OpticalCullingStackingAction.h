@@ -0,0 +1,64 @@
+// ----------------------------------------------------------------------------
+// nexus | OpticalCullingStackingAction.h
+//
+// Stacking action that kills the new optical photons emitted from a
+// (position, direction) cell from which no photon has ever been seen to
+// reach a sensor, or keeps them with a survival probability and the
+// inverse weight. The acceptance map is built in a calibration run and
+// cached in a file. Otherwise, it behaves as the DefaultStackingAction.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef OPTICAL_CULLING_STACKING_ACTION_H
+#define OPTICAL_CULLING_STACKING_ACTION_H
+
+#include "DefaultStackingAction.h"
+
+#include <G4ThreeVector.hh>
+
+class G4GenericMessenger;
+
+
+namespace nexus {
+
+  class OpticalAcceptanceMap;
+  class DefaultEventAction;
+
+  class OpticalCullingStackingAction: public DefaultStackingAction
+  {
+  public:
+    /// Constructor
+    OpticalCullingStackingAction();
+    /// Destructor. The acceptance map is saved after a calibration run.
+    ~OpticalCullingStackingAction();
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+    virtual void NewStage();
+    virtual void PrepareNewEvent();
+
+  private:
+    void Initialize();
+
+    /// True if the photon was created by another optical photon
+    /// (wavelength shifting), in which case its ancestor counts
+    G4bool IsReemitted(const G4Track*) const;
+
+  private:
+    G4GenericMessenger* msg_;
+
+    G4String map_file_; ///< File caching the acceptance map
+    G4bool calibrate_;  ///< Rebuild the map even if the file exists
+    G4ThreeVector region_min_, region_max_; ///< Region covered by the map
+    G4int nx_, ny_, nz_;  ///< Number of position bins per axis
+    G4int ncostheta_, nphi_; ///< Number of direction bins
+    G4int min_photons_; ///< Photons needed in a cell to cull it
+    G4double survival_prob_; ///< Probability of a culled photon to survive (with weight 1/p)
+
+    OpticalAcceptanceMap* map_;
+    DefaultEventAction* event_action_; ///< Selects the events while building the map
+  };
+
+} // end namespace nexus
+
+#endif
@@ -13,6 +13,7 @@
 #include "Trajectory.h"
 #include "TrajectoryMap.h"
 #include "FactoryBase.h"
+#include "RunTelemetry.h"
 
 #include <G4Track.hh>
 #include <G4TrackingManager.hh>
@@ -39,6 +40,9 @@ OpticalTrackingAction::~OpticalTrackingAction()
 
 void OpticalTrackingAction::PreUserTrackingAction(const G4Track* track)
 {
+  if (RunTelemetry* telemetry = RunTelemetry::Instance())
+    telemetry->CountTrack(track);
+
   // Create a new trajectory associated to the track.
   // N.B. If the processesing of a track is interrupted to be resumed
   // later on (to process, for instance, its secondaries) more than
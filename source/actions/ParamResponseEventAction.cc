@@ -0,0 +1,286 @@
+// ----------------------------------------------------------------------------
+// nexus | ParamResponseEventAction.cc
+//
+// Event action that simulates a parametrized detector response at the end
+// of the event. The ionization hits are turned into S2 (ionization charge
+// drifted analytically and converted to light with an S2 light table) and
+// S1 (scintillation light distributed with an S1 light table) sensor
+// waveforms, without creating any ionization electron or optical photon.
+// Otherwise, it behaves as the DefaultEventAction.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "ParamResponseEventAction.h"
+
+#include "IonizationHit.h"
+#include "SensorHit.h"
+#include "LightTableHits.h"
+#include "UniformElectricDriftField.h"
+#include "FactoryBase.h"
+
+#include <G4Event.hh>
+#include <G4GenericMessenger.hh>
+#include <G4HCofThisEvent.hh>
+#include <G4Navigator.hh>
+#include <G4TransportationManager.hh>
+#include <G4LogicalVolume.hh>
+#include <G4Material.hh>
+#include <G4Region.hh>
+#include <G4Poisson.hh>
+#include <Randomize.hh>
+
+#include "CLHEP/Units/SystemOfUnits.h"
+
+
+namespace nexus {
+
+  using namespace CLHEP;
+
+REGISTER_CLASS(ParamResponseEventAction, G4UserEventAction)
+
+  namespace {
+    uint64_t Key(G4int high, G4int low)
+    {
+      return (uint64_t(uint32_t(high)) << 32) | uint32_t(low);
+    }
+  }
+
+
+  ParamResponseEventAction::ParamResponseEventAction():
+    DefaultEventAction(), msg_(0), geom_navigator_(0),
+    s2_file_(""), s1_file_(""), el_transit_(0.), ioni_energy_(22.4*eV),
+    fano_factor_(.15), initialized_(false), s2_table_(0), s1_table_(0),
+    s2_hits_(0), s1_hits_(0)
+  {
+    msg_ = new G4GenericMessenger(this, "/Actions/ParamResponseEventAction/");
+
+    msg_->DeclareProperty("s2_table", s2_file_,
+                          "S2 light table: mean detected photons per ionization electron.");
+    msg_->DeclareProperty("s1_table", s1_file_,
+                          "S1 light table: detection probability of a scintillation photon.");
+
+    G4GenericMessenger::Command& transit_cmd =
+      msg_->DeclarePropertyWithUnit("el_transit_time", "ns", el_transit_,
+                                    "Time taken by the ionization electrons to cross the EL gap.");
+    transit_cmd.SetParameterName("el_transit_time", false);
+    transit_cmd.SetRange("el_transit_time>=0.");
+
+    G4GenericMessenger::Command& ioni_cmd =
+      msg_->DeclarePropertyWithUnit("ioni_energy", "eV", ioni_energy_,
+                                    "Average energy needed to produce an ionization pair.");
+    ioni_cmd.SetParameterName("ioni_energy", false);
+    ioni_cmd.SetRange("ioni_energy>0.");
+
+    G4GenericMessenger::Command& fano_cmd =
+      msg_->DeclareProperty("fano_factor", fano_factor_,
+                            "Fano factor of the ionization charge.");
+    fano_cmd.SetParameterName("fano_factor", false);
+    fano_cmd.SetRange("fano_factor>=0.");
+
+    geom_navigator_ =
+      G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
+  }
+
+
+
+  ParamResponseEventAction::~ParamResponseEventAction()
+  {
+    delete s2_hits_;
+    delete s1_hits_;
+    delete s2_table_;
+    delete s1_table_;
+    delete msg_;
+  }
+
+
+
+  void ParamResponseEventAction::Initialize()
+  {
+    if (s2_file_ == "" && s1_file_ == "") {
+      G4Exception("[ParamResponseEventAction]", "Initialize()", FatalException,
+                  "No S1 or S2 light table given.");
+    }
+
+    // The response of each sensor is added to the
+    // hits collection of its sensitive detector
+    if (s2_file_ != "") {
+      s2_table_ = new LightTable(s2_file_);
+      s2_hits_  = new LightTableHits(*s2_table_);
+    }
+    if (s1_file_ != "") {
+      s1_table_ = new LightTable(s1_file_);
+      s1_hits_  = new LightTableHits(*s1_table_);
+    }
+  }
+
+
+
+  void ParamResponseEventAction::EndOfEventAction(const G4Event* event)
+  {
+    DefaultEventAction::EndOfEventAction(event);
+
+    G4HCofThisEvent* hce = event->GetHCofThisEvent();
+    if (event->IsAborted() || !hce) return;
+
+    if (!initialized_) {
+      Initialize();
+      initialized_ = true;
+    }
+
+    s2_expected_.clear();
+
+    for (G4int i=0; i<hce->GetNumberOfCollections(); ++i) {
+      IonizationHitsCollection* hits =
+        dynamic_cast<IonizationHitsCollection*>(hce->GetHC(i));
+      if (!hits) continue;
+
+      for (size_t j=0; j<hits->entries(); ++j) {
+        if (s2_table_) AddS2((*hits)[j]);
+        if (s1_table_) SimulateS1((*hits)[j], hce);
+      }
+    }
+
+    // The S2 photons of each time bin are sampled at once
+    for (const auto& expected : s2_expected_) {
+      G4int isensor = G4int(expected.first >> 32);
+      G4int bin     = G4int(expected.first & 0xFFFFFFFF);
+      G4int counts  = G4int(G4Poisson(expected.second));
+      if (counts == 0) continue;
+
+      SensorHit* hit = s2_hits_->GetHit(isensor, hce);
+      if (hit) hit->Fill((bin + 0.5) * s2_hits_->GetBinSize(isensor), counts);
+    }
+  }
+
+
+
+  void ParamResponseEventAction::AddS2(IonizationHit* hit)
+  {
+    // As in the clustering process, charges are produced
+    // only in the regions with a drift field
+    G4ThreeVector position = hit->GetPosition();
+    G4VPhysicalVolume* vol =
+      geom_navigator_->LocateGlobalPointAndSetup(position, 0, false);
+    if (!vol) return;
+
+    G4Region* region = vol->GetLogicalVolume()->GetRegion();
+    UniformElectricDriftField* field =
+      dynamic_cast<UniformElectricDriftField*>(region->GetUserInformation());
+    if (!field || field->GetDriftVelocity() <= 0.) return;
+
+    // Only the charges between anode and cathode drift
+    EAxis axis = field->GetAxis();
+    G4double anode   = field->GetAnodePosition();
+    G4double cathode = field->GetCathodePosition();
+    if (position[axis] > std::max(anode, cathode) ||
+        position[axis] < std::min(anode, cathode)) return;
+
+    G4int num_charges = NumberOfCharges(hit->GetEnergyDeposit());
+    if (num_charges == 0) return;
+
+    // Same drift as in UniformElectricDriftField, done analytically
+    G4double drift_length = std::abs(position[axis] - anode);
+    G4double drift_time   = drift_length / field->GetDriftVelocity();
+    G4double transv_sigma = field->GetTransverseDiffusion() * sqrt(drift_length);
+    G4double time_sigma   = field->GetLongitudinalDiffusion() * sqrt(drift_length)
+                          / field->GetDriftVelocity();
+    G4double survival     = exp(-drift_time / field->GetLifetime());
+
+    for (G4int i=0; i<num_charges; ++i) {
+      if (G4UniformRand() >= survival) continue;
+
+      G4ThreeVector arrival = position;
+      for (G4int coord=0; coord<3; ++coord) {
+        if (coord != axis) arrival[coord] = G4RandGauss::shoot(position[coord], transv_sigma);
+        else arrival[coord] = anode;
+      }
+
+      G4double time = hit->GetTime() + drift_time + G4RandGauss::shoot(0., time_sigma);
+      if (time < 0.) time = hit->GetTime() + drift_time;
+
+      // The light is emitted uniformly while crossing the EL gap
+      s2_table_->ForEachSensor(arrival, [&](G4int isensor, G4double value) {
+        G4double binsize = s2_hits_->GetBinSize(isensor);
+        if (el_transit_ <= 0.) {
+          s2_expected_[Key(isensor, G4int(time / binsize))] += value;
+          return;
+        }
+        G4double end = time + el_transit_;
+        for (G4int bin = G4int(time / binsize); bin * binsize < end; ++bin) {
+          G4double overlap = std::min(end, (bin + 1) * binsize) - std::max(time, bin * binsize);
+          s2_expected_[Key(isensor, bin)] += value * overlap / el_transit_;
+        }
+      });
+    }
+  }
+
+
+
+  void ParamResponseEventAction::SimulateS1(IonizationHit* hit, G4HCofThisEvent* hce)
+  {
+    G4ThreeVector position = hit->GetPosition();
+    if (!s1_table_->Contains(position)) return;
+
+    G4VPhysicalVolume* vol =
+      geom_navigator_->LocateGlobalPointAndSetup(position, 0, false);
+    if (!vol) return;
+
+    G4MaterialPropertiesTable* mpt =
+      vol->GetLogicalVolume()->GetMaterial()->GetMaterialPropertiesTable();
+    if (!mpt || !mpt->ConstPropertyExists("SCINTILLATIONYIELD")) return;
+
+    G4double mean = mpt->GetConstProperty("SCINTILLATIONYIELD") * hit->GetEnergyDeposit();
+
+    // Fast and slow components of the scintillation
+    if (!mpt->ConstPropertyExists("SCINTILLATIONTIMECONSTANT1")) {
+      G4String material = vol->GetLogicalVolume()->GetMaterial()->GetName();
+      G4Exception("[ParamResponseEventAction]", "SimulateS1()", FatalException,
+                  ("The scintillation time constant (SCINTILLATIONTIMECONSTANT1) "
+                   "of " + material + " is not defined.").c_str());
+    }
+    G4double tau1 = mpt->GetConstProperty("SCINTILLATIONTIMECONSTANT1");
+    G4double tau2 = mpt->ConstPropertyExists("SCINTILLATIONTIMECONSTANT2") ?
+      mpt->GetConstProperty("SCINTILLATIONTIMECONSTANT2") : tau1;
+    G4double frac1 = 1.;
+    if (mpt->ConstPropertyExists("SCINTILLATIONYIELD1") &&
+        mpt->ConstPropertyExists("SCINTILLATIONYIELD2")) {
+      G4double y1 = mpt->GetConstProperty("SCINTILLATIONYIELD1");
+      G4double y2 = mpt->GetConstProperty("SCINTILLATIONYIELD2");
+      frac1 = y1 / (y1 + y2);
+    }
+
+    // The photons detected by each sensor are Poisson distributed
+    s1_table_->ForEachSensor(position, [&](G4int isensor, G4double prob) {
+      G4int counts = G4int(G4Poisson(mean * prob));
+      if (counts == 0) return;
+
+      SensorHit* shit = s1_hits_->GetHit(isensor, hce);
+      if (!shit) return;
+
+      for (G4int i=0; i<counts; ++i) {
+        G4double tau = (G4UniformRand() < frac1) ? tau1 : tau2;
+        shit->Fill(hit->GetTime() - tau * log(G4UniformRand()) +
+                   s1_table_->SampleArrivalTime(position));
+      }
+    });
+  }
+
+
+
+  G4int ParamResponseEventAction::NumberOfCharges(G4double energy) const
+  {
+    // Same fluctuations as in the IonizationClustering process
+    G4double mean = energy / ioni_energy_;
+
+    if (mean > 10.) {
+      G4double sigma = sqrt(mean*fano_factor_);
+      return std::max(G4int(G4RandGauss::shoot(mean, sigma) + 0.5), 0);
+    }
+    else {
+      return G4int(G4Poisson(mean));
+    }
+  }
+
+
+} // end namespace nexus
@@ -0,0 +1,76 @@
+// ----------------------------------------------------------------------------
+// nexus | ParamResponseEventAction.h
+//
+// Event action that simulates a parametrized detector response at the end
+// of the event. The ionization hits are turned into S2 (ionization charge
+// drifted analytically and converted to light with an S2 light table) and
+// S1 (scintillation light distributed with an S1 light table) sensor
+// waveforms, without creating any ionization electron or optical photon.
+// Otherwise, it behaves as the DefaultEventAction.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef PARAM_RESPONSE_EVENT_ACTION_H
+#define PARAM_RESPONSE_EVENT_ACTION_H
+
+#include "DefaultEventAction.h"
+#include "LightTable.h"
+
+#include <unordered_map>
+
+class G4HCofThisEvent;
+class G4Navigator;
+
+namespace nexus {
+
+  class IonizationHit;
+  class LightTableHits;
+
+  class ParamResponseEventAction: public DefaultEventAction
+  {
+  public:
+    /// Constructor
+    ParamResponseEventAction();
+    /// Destructor
+    ~ParamResponseEventAction();
+
+    /// Hook at the end of the event loop
+    void EndOfEventAction(const G4Event*);
+
+  private:
+    /// Load the light tables and find their sensors in the geometry
+    void Initialize();
+
+    /// Add the S2 light expected from a hit
+    void AddS2(IonizationHit*);
+    /// Simulate the S1 light detected from a hit
+    void SimulateS1(IonizationHit*, G4HCofThisEvent*);
+
+    /// Number of ionization electrons produced by an energy deposit
+    G4int NumberOfCharges(G4double energy) const;
+
+  private:
+    G4GenericMessenger* msg_;
+    G4Navigator* geom_navigator_; ///< Geometry navigator
+
+    G4String s2_file_; ///< S2 light table (mean detected photons per ionization electron)
+    G4String s1_file_; ///< S1 light table (detection probability of a scintillation photon)
+    G4double el_transit_; ///< Time taken by the ionization electrons to cross the EL gap
+    G4double ioni_energy_; ///< Average energy needed to produce an ionization pair
+    G4double fano_factor_; ///< Fano factor of the ionization charge
+
+    G4bool initialized_;
+    LightTable* s2_table_;
+    LightTable* s1_table_;
+
+    LightTableHits* s2_hits_;
+    LightTableHits* s1_hits_;
+
+    /// Expected S2 photons per (sensor, time bin) of the current event
+    std::unordered_map<uint64_t, G4double> s2_expected_;
+  };
+
+} // namespace nexus
+
+#endif
@@ -0,0 +1,228 @@
+// ----------------------------------------------------------------------------
+// nexus | ProfilingSteppingAction.cc
+//
+// Stepping action that counts the steps per particle, volume and process
+// defining the step, and estimates the time spent in them. Only one step
+// out of every sampling_period, on average, is timed, so that the clock is
+// seldom read. It relies on the ProfilingTrackingAction to count the
+// tracks. The counters are reset at the beginning of every run, and
+// the report is printed and stored in the output file at its end.
+//
+// The stepping action actually needed by the simulation, if any, is
+// wrapped with the command /Actions/ProfilingSteppingAction/wrap.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "ProfilingSteppingAction.h"
+
+#include "FactoryBase.h"
+
+#include <G4Step.hh>
+#include <G4Track.hh>
+#include <G4LogicalVolume.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4VProcess.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4GenericMessenger.hh>
+#include <G4RunManager.hh>
+#include <G4Run.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+using namespace nexus;
+
+REGISTER_CLASS(ProfilingSteppingAction, G4UserSteppingAction)
+
+
+
+ProfilingSteppingAction::ProfilingSteppingAction():
+  G4UserSteppingAction(), msg_(0), report_lines_(20), sampling_period_(20),
+  last_key_{0, 0, 0}, last_counters_(0), run_id_(-1), countdown_(1), mark_(0)
+{
+  msg_ = new G4GenericMessenger(this, "/Actions/ProfilingSteppingAction/");
+
+  msg_->DeclareMethod("wrap", &ProfilingSteppingAction::Wrap,
+                      "Stepping action called on every step, besides the profiling.");
+
+  G4GenericMessenger::Command& lines_cmd =
+    msg_->DeclareProperty("report_lines", report_lines_,
+                          "Number of entries of the profile printed at the end of the run.");
+  lines_cmd.SetParameterName("report_lines", false);
+  lines_cmd.SetRange("report_lines>=0");
+
+  G4GenericMessenger::Command& period_cmd =
+    msg_->DeclareProperty("sampling_period", sampling_period_,
+                          "Mean number of steps per step timed (1 times them all).");
+  period_cmd.SetParameterName("sampling_period", false);
+  period_cmd.SetRange("sampling_period>0");
+
+  mark_ = Now();
+}
+
+
+
+ProfilingSteppingAction::~ProfilingSteppingAction()
+{
+  delete msg_;
+}
+
+
+
+void ProfilingSteppingAction::Wrap(const G4String& name)
+{
+  wrapped_ = ObjFactory<G4UserSteppingAction>::Instance().CreateObject(name);
+  if (fpSteppingManager) wrapped_->SetSteppingManagerPointer(fpSteppingManager);
+}
+
+
+
+void ProfilingSteppingAction::SetSteppingManagerPointer(G4SteppingManager* manager)
+{
+  G4UserSteppingAction::SetSteppingManagerPointer(manager);
+  if (wrapped_) wrapped_->SetSteppingManagerPointer(manager);
+}
+
+
+
+void ProfilingSteppingAction::UserSteppingAction(const G4Step* step)
+{
+  if (wrapped_) wrapped_->UserSteppingAction(step);
+
+  // The time since the previous step includes the stepping
+  // itself, the sensitive detectors and the other actions,
+  // but not the bookkeeping below
+  uint64_t now = countdown_ == 1 ? Now() : 0;
+
+  CheckRun();
+
+  Key key = {step->GetTrack()->GetDefinition(),
+             step->GetPreStepPoint()->GetTouchableHandle()->GetVolume()->GetLogicalVolume(),
+             step->GetPostStepPoint()->GetProcessDefinedStep()};
+
+  // Every step is counted, but most only count down to the next
+  // one timed. The clock is read at the end of the step before it.
+  Counters& counters = Find(key);
+  counters.steps += 1;
+
+  if (countdown_ > 1) {
+    if (--countdown_ == 1) mark_ = Now();
+    return;
+  }
+
+  counters.nanoseconds += (now - mark_) * sampling_period_;
+
+  countdown_ = NextGap();
+  if (countdown_ == 1) mark_ = Now();
+}
+
+
+
+void ProfilingSteppingAction::StartTrack(const G4Track* track)
+{
+  CheckRun();
+
+  Key key = {track->GetDefinition(),
+             track->GetVolume() ? track->GetVolume()->GetLogicalVolume() : 0,
+             track->GetCreatorProcess()};
+
+  Find(key).tracks += 1;
+
+  // The time between tracks (stacking, end of event...) is not charged
+  if (countdown_ == 1) mark_ = Now();
+}
+
+
+
+void ProfilingSteppingAction::CheckRun()
+{
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  G4int run_id = run ? run->GetRunID() : -1;
+  if (run_id == run_id_) return;
+
+  counters_.clear();
+  last_counters_ = 0;
+  run_id_ = run_id;
+}
+
+
+
+ProfilingSteppingAction::Counters& ProfilingSteppingAction::Find(const Key& key)
+{
+  // Consecutive lookups tend to share particle, volume and process
+  if (last_counters_ && key == last_key_) return *last_counters_;
+
+  last_key_ = key;
+  last_counters_ = &counters_[key];
+  return *last_counters_;
+}
+
+
+
+uint64_t ProfilingSteppingAction::NextGap()
+{
+  // A random gap avoids sampling in step with any periodic pattern
+  if (sampling_period_ == 1) return 1;
+  return 1 + gaps_() % (2 * sampling_period_ - 1);
+}
+
+
+
+uint64_t ProfilingSteppingAction::Now()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+
+std::vector<ProfilingSteppingAction::Entry> ProfilingSteppingAction::GetReport() const
+{
+  std::vector<Entry> report;
+  report.reserve(counters_.size());
+
+  for (const auto& c : counters_) {
+    Entry entry;
+    entry.particle = c.first.particle ? c.first.particle->GetParticleName() : "none";
+    entry.volume   = c.first.volume   ? c.first.volume->GetName()           : "none";
+    entry.process  = c.first.process  ? c.first.process->GetProcessName()   : "none";
+    entry.steps    = c.second.steps;
+    entry.tracks   = c.second.tracks;
+    entry.time     = c.second.nanoseconds * 1.e-9;
+    report.push_back(entry);
+  }
+
+  std::sort(report.begin(), report.end(),
+            [](const Entry& a, const Entry& b) { return a.time > b.time; });
+
+  return report;
+}
+
+
+
+void ProfilingSteppingAction::PrintReport() const
+{
+  std::vector<Entry> report = GetReport();
+
+  G4double total = 0.;
+  for (const auto& entry : report) total += entry.time;
+
+  G4cout << "[ProfilingSteppingAction] Time spent in steps: " << total << " s" << G4endl;
+  G4cout << std::setw(8)  << "time (s)" << std::setw(7) << "%"
+         << std::setw(12) << "steps" << std::setw(10) << "tracks"
+         << "  particle / volume / process" << G4endl;
+
+  std::streamsize precision = G4cout.precision();
+  G4int nlines = std::min(G4int(report.size()), report_lines_);
+  for (G4int i=0; i<nlines; ++i) {
+    const Entry& entry = report[i];
+    G4cout << std::setw(8)  << std::setprecision(3) << entry.time
+           << std::setw(7)  << std::setprecision(3) << (total > 0. ? 100. * entry.time / total : 0.)
+           << std::setw(12) << entry.steps << std::setw(10) << entry.tracks
+           << "  " << entry.particle << " / " << entry.volume
+           << " / " << entry.process << G4endl;
+  }
+  G4cout.precision(precision);
+}
@@ -0,0 +1,127 @@
+// ----------------------------------------------------------------------------
+// nexus | ProfilingSteppingAction.h
+//
+// Stepping action that counts the steps per particle, volume and process
+// defining the step, and estimates the time spent in them. Only one step
+// out of every sampling_period, on average, is timed, so that the clock is
+// seldom read. It relies on the ProfilingTrackingAction to count the
+// tracks. The counters are reset at the beginning of every run, and
+// the report is printed and stored in the output file at its end.
+//
+// The stepping action actually needed by the simulation, if any, is
+// wrapped with the command /Actions/ProfilingSteppingAction/wrap.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef PROFILING_STEPPING_ACTION_H
+#define PROFILING_STEPPING_ACTION_H
+
+#include <G4UserSteppingAction.hh>
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <functional>
+#include <cstdint>
+
+class G4Track;
+class G4ParticleDefinition;
+class G4LogicalVolume;
+class G4VProcess;
+class G4GenericMessenger;
+
+
+namespace nexus {
+
+  class ProfilingSteppingAction: public G4UserSteppingAction
+  {
+  public:
+    /// Constructor
+    ProfilingSteppingAction();
+    /// Destructor
+    ~ProfilingSteppingAction();
+
+    void UserSteppingAction(const G4Step*) override;
+    void SetSteppingManagerPointer(G4SteppingManager*) override;
+
+    /// Create the stepping action called on every step
+    /// (a name registered in the factory)
+    void Wrap(const G4String&);
+
+    /// Count a new track, under the process that created it.
+    /// The time until its first step is charged to that step.
+    void StartTrack(const G4Track*);
+
+    struct Entry {
+      G4String particle;
+      G4String volume;
+      G4String process;
+      uint64_t steps;
+      uint64_t tracks;
+      G4double time;  ///< Estimated, in seconds
+    };
+
+    /// Counters of the current run, sorted by decreasing time
+    std::vector<Entry> GetReport() const;
+
+    /// Print the most expensive entries of the report
+    void PrintReport() const;
+
+  private:
+    struct Key {
+      const G4ParticleDefinition* particle;
+      const G4LogicalVolume* volume;
+      const G4VProcess* process;
+      bool operator==(const Key& k) const
+      { return particle == k.particle && volume == k.volume && process == k.process; }
+    };
+
+    struct KeyHash {
+      size_t operator()(const Key& k) const
+      {
+        size_t h = std::hash<const void*>()(k.particle);
+        h = h * 31 + std::hash<const void*>()(k.volume);
+        return h * 31 + std::hash<const void*>()(k.process);
+      }
+    };
+
+    struct Counters {
+      uint64_t steps = 0;
+      uint64_t tracks = 0;
+      uint64_t nanoseconds = 0;
+    };
+
+    /// Counters of a key, reusing those of the last lookup when possible
+    Counters& Find(const Key&);
+
+    /// Clear the counters if a new run has started
+    void CheckRun();
+
+    /// Steps until the next one timed, uniform in [1, 2*period-1]
+    uint64_t NextGap();
+
+    /// Monotonic clock, in nanoseconds
+    static uint64_t Now();
+
+  private:
+    G4GenericMessenger* msg_;
+    G4int report_lines_; ///< Entries of the printed report
+    G4int sampling_period_; ///< Mean number of steps per step timed
+
+    std::unique_ptr<G4UserSteppingAction> wrapped_;
+
+    std::unordered_map<Key, Counters, KeyHash> counters_;
+    Key last_key_;
+    Counters* last_counters_;
+    G4int run_id_; ///< Run the counters belong to
+
+    uint64_t countdown_; ///< Steps until the next one timed (1: the next one)
+    uint64_t mark_;      ///< Clock at the end of the step before the one timed
+    std::minstd_rand gaps_; ///< Own engine, not to alter the simulation
+  };
+
+} // end namespace nexus
+
+#endif
@@ -0,0 +1,81 @@
+// ----------------------------------------------------------------------------
+// nexus | ProfilingTrackingAction.cc
+//
+// Tracking action that counts the tracks for the ProfilingSteppingAction,
+// which must be in use too. The tracking action actually needed by the
+// simulation, if any, is wrapped with the command
+// /Actions/ProfilingTrackingAction/wrap.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "ProfilingTrackingAction.h"
+
+#include "ProfilingSteppingAction.h"
+#include "FactoryBase.h"
+
+#include <G4RunManager.hh>
+#include <G4GenericMessenger.hh>
+
+using namespace nexus;
+
+REGISTER_CLASS(ProfilingTrackingAction, G4UserTrackingAction)
+
+
+ProfilingTrackingAction::ProfilingTrackingAction():
+  G4UserTrackingAction(), msg_(0), profiler_(0), initialized_(false)
+{
+  msg_ = new G4GenericMessenger(this, "/Actions/ProfilingTrackingAction/");
+
+  msg_->DeclareMethod("wrap", &ProfilingTrackingAction::Wrap,
+                      "Tracking action called for every track, besides the profiling.");
+}
+
+
+
+ProfilingTrackingAction::~ProfilingTrackingAction()
+{
+  delete msg_;
+}
+
+
+
+void ProfilingTrackingAction::Wrap(const G4String& name)
+{
+  wrapped_ = ObjFactory<G4UserTrackingAction>::Instance().CreateObject(name);
+  if (fpTrackingManager) wrapped_->SetTrackingManagerPointer(fpTrackingManager);
+}
+
+
+
+void ProfilingTrackingAction::SetTrackingManagerPointer(G4TrackingManager* manager)
+{
+  G4UserTrackingAction::SetTrackingManagerPointer(manager);
+  if (wrapped_) wrapped_->SetTrackingManagerPointer(manager);
+}
+
+
+
+void ProfilingTrackingAction::PreUserTrackingAction(const G4Track* track)
+{
+  // The user actions are only known once they have all been registered
+  if (!initialized_) {
+    profiler_ = dynamic_cast<ProfilingSteppingAction*>
+      (const_cast<G4UserSteppingAction*>(G4RunManager::GetRunManager()->GetUserSteppingAction()));
+    if (!profiler_)
+      G4Exception("[ProfilingTrackingAction]", "PreUserTrackingAction()", JustWarning,
+                  "The tracks are not profiled without the ProfilingSteppingAction.");
+    initialized_ = true;
+  }
+
+  if (wrapped_) wrapped_->PreUserTrackingAction(track);
+
+  if (profiler_) profiler_->StartTrack(track);
+}
+
+
+
+void ProfilingTrackingAction::PostUserTrackingAction(const G4Track* track)
+{
+  if (wrapped_) wrapped_->PostUserTrackingAction(track);
+}
@@ -0,0 +1,51 @@
+// ----------------------------------------------------------------------------
+// nexus | ProfilingTrackingAction.h
+//
+// Tracking action that counts the tracks for the ProfilingSteppingAction,
+// which must be in use too. The tracking action actually needed by the
+// simulation, if any, is wrapped with the command
+// /Actions/ProfilingTrackingAction/wrap.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef PROFILING_TRACKING_ACTION_H
+#define PROFILING_TRACKING_ACTION_H
+
+#include <G4UserTrackingAction.hh>
+
+#include <memory>
+
+class G4GenericMessenger;
+
+
+namespace nexus {
+
+  class ProfilingSteppingAction;
+
+  class ProfilingTrackingAction: public G4UserTrackingAction
+  {
+  public:
+    /// Constructor
+    ProfilingTrackingAction();
+    /// Destructor
+    virtual ~ProfilingTrackingAction();
+
+    virtual void PreUserTrackingAction(const G4Track*);
+    virtual void PostUserTrackingAction(const G4Track*);
+    virtual void SetTrackingManagerPointer(G4TrackingManager*);
+
+    /// Create the tracking action called for every track
+    /// (a name registered in the factory)
+    void Wrap(const G4String&);
+
+  private:
+    G4GenericMessenger* msg_;
+    std::unique_ptr<G4UserTrackingAction> wrapped_;
+    ProfilingSteppingAction* profiler_;
+    G4bool initialized_;
+  };
+
+}
+
+#endif
@@ -1,10 +1,13 @@
 // ----------------------------------------------------------------------------
 // nexus | SaveAllSteppingAction.cc
 //
-// This class adds a new group and table to the output file, "/DEBUG/steps".
-// This table contains information (position and volume of both the
+// This class adds a new group and tables to the output file, "/DEBUG/steps"
+// and "/DEBUG/string_map".
+// The steps table contains information (position and volume of both the
 // pre- and post-step points, average time, process name and other identifiers)
-// of some steps of the simulation. By default all steps are stored. However,
+// of some steps of the simulation. Particle, volume and process names are
+// stored as integer IDs, whose names are given in the string map table.
+// By default all steps are stored. However,
 // a subset of them can be selected by cherry-picking the volumes and particles
 // involved in the step. This can be achieved with the commands
 // /Actions/SaveAllSteppingAction/select_particle
@@ -19,11 +22,13 @@
 // ----------------------------------------------------------------------------
 
 #include "SaveAllSteppingAction.h"
-#include "PersistencyManager.h"
+#include "PersistencyManagerBase.h"
 #include "FactoryBase.h"
+#include "hdf5_functions.h"
 
 #include <G4Step.hh>
 #include <G4VPersistencyManager.hh>
+#include <G4VPhysicalVolume.hh>
 #include <G4ProcessManager.hh>
 #include <G4ParticleTable.hh>
 
@@ -36,12 +41,12 @@ G4UserSteppingAction(),
 msg_(0),
 selected_volumes_(),
 selected_particles_(),
-initial_volumes_(),
-final_volumes_(),
-proc_names_(),
-initial_poss_(),
-final_poss_(),
-times_(),
+steps_(new step_columns_t()),
+step_counts_(),
+name_ids_(),
+name_map_(),
+names_(),
+volume_selection_(),
 kill_after_selection_(false)
 {
   msg_ = new G4GenericMessenger(this, "/Actions/SaveAllSteppingAction/");
@@ -56,7 +61,7 @@ kill_after_selection_(false)
   msg_->DeclareProperty("kill_after_selection", kill_after_selection_,
                         "Whether to kill a particle after a step has been selected");
 
-  PersistencyManager* pm = dynamic_cast<PersistencyManager*>
+  PersistencyManagerBase* pm = dynamic_cast<PersistencyManagerBase*>
         (G4VPersistencyManager::GetPersistencyManager());
 
   pm->StoreSteps(true);
@@ -67,44 +72,51 @@ kill_after_selection_(false)
 
 SaveAllSteppingAction::~SaveAllSteppingAction()
 {
+  delete msg_;
+  delete steps_;
 }
 
 
 
 void SaveAllSteppingAction::UserSteppingAction(const G4Step* step)
 {
-  G4ParticleDefinition* pdef          = step->GetTrack()->GetDefinition();
-  G4int                 track_id      = step->GetTrack()->GetTrackID();
-  G4String              particle_name = pdef->GetParticleName();
+  G4ParticleDefinition* pdef = step->GetTrack()->GetDefinition();
 
   if (!KeepParticle(pdef)) return;
 
   G4StepPoint* pre  = step->GetPreStepPoint();
   G4StepPoint* post = step->GetPostStepPoint();
 
-  G4ThreeVector initial_pos = pre ->GetPosition();
-  G4ThreeVector   final_pos = post->GetPosition();
-  G4double        step_time = (pre->GetGlobalTime()  +
-                              post->GetGlobalTime()) / 2.;
+  const G4VPhysicalVolume* initial_volume = pre ->GetPhysicalVolume();
+  const G4VPhysicalVolume*   final_volume = post->GetPhysicalVolume();
 
-  if (! post->GetTouchableHandle()->GetVolume()) return; // Particle exits the world
-
-  G4String initial_volume = pre ->GetTouchableHandle()->GetVolume()->GetName();
-  G4String   final_volume = post->GetTouchableHandle()->GetVolume()->GetName();
-  G4String      proc_name = post->GetProcessDefinedStep()->GetProcessName();
+  if (!final_volume) return; // Particle exits the world
 
   if (!KeepVolume(initial_volume, final_volume))
     return;
 
-  std::pair<G4int, G4String> key = std::make_pair(track_id, particle_name);
-
-  initial_volumes_[key].push_back(initial_volume);
-    final_volumes_[key].push_back(  final_volume);
-       proc_names_[key].push_back(     proc_name);
-
-  initial_poss_   [key].push_back(initial_pos);
-    final_poss_   [key].push_back(  final_pos);
-         times_   [key].push_back(  step_time);
+  const G4VProcess* proc = post->GetProcessDefinedStep();
+
+  G4int track_id = step->GetTrack()->GetTrackID();
+  if (track_id >= (G4int) step_counts_.size())
+    step_counts_.resize(2 * track_id + 1, 0);
+
+  const G4ThreeVector& initial_pos = pre ->GetPosition();
+  const G4ThreeVector&   final_pos = post->GetPosition();
+
+  steps_->particle_id   .push_back(track_id);
+  steps_->particle_name .push_back(FindNameID(pdef, pdef->GetParticleName()));
+  steps_->step_id       .push_back(step_counts_[track_id]++);
+  steps_->initial_volume.push_back(FindNameID(initial_volume, initial_volume->GetName()));
+  steps_->  final_volume.push_back(FindNameID(  final_volume,   final_volume->GetName()));
+  steps_->     proc_name.push_back(FindNameID(proc, proc->GetProcessName()));
+  steps_->initial_x     .push_back(initial_pos.x());
+  steps_->initial_y     .push_back(initial_pos.y());
+  steps_->initial_z     .push_back(initial_pos.z());
+  steps_->  final_x     .push_back(  final_pos.x());
+  steps_->  final_y     .push_back(  final_pos.y());
+  steps_->  final_z     .push_back(  final_pos.z());
+  steps_->time          .push_back((pre->GetGlobalTime() + post->GetGlobalTime()) / 2.);
 
   if (kill_after_selection_)
     step->GetTrack()->SetTrackStatus(fStopAndKill);
@@ -125,6 +137,7 @@ void SaveAllSteppingAction::AddSelectedParticle(G4String particle_name)
 void SaveAllSteppingAction::AddSelectedVolume(G4String volume_name)
 {
   selected_volumes_.push_back(volume_name);
+  volume_selection_.clear();
 }
 
 
@@ -137,28 +150,58 @@ G4bool SaveAllSteppingAction::KeepParticle(G4ParticleDefinition* pdef)
 }
 
 
-G4bool SaveAllSteppingAction::KeepVolume(G4String& initial_volume, G4String& final_volume)
+G4bool SaveAllSteppingAction::KeepVolume(const G4VPhysicalVolume* initial_volume,
+                                         const G4VPhysicalVolume*   final_volume)
 {
   if (!selected_volumes_.size()) return true;
 
-  for (auto volume=selected_volumes_.begin(); volume != selected_volumes_.end(); volume++)
-  {
-    if (G4StrUtil::contains(initial_volume, *volume)) return true;
-    if (G4StrUtil::contains(  final_volume, *volume)) return true;
+  return IsSelectedVolume(initial_volume) || IsSelectedVolume(final_volume);
+}
+
+
+G4bool SaveAllSteppingAction::IsSelectedVolume(const G4VPhysicalVolume* volume)
+{
+  // The name matching is done only the first time a volume is seen
+  auto cached = volume_selection_.find(volume);
+  if (cached != volume_selection_.end()) return cached->second;
+
+  G4bool selected = false;
+  for (auto name=selected_volumes_.begin(); name != selected_volumes_.end(); name++) {
+    if (G4StrUtil::contains(volume->GetName(), *name)) {
+      selected = true;
+      break;
+    }
+  }
+
+  volume_selection_[volume] = selected;
+  return selected;
+}
+
+
+G4int SaveAllSteppingAction::FindNameID(const void* ptr, const G4String& name)
+{
+  auto found = name_ids_.find(ptr);
+  if (found != name_ids_.end()) return found->second;
+
+  // Different objects may share the same name
+  auto found_name = name_map_.find(name);
+  G4int id;
+  if (found_name != name_map_.end()) {
+    id = found_name->second;
+  } else {
+    id = names_.size();
+    name_map_[name] = id;
+    names_.push_back(name);
   }
 
-  return false;
+  name_ids_[ptr] = id;
+  return id;
 }
 
 
 
 void SaveAllSteppingAction::Reset()
 {
-  initial_volumes_.clear();
-    final_volumes_.clear();
-       proc_names_.clear();
-
-  initial_poss_   .clear();
-    final_poss_   .clear();
-         times_   .clear();
+  steps_->clear();
+  std::fill(step_counts_.begin(), step_counts_.end(), 0);
 }
@@ -1,10 +1,13 @@
 // ----------------------------------------------------------------------------
 // nexus | SaveAllSteppingAction.h
 //
-// This class adds a new group and table to the output file, "/DEBUG/steps".
-// This table contains information (position and volume of both the
+// This class adds a new group and tables to the output file, "/DEBUG/steps"
+// and "/DEBUG/string_map".
+// The steps table contains information (position and volume of both the
 // pre- and post-step points, average time, process name and other identifiers)
-// of some steps of the simulation. By default all steps are stored. However,
+// of some steps of the simulation. Particle, volume and process names are
+// stored as integer IDs, whose names are given in the string map table.
+// By default all steps are stored. However,
 // a subset of them can be selected by cherry-picking the volumes and particles
 // involved in the step. This can be achieved with the commands
 // /Actions/SaveAllSteppingAction/select_particle
@@ -25,16 +28,16 @@
 #include <G4UserSteppingAction.hh>
 #include <G4ParticleDefinition.hh>
 #include <G4GenericMessenger.hh>
-#include <G4ThreeVector.hh>
 #include <globals.hh>
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 class G4Step;
+class G4VPhysicalVolume;
 
-template<typename T>
-using StepContainer = std::map<std::pair<G4int, G4String>, std::vector<T>>;
+struct step_columns_t;
 
 
 namespace nexus {
@@ -57,42 +60,40 @@ namespace nexus {
     std::vector<G4String>              selected_volumes_;
     std::vector<G4ParticleDefinition*> selected_particles_;
 
-    StepContainer<G4String> initial_volumes_;
-    StepContainer<G4String>   final_volumes_;
-    StepContainer<G4String>      proc_names_;
+    /// Steps of the current event, one column per field
+    step_columns_t* steps_;
 
-    StepContainer<G4ThreeVector> initial_poss_;
-    StepContainer<G4ThreeVector>   final_poss_;
-    StepContainer<G4double>             times_;
+    /// Number of steps stored per track ID in the current event
+    std::vector<G4int> step_counts_;
+
+    /// Interned names: ID of the name of each particle, volume or process
+    std::unordered_map<const void*, G4int> name_ids_;
+    std::map<G4String, G4int> name_map_;
+    std::vector<G4String> names_;
+
+    /// Cached result of the volume selection for each physical volume
+    std::unordered_map<const G4VPhysicalVolume*, G4bool> volume_selection_;
 
     G4bool kill_after_selection_;
 
   public:
 
-    StepContainer<G4String> get_initial_volumes();
-    StepContainer<G4String> get_final_volumes();
-    StepContainer<G4String> get_proc_names();
-
-    StepContainer<G4ThreeVector> get_initial_poss();
-    StepContainer<G4ThreeVector> get_final_poss();
-    StepContainer<G4double>      get_times();
+    step_columns_t& GetSteps();
+    const std::vector<G4String>& GetNames() const;
 
     void Reset();
 
   private:
     void   AddSelectedParticle(G4String);
     void   AddSelectedVolume  (G4String);
-    G4bool        KeepVolume  (G4String&, G4String&);
+    G4bool        KeepVolume  (const G4VPhysicalVolume*, const G4VPhysicalVolume*);
+    G4bool  IsSelectedVolume  (const G4VPhysicalVolume*);
     G4bool        KeepParticle(G4ParticleDefinition*);
+    G4int         FindNameID  (const void*, const G4String&);
   };
 
-inline StepContainer<G4String> SaveAllSteppingAction::get_initial_volumes(){return initial_volumes_;}
-inline StepContainer<G4String> SaveAllSteppingAction::get_final_volumes  (){return   final_volumes_;}
-inline StepContainer<G4String> SaveAllSteppingAction::get_proc_names     (){return      proc_names_;}
-
-inline StepContainer<G4ThreeVector> SaveAllSteppingAction::get_initial_poss(){return initial_poss_;}
-inline StepContainer<G4ThreeVector> SaveAllSteppingAction::get_final_poss  (){return   final_poss_;}
-inline StepContainer<G4double>      SaveAllSteppingAction::get_times       (){return        times_;}
+inline step_columns_t& SaveAllSteppingAction::GetSteps() {return *steps_;}
+inline const std::vector<G4String>& SaveAllSteppingAction::GetNames() const {return names_;}
 
 } // namespace nexus
 
@@ -84,3 +84,9 @@ const GeometryBase* DetectorConstruction::GetGeometry() const
 {
   return geometry_.get();
 }
+
+
+G4bool DetectorConstruction::UpdateGeometry()
+{
+  return geometry_ && geometry_->UpdateParameters();
+}
@@ -35,6 +35,9 @@ namespace nexus {
     void SetGeometry(std::unique_ptr<GeometryBase>);
     /// Get the detector geometry
     const GeometryBase* GetGeometry() const;
+    /// Propagate the parameters changed since the construction to
+    /// the geometry already built. Returns false if it cannot be done.
+    G4bool UpdateGeometry();
 
   private:
     std::unique_ptr<GeometryBase> geometry_;
@@ -14,10 +14,12 @@
 #include "GeometryBase.h"
 #include "DetectorConstruction.h"
 #include "PrimaryGeneration.h"
+#include "PrefetchGenerator.h"
 #include "FactoryBase.h"
 
 #include <G4GenericPhysicsList.hh>
 #include <G4UImanager.hh>
+#include <G4UIcommandStatus.hh>
 #include <G4StateManager.hh>
 #include <G4VPrimaryGenerator.hh>
 #include <G4VPersistencyManager.hh>
@@ -26,6 +28,31 @@
 #include <G4UserTrackingAction.hh>
 #include <G4UserSteppingAction.hh>
 #include <G4UserStackingAction.hh>
+#include <G4Event.hh>
+#include <G4VModularPhysicsList.hh>
+#include <G4VPhysicsConstructor.hh>
+#include <G4ParticleTable.hh>
+#include <G4ProcessManager.hh>
+#include <G4ProcessVector.hh>
+#include <G4VProcess.hh>
+#include <G4EmParameters.hh>
+#include <G4Material.hh>
+#include <G4Element.hh>
+#include <G4IonisParamMat.hh>
+#include <G4MaterialPropertiesTable.hh>
+#include <G4ProductionCutsTable.hh>
+#include <G4ProductionCuts.hh>
+#include <G4RegionStore.hh>
+#include <G4Region.hh>
+#include <G4Version.hh>
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <cstdint>
+#include <unistd.h>
 
 using namespace nexus;
 using std::make_unique;
@@ -36,7 +63,13 @@ NexusApp::NexusApp(G4String init_macro): G4RunManager(), gen_name_(""),
                                          geo_name_(""), pm_name_(""),
                                          runact_name_(""), evtact_name_(""),
                                          stepact_name_(""), trkact_name_(""),
-                                         stkact_name_(""), pman_(false)
+                                         stkact_name_(""), pman_(false),
+                                         prefetch_events_(0), prefetch_(nullptr),
+                                         physics_table_cache_(""),
+                                         physics_table_hash_(""),
+                                         defer_output_(false),
+                                         scan_parameter_(""), scan_values_(""),
+                                         scan_unit_("")
 {
   // Create and configure a generic messenger for the app
   msg_ = make_unique<G4GenericMessenger>(this, "/nexus/", "Nexus control commands.");
@@ -71,6 +104,35 @@ NexusApp::NexusApp(G4String init_macro): G4RunManager(), gen_name_(""),
   msg_->DeclareProperty("RegisterTrackingAction", trkact_name_, "");
   msg_->DeclareProperty("RegisterStackingAction", stkact_name_, "");
 
+  // Define the command to generate the primaries of the next events
+  // in a helper thread while the current one is tracked. It must be
+  // given in the initialization macro, like the generator.
+  G4GenericMessenger::Command& prefetch_cmd =
+    msg_->DeclareProperty("prefetch_events", prefetch_events_,
+                          "Number of events whose primaries are generated in advance.");
+  prefetch_cmd.SetParameterName("prefetch_events", false);
+  prefetch_cmd.SetRange("prefetch_events>=0");
+
+  // Define the command to set the directory where the physics tables
+  // are cached. Jobs with the same physics configuration retrieve the
+  // tables from there instead of building them.
+  msg_->DeclareProperty("physics_table_cache", physics_table_cache_,
+                        "Directory of the physics-table cache.");
+
+  // Define the commands of the parameter scan. The geometry must be
+  // able to propagate the scanned parameter to the volumes already
+  // built (see GeometryBase::UpdateParameters).
+  scan_msg_ = make_unique<G4GenericMessenger>(this, "/nexus/scan/",
+                                              "Parameter scan commands.");
+  scan_msg_->DeclareProperty("parameter", scan_parameter_,
+                             "Command setting the parameter to scan.");
+  scan_msg_->DeclareProperty("values", scan_values_,
+                             "Values of the parameter, separated by spaces.");
+  scan_msg_->DeclareProperty("unit", scan_unit_, "Unit of the values.");
+
+  // The telemetry defines its own commands under /nexus/telemetry/
+  telemetry_ = make_unique<RunTelemetry>();
+
 
   /////////////////////////////////////////////////////////
 
@@ -102,7 +164,13 @@ NexusApp::NexusApp(G4String init_macro): G4RunManager(), gen_name_(""),
   if (gen_name_.empty()) {
     G4Exception("[NexusApp]", "NexusApp()", FatalException, "A generator must be specified.");
   }
-  pg->SetGenerator(ObjFactory<G4VPrimaryGenerator>::Instance().CreateObject(gen_name_));
+  auto generator = ObjFactory<G4VPrimaryGenerator>::Instance().CreateObject(gen_name_);
+  if (prefetch_events_ > 0) {
+    auto prefetch = make_unique<PrefetchGenerator>(std::move(generator), prefetch_events_);
+    prefetch_ = prefetch.get();
+    generator = std::move(prefetch);
+  }
+  pg->SetGenerator(std::move(generator));
   this->SetUserAction(pg.release());
 
 
@@ -188,7 +256,8 @@ void NexusApp::Initialize()
 
   G4RunManager::Initialize();
 
-  if (pman_) {
+  // In a scan, each value of the parameter gets its own file
+  if (pman_ && !defer_output_ && scan_parameter_.empty()) {
     pm_->OpenFile();
   }
 
@@ -205,6 +274,178 @@ void NexusApp::Initialize()
 
 
 
+void NexusApp::RunInitialization()
+{
+  // The physics tables are built in the initialization of the first run,
+  // once the geometry, the physics and the cuts are fully configured.
+  // They are looked up again whenever the configuration changes (e.g.,
+  // the materials or their optical properties in a scan), which also
+  // makes Geant4 rebuild them, as after /run/physicsModified.
+  G4bool use_cache = false;
+  std::filesystem::path cache_dir;
+
+  if (!physics_table_cache_.empty()) {
+    G4String hash = PhysicsConfigurationHash();
+    if (hash != physics_table_hash_) {
+      if (!physics_table_hash_.empty()) PhysicsHasBeenModified();
+      physics_table_hash_ = hash;
+      use_cache = true;
+
+      cache_dir = std::filesystem::path(physics_table_cache_) / hash;
+      if (std::filesystem::is_directory(cache_dir)) {
+        G4cout << "[NexusApp] Retrieving physics tables from " << cache_dir.string() << G4endl;
+        physicsList->SetPhysicsTableRetrieved(cache_dir.string());
+      }
+    }
+  }
+
+  G4RunManager::RunInitialization();
+
+  if (use_cache) {
+    // Rebuilds with the same configuration (e.g., after
+    // /run/physicsModified) must not use the cache
+    if (physicsList->IsPhysicsTableRetrieved()) physicsList->ResetPhysicsTableRetrieved();
+    else StorePhysicsTables(cache_dir);
+  }
+
+  if (!fakeRun) telemetry_->BeginOfRun(numberOfEventToBeProcessed);
+}
+
+
+
+void NexusApp::ProcessOneEvent(G4int i_event)
+{
+  telemetry_->BeginOfEvent();
+  // Before the primaries are generated, so that
+  // the seed of the event can be captured
+  if (pman_) pm_->BeginOfEvent();
+  G4RunManager::ProcessOneEvent(i_event);
+}
+
+
+
+void NexusApp::TerminateOneEvent()
+{
+  telemetry_->EndOfEvent(currentEvent->GetEventID());
+  // The user information of the primaries belongs to the helper thread
+  if (prefetch_) prefetch_->EndOfEvent(currentEvent);
+  G4RunManager::TerminateOneEvent();
+}
+
+
+
+void NexusApp::RunTermination()
+{
+  // The generator must be idle before the commands
+  // of the next run modify it
+  if (prefetch_) prefetch_->EndOfRun();
+
+  // The summary must be ready before the persistency
+  // manager stores the run
+  if (!fakeRun) telemetry_->EndOfRun();
+  G4RunManager::RunTermination();
+}
+
+
+
+void NexusApp::BeamOn(G4int n_event, const char* macroFile, G4int n_select)
+{
+  if (scan_parameter_.empty()) {
+    G4RunManager::BeamOn(n_event, macroFile, n_select);
+    return;
+  }
+
+  std::vector<G4String> values;
+  std::istringstream ss(scan_values_);
+  for (G4String value; ss >> value; ) values.push_back(value);
+
+  if (values.empty()) {
+    G4Exception("[NexusApp]", "BeamOn()", FatalException,
+                "No values given for the parameter scan.");
+  }
+
+  G4UImanager* UI = G4UImanager::GetUIpointer();
+  G4String base_name = UI->GetCurrentValues("/nexus/persistency/output_file");
+  auto geometry = static_cast<DetectorConstruction*>(userDetector);
+
+  std::vector<G4String> commands;
+  for (const auto& value : values) {
+    G4String command = scan_parameter_ + " " + value;
+    if (!scan_unit_.empty()) command += " " + scan_unit_;
+    commands.push_back(command);
+  }
+
+  // Everything is checked before the first run, so that a scan
+  // does not fail (or silently do nothing) after some of its points
+  std::vector<G4String> scannable;
+  if (geometry->GetGeometry()) scannable = geometry->GetGeometry()->ScannableParameters();
+
+  if (scannable.empty()) {
+    G4Exception("[NexusApp]", "BeamOn()", FatalException,
+                ("The geometry " + geo_name_ + " does not support parameter scans.").c_str());
+  }
+
+  if (std::find(scannable.begin(), scannable.end(), scan_parameter_) == scannable.end()) {
+    G4String message = scan_parameter_ + " cannot be scanned with the geometry " +
+      geo_name_ + ". The parameters that can are:";
+    for (const auto& parameter : scannable) message += " " + parameter;
+    G4Exception("[NexusApp]", "BeamOn()", FatalException, message.c_str());
+  }
+
+  for (const auto& command : commands) {
+    if (UI->ApplyCommand(command) != fCommandSucceeded) {
+      G4Exception("[NexusApp]", "BeamOn()", FatalException,
+                  ("Scan command failed: " + command).c_str());
+    }
+  }
+
+  for (std::size_t i=0; i<commands.size(); ++i) {
+    const G4String& command = commands[i];
+    UI->ApplyCommand(command);
+
+    // The geometry was built by Initialize() with the values set in
+    // the macros, so every value (the first one too) is propagated to it
+    if (geometryInitialized && !geometry->UpdateGeometry()) {
+      G4Exception("[NexusApp]", "BeamOn()", FatalException,
+                  ("The geometry cannot update " + scan_parameter_ +
+                   " without being built again.").c_str());
+    }
+
+    std::ostringstream output_file;
+    output_file << base_name << "_scan_" << std::setw(3) << std::setfill('0') << i;
+
+    G4cout << "[NexusApp] Scan point " << i << ": " << command << G4endl;
+
+    OpenOutputFile(output_file.str(), {command});
+    G4RunManager::BeamOn(n_event, macroFile, n_select);
+    CloseOutputFile();
+  }
+
+  UI->ApplyCommand("/nexus/persistency/output_file " + base_name);
+}
+
+
+
+void NexusApp::OpenOutputFile(const G4String& output_file,
+                              const std::vector<G4String>& commands)
+{
+  if (!pman_) return;
+
+  pm_->CloseFile();
+  G4UImanager::GetUIpointer()->ApplyCommand("/nexus/persistency/output_file " + output_file);
+  pm_->SetJobCommands(commands);
+  pm_->OpenFile();
+}
+
+
+
+void NexusApp::CloseOutputFile()
+{
+  if (pman_) pm_->CloseFile();
+}
+
+
+
 void NexusApp::ExecuteMacroFile(const char* filename)
 {
   G4UImanager* UI = G4UImanager::GetUIpointer();
@@ -224,3 +465,134 @@ void NexusApp::SetRandomSeed(G4int seed)
   if (seed < 0) CLHEP::HepRandom::setTheSeed(time(0));
   else CLHEP::HepRandom::setTheSeed(seed);
 }
+
+
+
+G4String NexusApp::PhysicsConfigurationHash() const
+{
+  std::ostringstream config;
+  config.precision(std::numeric_limits<G4double>::max_digits10);
+
+  config << G4VERSION_NUMBER << "\n";
+  for (const char* var: {"G4LEDATA", "G4LEVELGAMMADATA", "G4RADIOACTIVEDATA",
+                         "G4ENSDFSTATEDATA", "G4PARTICLEXSDATA", "G4NEUTRONHPDATA",
+                         "G4INCLDATA", "G4ABLADATA", "G4PIIDATA", "G4SAIDXSDATA",
+                         "G4REALSURFACEDATA"}) {
+    const char* value = std::getenv(var);
+    config << var << "=" << (value ? value : "") << "\n";
+  }
+
+  // Physics constructors and the processes they attached to each
+  // particle, which depend on the physics options (EL, clustering...)
+  auto modular = dynamic_cast<const G4VModularPhysicsList*>(physicsList);
+  for (G4int i=0; modular && modular->GetPhysics(i); ++i)
+    config << modular->GetPhysics(i)->GetPhysicsName() << "\n";
+
+  G4ParticleTable::G4PTblDicIterator* particle_it =
+    G4ParticleTable::GetParticleTable()->GetIterator();
+  particle_it->reset();
+  while ((*particle_it)()) {
+    G4ParticleDefinition* particle = particle_it->value();
+    G4ProcessManager* pmanager = particle->GetProcessManager();
+    if (!pmanager) continue;
+    config << particle->GetParticleName() << ":";
+    G4ProcessVector* processes = pmanager->GetProcessList();
+    for (std::size_t i=0; i<processes->size(); ++i)
+      config << " " << (*processes)[i]->GetProcessName();
+    config << "\n";
+  }
+
+  config << *G4EmParameters::Instance();
+
+  // Materials, with the optical properties used by the integral tables
+  for (const G4Material* material: *G4Material::GetMaterialTable()) {
+    config << material->GetName() << " " << material->GetDensity() << " "
+           << material->GetTemperature() << " " << material->GetPressure() << " "
+           << material->GetState() << " "
+           << material->GetIonisation()->GetMeanExcitationEnergy();
+
+    for (G4int i=0; i<G4int(material->GetNumberOfElements()); ++i) {
+      const G4Element* element = material->GetElement(i);
+      config << " " << element->GetName() << " " << element->GetZ() << " "
+             << element->GetA() << " " << material->GetFractionVector()[i];
+    }
+
+    const G4MaterialPropertiesTable* mpt = material->GetMaterialPropertiesTable();
+    if (mpt) {
+      const std::vector<G4String> names = mpt->GetMaterialPropertyNames();
+      const std::vector<G4MaterialPropertyVector*>& properties = mpt->GetProperties();
+      for (std::size_t i=0; i<properties.size(); ++i) {
+        const G4MaterialPropertyVector* property = properties[i];
+        if (!property) continue;
+        config << " " << names[i];
+        for (std::size_t j=0; j<property->GetVectorLength(); ++j)
+          config << " " << property->Energy(j) << " " << (*property)[j];
+      }
+
+      const std::vector<G4String> const_names = mpt->GetMaterialConstPropertyNames();
+      const std::vector<std::pair<G4double, G4bool>>& constants = mpt->GetConstProperties();
+      for (std::size_t i=0; i<constants.size(); ++i)
+        if (constants[i].second)
+          config << " " << const_names[i] << " " << constants[i].first;
+    }
+    config << "\n";
+  }
+
+  // Production cuts of every region and energy range of the tables
+  G4ProductionCutsTable* cuts_table = G4ProductionCutsTable::GetProductionCutsTable();
+  config << cuts_table->GetLowEdgeEnergy() << " " << cuts_table->GetHighEdgeEnergy() << "\n";
+  for (const G4Region* region: *G4RegionStore::GetInstance()) {
+    config << region->GetName();
+    const G4ProductionCuts* cuts = region->GetProductionCuts();
+    for (G4int i=0; cuts && i<4; ++i) config << " " << cuts->GetProductionCut(i);
+    config << "\n";
+  }
+
+  // 64-bit FNV-1a, which is stable across builds and platforms
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c: config.str()) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+  return hex.str();
+}
+
+
+
+void NexusApp::StorePhysicsTables(const std::filesystem::path& dir)
+{
+  std::error_code ec;
+
+  // An entry that could not be retrieved (e.g., incomplete or written
+  // by another version of nexus) is replaced by the tables just built
+  if (std::filesystem::exists(dir)) {
+    G4Exception("[NexusApp]", "StorePhysicsTables()", JustWarning,
+                ("The physics tables could not be retrieved from " + dir.string() +
+                 " and have been built and stored again.").c_str());
+    std::filesystem::path stale = dir;
+    stale += ".stale" + std::to_string(getpid());
+    std::filesystem::rename(dir, stale, ec);
+    std::filesystem::remove_all(stale, ec);
+  }
+
+  // The tables are written to a directory of this job and then renamed,
+  // so that concurrent jobs never retrieve an incomplete set of tables
+  std::filesystem::path tmp = dir;
+  tmp += ".tmp" + std::to_string(getpid());
+
+  std::filesystem::create_directories(tmp, ec);
+  if (ec || !physicsList->StorePhysicsTable(tmp.string())) {
+    G4Exception("[NexusApp]", "StorePhysicsTables()", JustWarning,
+                ("The physics tables could not be stored in " + tmp.string()).c_str());
+    std::filesystem::remove_all(tmp, ec);
+    return;
+  }
+
+  // If another job stored the same tables first, keep those
+  std::filesystem::rename(tmp, dir, ec);
+  if (ec) std::filesystem::remove_all(tmp, ec);
+  else    G4cout << "[NexusApp] Physics tables stored in " << dir.string() << G4endl;
+}
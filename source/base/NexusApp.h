@@ -12,14 +12,19 @@
 #define NEXUS_APP_H
 
 #include "PersistencyManagerBase.h"
+#include "RunTelemetry.h"
 
 #include <G4RunManager.hh>
 
+#include <filesystem>
+
 class G4GenericMessenger;
 
 
 namespace nexus {
 
+  class PrefetchGenerator;
+
   class NexusApp: public G4RunManager
   {
   public:
@@ -30,9 +35,31 @@ namespace nexus {
 
     virtual void Initialize();
 
+    virtual void RunInitialization();
+    virtual void ProcessOneEvent(G4int i_event);
+    virtual void TerminateOneEvent();
+    virtual void RunTermination();
+
+    /// Run the events requested. If a parameter scan is configured
+    /// with the /nexus/scan/ commands, run them once per value of
+    /// the parameter instead, each run writing its own output file.
+    /// The parameter must be one the geometry can scan, and every
+    /// value is checked, before the first run.
+    virtual void BeamOn(G4int n_event, const char* macroFile=0, G4int n_select=-1);
+
     /// Returns the number of events to be processed in the current run
     G4int GetNumberOfEventsToBeProcessed() const;
 
+    /// Do not open the output file in Initialize(). The server
+    /// opens one for every job with OpenOutputFile() instead.
+    void DeferOutputFile();
+
+    /// Close the current output file, if any, and open a new one,
+    /// which records the given job commands in its configuration
+    void OpenOutputFile(const G4String& output_file,
+                        const std::vector<G4String>& commands);
+    void CloseOutputFile();
+
   private:
     void RegisterMacro(G4String);
 
@@ -44,6 +71,14 @@ namespace nexus {
     /// If a negative value is chosen, the system time is set as seed.
     void SetRandomSeed(G4int);
 
+    /// Hash of what the physics tables depend on: Geant4 version and
+    /// data, physics constructors and processes, EM parameters,
+    /// materials (including their optical properties) and cuts
+    G4String PhysicsConfigurationHash() const;
+
+    /// Store the physics tables just built in the cache directory
+    void StorePhysicsTables(const std::filesystem::path&);
+
   private:
     std::unique_ptr<G4GenericMessenger> msg_;
     G4String gen_name_; ///< Name of the chosen primary generator
@@ -57,11 +92,26 @@ namespace nexus {
 
     G4bool pman_; ///< True if the persistency manager is set
 
+    G4int prefetch_events_; ///< Number of events whose primaries are generated in advance
+    PrefetchGenerator* prefetch_; ///< Wrapper of the generator, if prefetching
+
+    G4String physics_table_cache_; ///< Directory of the physics-table cache, if any
+    G4String physics_table_hash_; ///< Configuration hash of the physics tables last built
+
+    G4bool defer_output_; ///< True if the output file is not opened in Initialize()
+
+    std::unique_ptr<G4GenericMessenger> scan_msg_;
+    G4String scan_parameter_; ///< Command scanned, e.g. /Geometry/Next100/EL_field
+    G4String scan_values_; ///< Values of the parameter, separated by spaces
+    G4String scan_unit_; ///< Unit of the values, if any
+
     std::vector<G4String> macros_;
     std::vector<G4String> delayed_;
 
     std::unique_ptr<PersistencyManagerBase> pm_;
 
+    std::unique_ptr<RunTelemetry> telemetry_; ///< Progress and cost monitoring
+
   };
 
   // INLINE DEFINITIONS ////////////////////////////////////
@@ -69,6 +119,9 @@ namespace nexus {
   inline G4int NexusApp::GetNumberOfEventsToBeProcessed() const
   { return numberOfEventToBeProcessed; }
 
+  inline void NexusApp::DeferOutputFile()
+  { defer_output_ = true; }
+
 } // namespace nexus
 
 #endif
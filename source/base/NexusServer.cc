@@ -0,0 +1,295 @@
+// ----------------------------------------------------------------------------
+// nexus | NexusServer.cc
+//
+// Server mode of nexus. The application is initialized once and then runs
+// the jobs received over a UNIX domain socket, one at a time, replying to
+// each of them with a status line. A job is a macro sent as text lines and
+// ended by an empty line. It must set its output file with the command
+// /nexus/persistency/output_file and ask for the events with /run/beamOn;
+// its other commands (e.g., generator settings) are applied before the run.
+//
+// Every job runs in a child process forked from the initialized server, so
+// the settings it changes and the random engine state it leaves go away
+// with it, and the next job starts again from the configuration given by
+// the macros. A job that ends abnormally (e.g., with a fatal exception) is
+// reported as failed, and the server goes on with the next one.
+//
+// The reply is either "OK events=<n> time=<s>" or "ERROR <reason>". A job
+// made of the single line "shutdown" stops the server.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "NexusServer.h"
+
+#include "NexusApp.h"
+
+#include <G4UImanager.hh>
+#include <G4UIcommandStatus.hh>
+#include <G4Run.hh>
+
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace nexus;
+
+
+namespace {
+
+  // Do not get killed by SIGPIPE if a client goes away
+#ifdef MSG_NOSIGNAL
+  const int send_flags = MSG_NOSIGNAL;
+#else
+  const int send_flags = 0;
+#endif
+
+  G4bool MakeAddress(const G4String& path, sockaddr_un& addr)
+  {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    return true;
+  }
+
+}
+
+
+
+NexusServer::NexusServer(NexusApp* app, const G4String& socket_path):
+  app_(app), socket_path_(socket_path), fd_(-1), stop_(false)
+{
+  sockaddr_un addr;
+  if (!MakeAddress(socket_path_, addr)) {
+    G4Exception("[NexusServer]", "NexusServer()", FatalException,
+                ("Socket path too long: " + socket_path_).c_str());
+  }
+
+  fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  // Remove the socket left behind by a previous server, if any
+  unlink(socket_path_.c_str());
+
+  if (fd_ < 0 ||
+      bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+      listen(fd_, 16) < 0) {
+    G4Exception("[NexusServer]", "NexusServer()", FatalException,
+                ("Cannot listen on " + socket_path_ + ": " +
+                 std::strerror(errno)).c_str());
+  }
+
+  G4cout << "[NexusServer] Listening on " << socket_path_ << G4endl;
+}
+
+
+
+NexusServer::~NexusServer()
+{
+  if (fd_ >= 0) {
+    close(fd_);
+    unlink(socket_path_.c_str());
+  }
+}
+
+
+
+void NexusServer::Serve()
+{
+  while (!stop_) {
+    int conn = accept(fd_, nullptr, nullptr);
+    if (conn < 0) {
+      if (errno == EINTR) continue;
+      G4Exception("[NexusServer]", "Serve()", JustWarning,
+                  (G4String("Cannot accept connections: ") + std::strerror(errno)).c_str());
+      return;
+    }
+
+    G4String reply = RunJob(ReadJob(conn));
+    G4cout << "[NexusServer] " << reply << G4endl;
+
+    WriteAll(conn, reply + "\n");
+    close(conn);
+  }
+}
+
+
+
+G4String NexusServer::RunJob(const std::vector<G4String>& lines)
+{
+  if (lines.size() == 1 && lines[0] == "shutdown") {
+    stop_ = true;
+    return "OK shutdown";
+  }
+
+  // The output file and the run are handled by the server,
+  // so that each job gets a complete file of its own
+  G4String output_file;
+  G4int nevents = -1;
+  std::vector<G4String> commands;
+
+  for (const auto& line : lines) {
+    std::istringstream ss(line);
+    G4String command;
+    ss >> command;
+
+    if (command.empty() || command[0] == '#') continue;
+    else if (command == "/nexus/persistency/output_file") ss >> output_file;
+    else if (command == "/run/beamOn") ss >> nevents;
+    else commands.push_back(line);
+  }
+
+  if (output_file.empty())
+    return "ERROR the job does not set /nexus/persistency/output_file";
+  if (nevents < 0)
+    return "ERROR the job does not call /run/beamOn";
+
+  // The job runs in a child process, so that neither the settings
+  // it changes nor a fatal error can affect the server
+  int channel[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, channel) < 0)
+    return G4String("ERROR cannot start the job: ") + std::strerror(errno);
+
+  // Otherwise, the pending output would be written by both processes
+  G4cout.flush();
+  std::cout.flush();
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    close(channel[0]);
+    close(channel[1]);
+    return G4String("ERROR cannot start the job: ") + std::strerror(errno);
+  }
+
+  if (pid == 0) {
+    close(channel[0]);
+    close(fd_);
+    G4String reply = Execute(commands, output_file, nevents);
+    app_->CloseOutputFile();
+    WriteAll(channel[1], reply + "\n");
+    G4cout.flush();
+    std::cout.flush();
+    _exit(0);
+  }
+
+  close(channel[1]);
+  std::vector<G4String> answer = ReadJob(channel[0]);
+  close(channel[0]);
+
+  int status = 0;
+  while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+
+  if (WIFSIGNALED(status))
+    return "ERROR job aborted by signal " + std::to_string(WTERMSIG(status));
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || answer.empty())
+    return "ERROR job ended with exit status " + std::to_string(WEXITSTATUS(status));
+
+  return answer[0];
+}
+
+
+
+G4String NexusServer::Execute(const std::vector<G4String>& commands,
+                              const G4String& output_file, G4int nevents)
+{
+  G4UImanager* UI = G4UImanager::GetUIpointer();
+  for (const auto& command : commands) {
+    G4int status = UI->ApplyCommand(command);
+    if (status != fCommandSucceeded)
+      return "ERROR command failed (code " + std::to_string(status) + "): " + command;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  app_->OpenOutputFile(output_file, commands);
+  app_->BeamOn(nevents);
+
+  G4double elapsed = std::chrono::duration<G4double>
+    (std::chrono::steady_clock::now() - start).count();
+
+  const G4Run* run = app_->GetCurrentRun();
+
+  std::ostringstream reply;
+  reply << "OK events=" << (run ? run->GetNumberOfEvent() : 0)
+        << " time=" << elapsed;
+  return reply.str();
+}
+
+
+
+std::vector<G4String> NexusServer::ReadJob(int fd)
+{
+  std::vector<G4String> lines;
+  std::string pending;
+  char buffer[4096];
+
+  while (true) {
+    ssize_t n = read(fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;
+    pending.append(buffer, n);
+
+    size_t pos;
+    while ((pos = pending.find('\n')) != std::string::npos) {
+      G4String line = pending.substr(0, pos);
+      pending.erase(0, pos + 1);
+      if (!line.empty() && line.back() == '\r') line.pop_back();
+      if (line.empty()) return lines;
+      lines.push_back(line);
+    }
+  }
+
+  if (!pending.empty()) lines.push_back(pending);
+  return lines;
+}
+
+
+
+G4bool NexusServer::WriteAll(int fd, const G4String& text)
+{
+  size_t sent = 0;
+  while (sent < text.size()) {
+    ssize_t n = send(fd, text.data() + sent, text.size() - sent, send_flags);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) return false;
+    sent += n;
+  }
+  return true;
+}
+
+
+
+G4String NexusServer::Submit(const G4String& socket_path,
+                             const std::vector<G4String>& lines)
+{
+  sockaddr_un addr;
+  if (!MakeAddress(socket_path, addr)) return "";
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return "";
+
+  if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+    close(fd);
+    return "";
+  }
+
+  G4String job;
+  for (const auto& line : lines)
+    if (!line.empty()) job += line + "\n";
+  job += "\n";
+
+  G4String reply;
+  if (WriteAll(fd, job)) {
+    std::vector<G4String> answer = ReadJob(fd);
+    if (!answer.empty()) reply = answer[0];
+  }
+
+  close(fd);
+  return reply;
+}
@@ -0,0 +1,71 @@
+// ----------------------------------------------------------------------------
+// nexus | NexusServer.h
+//
+// Server mode of nexus. The application is initialized once and then runs
+// the jobs received over a UNIX domain socket, one at a time, replying to
+// each of them with a status line. A job is a macro sent as text lines and
+// ended by an empty line. It must set its output file with the command
+// /nexus/persistency/output_file and ask for the events with /run/beamOn;
+// its other commands (e.g., generator settings) are applied before the run.
+//
+// Every job runs in a child process forked from the initialized server, so
+// the settings it changes and the random engine state it leaves go away
+// with it, and the next job starts again from the configuration given by
+// the macros. A job that ends abnormally (e.g., with a fatal exception) is
+// reported as failed, and the server goes on with the next one.
+//
+// The reply is either "OK events=<n> time=<s>" or "ERROR <reason>". A job
+// made of the single line "shutdown" stops the server.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef NEXUS_SERVER_H
+#define NEXUS_SERVER_H
+
+#include <globals.hh>
+
+#include <vector>
+
+
+namespace nexus {
+
+  class NexusApp;
+
+  class NexusServer
+  {
+  public:
+    /// Constructor. Listens on the given socket path.
+    NexusServer(NexusApp* app, const G4String& socket_path);
+    /// Destructor. Closes and removes the socket.
+    ~NexusServer();
+
+    /// Run the jobs received until a client asks the server to stop
+    void Serve();
+
+    /// Client side: send a job to the server listening on the socket
+    /// and return its reply (empty if the server could not be reached)
+    static G4String Submit(const G4String& socket_path,
+                           const std::vector<G4String>& lines);
+
+  private:
+    /// Run a job in a child process and return the reply to the client
+    G4String RunJob(const std::vector<G4String>& lines);
+    /// Apply the commands of a job and run its events
+    G4String Execute(const std::vector<G4String>& commands,
+                     const G4String& output_file, G4int nevents);
+
+    /// Read lines from the connection until an empty line or its end
+    static std::vector<G4String> ReadJob(int fd);
+    static G4bool WriteAll(int fd, const G4String&);
+
+  private:
+    NexusApp* app_;
+    G4String socket_path_;
+    int fd_; ///< Listening socket
+    G4bool stop_;
+  };
+
+} // end namespace nexus
+
+#endif
@@ -0,0 +1,451 @@
+// ----------------------------------------------------------------------------
+// nexus | RunTelemetry.cc
+//
+// Progress and cost monitoring of a run: throughput, estimated time to
+// completion, memory usage, tracks per event and distribution of the wall
+// time per event. Reports are printed periodically and can be written to a
+// status file (JSON lines or Prometheus textfile) read by local scrapers.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "RunTelemetry.h"
+
+#include "Trajectory.h"
+#include "TrajectoryPoint.h"
+#include "SensorHit.h"
+#include "IonizationHit.h"
+#include "IonizationElectron.h"
+
+#include <G4Track.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4GenericMessenger.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+
+namespace nexus {
+
+  namespace {
+
+    /// Bins of the wall time per event: below 1 ms, half decades
+    /// up to 10^4 s and overflow
+    const G4int    n_time_edges = 15;
+    const G4double first_time_edge = 1.e-3; // s
+
+    G4double TimeEdge(G4int i)
+    {
+      return first_time_edge * std::pow(10., 0.5 * i);
+    }
+
+    G4int TimeBin(G4double time)
+    {
+      if (time < first_time_edge) return 0;
+      G4int bin = G4int(std::floor(2. * std::log10(time / first_time_edge))) + 1;
+      return std::min(bin, n_time_edges);
+    }
+
+    /// Memory field of /proc/self/status in bytes, or -1 if not available
+    G4long ProcStatus(const std::string& field)
+    {
+      std::ifstream status("/proc/self/status");
+      std::string line;
+      while (std::getline(status, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0)
+          return std::stol(line.substr(field.size() + 1)) * 1024;
+      }
+      return -1;
+    }
+
+    G4long PeakRSS()
+    {
+      G4long peak = ProcStatus("VmHWM");
+      if (peak >= 0) return peak;
+
+      struct rusage usage;
+      if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+      return usage.ru_maxrss;
+#else
+      return usage.ru_maxrss * 1024;
+#endif
+    }
+
+    /// Memory held by the pools of the allocators of tracks,
+    /// trajectories and hits. The pools are not shrunk during
+    /// the run, so their size is also their peak usage.
+    G4long AllocatorSize()
+    {
+      std::size_t size = TrjAllocator.GetAllocatedSize() +
+                         TrjPointAllocator.GetAllocatedSize() +
+                         SensorHitAllocator.GetAllocatedSize() +
+                         IonizationHitAllocator.GetAllocatedSize();
+      if (aTrackAllocator()) size += aTrackAllocator()->GetAllocatedSize();
+      return G4long(size);
+    }
+
+    G4String FormatDuration(G4double seconds)
+    {
+      if (seconds < 0.) return "n/a";
+
+      long secs = std::lround(seconds);
+      std::ostringstream out;
+      out << std::setfill('0');
+      if (secs >= 86400) out << secs / 86400 << "d " << std::setw(2) << (secs % 86400) / 3600 << "h";
+      else if (secs >= 3600) out << secs / 3600 << "h " << std::setw(2) << (secs % 3600) / 60 << "m";
+      else if (secs >= 60) out << secs / 60 << "m " << std::setw(2) << secs % 60 << "s";
+      else out << secs << "s";
+      return out.str();
+    }
+
+    G4double MB(G4long bytes)
+    {
+      return bytes / 1048576.;
+    }
+
+  }
+
+
+
+  RunTelemetry* RunTelemetry::instance_ = 0;
+
+
+
+  RunTelemetry::RunTelemetry():
+    msg_(0), interval_(60.*s), status_file_(""), status_format_("jsonl"),
+    num_events_(0), created_(0.), init_time_(-1.),
+    run_start_(0.), event_start_(0.), last_report_(0.),
+    events_(0), photons_(0), ie_(0), evt_photons_(0), evt_ie_(0),
+    peak_allocator_(0), event_time_hist_(n_time_edges + 1, 0),
+    sum_event_time_(0.), max_event_time_(0.), slowest_event_(-1)
+  {
+    msg_ = new G4GenericMessenger(this, "/nexus/telemetry/",
+                                  "Control commands of the run telemetry.");
+
+    G4GenericMessenger::Command& interval_cmd =
+      msg_->DeclarePropertyWithUnit("report_interval", "s", interval_,
+                                    "Time between progress reports (0 disables them).");
+    interval_cmd.SetParameterName("report_interval", false);
+    interval_cmd.SetRange("report_interval>=0.");
+
+    msg_->DeclareProperty("status_file", status_file_,
+                          "File where the progress reports are written.");
+
+    G4GenericMessenger::Command& format_cmd =
+      msg_->DeclareProperty("status_format", status_format_,
+                            "Format of the status file: JSON lines or Prometheus textfile.");
+    format_cmd.SetCandidates("jsonl prometheus");
+
+    created_  = WallTime();
+    instance_ = this;
+  }
+
+
+
+  RunTelemetry::~RunTelemetry()
+  {
+    instance_ = 0;
+    delete msg_;
+  }
+
+
+
+  G4double RunTelemetry::WallTime()
+  {
+    return std::chrono::duration<G4double>
+      (std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+
+
+  void RunTelemetry::BeginOfRun(G4int num_events)
+  {
+    num_events_ = num_events;
+
+    events_ = photons_ = ie_ = 0;
+    peak_allocator_ = AllocatorSize();
+    std::fill(event_time_hist_.begin(), event_time_hist_.end(), 0);
+    sum_event_time_ = max_event_time_ = 0.;
+    slowest_event_ = -1;
+
+    run_start_ = last_report_ = WallTime();
+    last_ = Take();
+
+    // Geometry, physics tables and everything else done before the first run
+    if (init_time_ < 0.) init_time_ = run_start_ - created_;
+
+    // A JSON lines file describes the current run only
+    if (status_file_ != "" && status_format_ == "jsonl")
+      std::ofstream out(status_file_, std::ios::trunc);
+  }
+
+
+
+  void RunTelemetry::BeginOfEvent()
+  {
+    evt_photons_ = evt_ie_ = 0;
+    event_start_ = WallTime();
+  }
+
+
+
+  void RunTelemetry::CountTrack(const G4Track* track)
+  {
+    static auto opticalphoton = G4OpticalPhoton::Definition();
+    static auto ie = IonizationElectron::Definition();
+
+    if (track->GetDefinition() == opticalphoton) ++evt_photons_;
+    else if (track->GetDefinition() == ie) ++evt_ie_;
+  }
+
+
+
+  void RunTelemetry::EndOfEvent(G4int event_id)
+  {
+    G4double now = WallTime();
+    G4double event_time = now - event_start_;
+
+    ++events_;
+    photons_ += evt_photons_;
+    ie_      += evt_ie_;
+
+    event_time_hist_[TimeBin(event_time)] += 1;
+    sum_event_time_ += event_time;
+    if (event_time > max_event_time_) {
+      max_event_time_ = event_time;
+      slowest_event_  = event_id;
+    }
+
+    if (interval_ > 0. && (now - last_report_) * s >= interval_)
+      Report(false);
+  }
+
+
+
+  void RunTelemetry::EndOfRun()
+  {
+    if (events_ > 0) Report(true);
+  }
+
+
+
+  RunTelemetry::Snapshot RunTelemetry::Take() const
+  {
+    Snapshot snapshot;
+    snapshot.wall_time = WallTime() - run_start_;
+    snapshot.events    = events_;
+    snapshot.photons   = photons_;
+    snapshot.ie        = ie_;
+    snapshot.rss       = std::max(ProcStatus("VmRSS"), G4long(0));
+    snapshot.peak_rss  = PeakRSS();
+    snapshot.allocator = peak_allocator_;
+    return snapshot;
+  }
+
+
+
+  void RunTelemetry::Report(G4bool final)
+  {
+    peak_allocator_ = std::max(peak_allocator_, AllocatorSize());
+
+    Snapshot snapshot = Take();
+
+    PrintReport(snapshot, final);
+
+    if (status_file_ != "") {
+      if (status_format_ == "prometheus") WritePrometheus(snapshot, final);
+      else WriteJSON(snapshot, final);
+    }
+
+    last_report_ = WallTime();
+    last_ = snapshot;
+  }
+
+
+
+  void RunTelemetry::PrintReport(const Snapshot& snapshot, G4bool final) const
+  {
+    // Throughput and tracks since the previous report, or
+    // over the whole run for the final one
+    const Snapshot& since = final ? Snapshot() : last_;
+    G4long   events = snapshot.events - since.events;
+    G4double rate   = events / std::max(snapshot.wall_time - since.wall_time, 1.e-9);
+    G4double eta    = (num_events_ > 0) ?
+      (num_events_ - snapshot.events) * snapshot.wall_time / snapshot.events : -1.;
+
+    std::streamsize precision = G4cout.precision();
+    G4cout << std::setprecision(3)
+           << "[RunTelemetry] " << (final ? "Run summary: " : "")
+           << snapshot.events << "/" << num_events_ << " events"
+           << " | " << rate << " evt/s";
+    if (!final) G4cout << " | ETA " << FormatDuration(eta);
+    G4cout << " | RSS " << MB(snapshot.rss) << " MB (peak " << MB(snapshot.peak_rss) << " MB)"
+           << " | G4 allocators " << MB(snapshot.allocator) << " MB";
+    if (events > 0)
+      G4cout << " | " << G4double(snapshot.photons - since.photons) / events << " photons/evt, "
+             << G4double(snapshot.ie - since.ie) / events << " ie-/evt";
+    G4cout << " | evt time p50 " << EventTimeQuantile(0.5) << " s, p99 "
+           << EventTimeQuantile(0.99) << " s, max " << max_event_time_
+           << " s (event " << slowest_event_ << ")" << G4endl;
+    G4cout.precision(precision);
+  }
+
+
+
+  void RunTelemetry::WriteJSON(const Snapshot& snapshot, G4bool final) const
+  {
+    std::ofstream out(status_file_, std::ios::app);
+    if (!out.is_open()) {
+      G4Exception("[RunTelemetry]", "WriteJSON()", JustWarning,
+                  ("Could not write to the status file " + status_file_).c_str());
+      return;
+    }
+
+    // Throughput since the previous report, or
+    // over the whole run for the final one
+    const Snapshot& since = final ? Snapshot() : last_;
+    G4long   events = snapshot.events - since.events;
+    G4double rate   = events / std::max(snapshot.wall_time - since.wall_time, 1.e-9);
+    G4double eta    = (num_events_ > 0) ?
+      (num_events_ - snapshot.events) * snapshot.wall_time / snapshot.events : -1.;
+
+    out << std::setprecision(6)
+        << "{\"timestamp\": " << std::time(nullptr)
+        << ", \"final\": " << (final ? "true" : "false")
+        << ", \"init_time_s\": " << init_time_
+        << ", \"wall_time_s\": " << snapshot.wall_time
+        << ", \"events\": " << snapshot.events
+        << ", \"events_total\": " << num_events_
+        << ", \"events_per_second\": " << rate
+        << ", \"eta_s\": " << eta
+        << ", \"rss_bytes\": " << snapshot.rss
+        << ", \"peak_rss_bytes\": " << snapshot.peak_rss
+        << ", \"allocator_peak_bytes\": " << snapshot.allocator
+        << ", \"photons_per_event\": " << (events > 0 ? G4double(snapshot.photons - since.photons) / events : 0.)
+        << ", \"ie_per_event\": " << (events > 0 ? G4double(snapshot.ie - since.ie) / events : 0.)
+        << ", \"event_time_s\": {\"p50\": " << EventTimeQuantile(0.5)
+        << ", \"p90\": " << EventTimeQuantile(0.9)
+        << ", \"p99\": " << EventTimeQuantile(0.99)
+        << ", \"max\": " << max_event_time_
+        << ", \"slowest_event\": " << slowest_event_
+        << ", \"buckets\": [";
+    for (G4int i=0; i<n_time_edges; ++i)
+      out << (i ? ", " : "") << "[" << TimeEdge(i) << ", " << event_time_hist_[i] << "]";
+    out << ", [\"inf\", " << event_time_hist_[n_time_edges] << "]]}}\n";
+  }
+
+
+
+  void RunTelemetry::WritePrometheus(const Snapshot& snapshot, G4bool final) const
+  {
+    // The file is replaced in one go, so that scrapers
+    // never read a partially written one
+    G4String tmp_file = status_file_ + ".tmp";
+    std::ofstream out(tmp_file);
+    if (!out.is_open()) {
+      G4Exception("[RunTelemetry]", "WritePrometheus()", JustWarning,
+                  ("Could not write to the status file " + status_file_).c_str());
+      return;
+    }
+
+    const Snapshot& since = final ? Snapshot() : last_;
+    G4long   events = snapshot.events - since.events;
+    G4double rate   = events / std::max(snapshot.wall_time - since.wall_time, 1.e-9);
+    G4double eta    = (num_events_ > 0) ?
+      (num_events_ - snapshot.events) * snapshot.wall_time / snapshot.events : -1.;
+
+    out << std::setprecision(6)
+        << "# TYPE nexus_init_seconds gauge\n"
+        << "nexus_init_seconds " << init_time_ << "\n"
+        << "# TYPE nexus_events_processed counter\n"
+        << "nexus_events_processed " << snapshot.events << "\n"
+        << "# TYPE nexus_events_to_process gauge\n"
+        << "nexus_events_to_process " << num_events_ << "\n"
+        << "# TYPE nexus_events_per_second gauge\n"
+        << "nexus_events_per_second " << rate << "\n"
+        << "# TYPE nexus_eta_seconds gauge\n"
+        << "nexus_eta_seconds " << eta << "\n"
+        << "# TYPE nexus_rss_bytes gauge\n"
+        << "nexus_rss_bytes " << snapshot.rss << "\n"
+        << "# TYPE nexus_peak_rss_bytes gauge\n"
+        << "nexus_peak_rss_bytes " << snapshot.peak_rss << "\n"
+        << "# TYPE nexus_allocator_peak_bytes gauge\n"
+        << "nexus_allocator_peak_bytes " << snapshot.allocator << "\n"
+        << "# TYPE nexus_photons_tracked counter\n"
+        << "nexus_photons_tracked " << snapshot.photons << "\n"
+        << "# TYPE nexus_ie_tracked counter\n"
+        << "nexus_ie_tracked " << snapshot.ie << "\n"
+        << "# TYPE nexus_event_seconds histogram\n";
+
+    G4long cumulative = 0;
+    for (G4int i=0; i<n_time_edges; ++i) {
+      cumulative += event_time_hist_[i];
+      out << "nexus_event_seconds_bucket{le=\"" << TimeEdge(i) << "\"} " << cumulative << "\n";
+    }
+    out << "nexus_event_seconds_bucket{le=\"+Inf\"} " << snapshot.events << "\n"
+        << "nexus_event_seconds_sum " << sum_event_time_ << "\n"
+        << "nexus_event_seconds_count " << snapshot.events << "\n";
+    out.close();
+
+    std::rename(tmp_file.c_str(), status_file_.c_str());
+  }
+
+
+
+  G4double RunTelemetry::EventTimeQuantile(G4double fraction) const
+  {
+    if (events_ == 0) return 0.;
+
+    G4double target = fraction * events_;
+    G4long cumulative = 0;
+    for (G4int i=0; i<n_time_edges; ++i) {
+      cumulative += event_time_hist_[i];
+      if (cumulative >= target) return std::min(TimeEdge(i), max_event_time_);
+    }
+    return max_event_time_;
+  }
+
+
+
+  std::vector<std::pair<G4String, G4String>> RunTelemetry::GetSummary() const
+  {
+    // Counters at the final report of the run
+    const Snapshot& snapshot = last_;
+    G4double rate = snapshot.events / std::max(snapshot.wall_time, 1.e-9);
+
+    auto format = [](G4double value, const G4String& unit) {
+      std::ostringstream out;
+      out << std::setprecision(4) << value << unit;
+      return G4String(out.str());
+    };
+
+    std::vector<std::pair<G4String, G4String>> summary;
+    summary.push_back({"telemetry_events",            std::to_string(snapshot.events)});
+    summary.push_back({"telemetry_init_time",         format(init_time_, " s")});
+    summary.push_back({"telemetry_wall_time",         format(snapshot.wall_time, " s")});
+    summary.push_back({"telemetry_events_per_second", format(rate, "")});
+    summary.push_back({"telemetry_peak_rss",          format(MB(snapshot.peak_rss), " MB")});
+    summary.push_back({"telemetry_allocator_peak",    format(MB(peak_allocator_), " MB")});
+    if (snapshot.events > 0) {
+      summary.push_back({"telemetry_photons_per_event", format(G4double(snapshot.photons) / snapshot.events, "")});
+      summary.push_back({"telemetry_ie_per_event",      format(G4double(snapshot.ie) / snapshot.events, "")});
+    }
+    summary.push_back({"telemetry_event_time_p50", format(EventTimeQuantile(0.5), " s")});
+    summary.push_back({"telemetry_event_time_p99", format(EventTimeQuantile(0.99), " s")});
+    summary.push_back({"telemetry_event_time_max", format(max_event_time_, " s")});
+    summary.push_back({"telemetry_slowest_event",  std::to_string(slowest_event_)});
+    return summary;
+  }
+
+
+} // end namespace nexus
@@ -0,0 +1,108 @@
+// ----------------------------------------------------------------------------
+// nexus | RunTelemetry.h
+//
+// Progress and cost monitoring of a run: throughput, estimated time to
+// completion, memory usage, tracks per event and distribution of the wall
+// time per event. Reports are printed periodically and can be written to a
+// status file (JSON lines or Prometheus textfile) read by local scrapers.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef RUN_TELEMETRY_H
+#define RUN_TELEMETRY_H
+
+#include <globals.hh>
+
+#include <vector>
+#include <utility>
+
+class G4Track;
+class G4GenericMessenger;
+
+
+namespace nexus {
+
+  class RunTelemetry
+  {
+  public:
+    /// Constructor
+    RunTelemetry();
+    /// Destructor
+    ~RunTelemetry();
+
+    /// Telemetry of the application, if any. The tracking
+    /// action reports the tracks of each event to it.
+    static RunTelemetry* Instance();
+
+    void BeginOfRun(G4int num_events);
+    void BeginOfEvent();
+    void EndOfEvent(G4int event_id);
+    void EndOfRun();
+
+    /// Count a track of the current event
+    void CountTrack(const G4Track*);
+
+    /// Summary of the last run, as (key, value) pairs
+    std::vector<std::pair<G4String, G4String>> GetSummary() const;
+
+  private:
+    struct Snapshot {
+      G4double wall_time = 0.;    ///< Seconds since the start of the run
+      G4long   events = 0;
+      G4long   photons = 0;
+      G4long   ie = 0;
+      G4long   rss = 0;           ///< Resident memory (bytes)
+      G4long   peak_rss = 0;      ///< Peak resident memory (bytes)
+      G4long   allocator = 0;     ///< Size of the G4Allocator pools (bytes)
+    };
+
+    Snapshot Take() const;
+
+    void Report(G4bool final);
+    void PrintReport(const Snapshot&, G4bool final) const;
+    void WriteJSON(const Snapshot&, G4bool final) const;
+    void WritePrometheus(const Snapshot&, G4bool final) const;
+
+    /// Wall time per event below which the given fraction of events lie,
+    /// estimated from the histogram
+    G4double EventTimeQuantile(G4double fraction) const;
+
+    static G4double WallTime();
+
+  private:
+    G4GenericMessenger* msg_;
+    G4double interval_;      ///< Time between reports (0 disables them)
+    G4String status_file_;   ///< Status file, if any
+    G4String status_format_; ///< jsonl or prometheus
+
+    G4int num_events_; ///< Events to be processed in the run
+
+    G4double created_;   ///< Wall time at construction
+    G4double init_time_; ///< Time from construction to the start of the first run
+
+    G4double run_start_;    ///< Wall time at the start of the run
+    G4double event_start_;  ///< Wall time at the start of the event
+    G4double last_report_;  ///< Wall time of the last report
+    Snapshot last_;         ///< Counters at the last report
+
+    G4long events_;
+    G4long photons_, ie_;         ///< Tracks in the run
+    G4long evt_photons_, evt_ie_; ///< Tracks in the current event
+    G4long peak_allocator_;
+
+    /// Wall time per event in logarithmic bins of half a decade
+    std::vector<G4long> event_time_hist_;
+    G4double sum_event_time_;
+    G4double max_event_time_;
+    G4int slowest_event_;
+
+    static RunTelemetry* instance_;
+  };
+
+  inline RunTelemetry* RunTelemetry::Instance()
+  { return instance_; }
+
+} // end namespace nexus
+
+#endif
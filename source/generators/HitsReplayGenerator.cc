@@ -0,0 +1,258 @@
+// ----------------------------------------------------------------------------
+// nexus | HitsReplayGenerator.cc
+//
+// This generator replays the ionization hits stored in a previous nexus
+// output file, producing the ionization electrons of each deposit as the
+// clustering process does. It allows simulating the detector response
+// again without simulating the transport of the original particles.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "HitsReplayGenerator.h"
+
+#include "ReplayedEventInformation.h"
+#include "IonizationElectron.h"
+#include "BaseDriftField.h"
+#include "GeometryBase.h"
+#include "FactoryBase.h"
+
+#include <G4GenericMessenger.hh>
+#include <G4RunManager.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4Event.hh>
+#include <G4Navigator.hh>
+#include <G4LogicalVolume.hh>
+#include <G4Region.hh>
+#include <G4Poisson.hh>
+#include <Randomize.hh>
+
+#include "CLHEP/Units/SystemOfUnits.h"
+
+using namespace nexus;
+using namespace CLHEP;
+
+REGISTER_CLASS(HitsReplayGenerator, G4VPrimaryGenerator)
+
+
+namespace {
+  // Columns of the hits table needed for the replay
+  struct replay_hit_t {
+    float x;
+    float y;
+    float z;
+    float time;
+    float energy;
+  };
+}
+
+
+HitsReplayGenerator::HitsReplayGenerator():
+  G4VPrimaryGenerator(), msg_(0),
+  input_file_(""), first_event_(0), ioni_energy_(22.4*eV), fano_factor_(.15),
+  reseed_(true), num_chunks_(1), chunk_(0), file_(-1), hits_(-1), hit_type_(-1), next_(0)
+{
+  msg_ = new G4GenericMessenger(this, "/Generator/HitsReplay/",
+    "Control commands of the hits replay primary generator.");
+
+  msg_->DeclareProperty("input_file", input_file_,
+                        "Nexus output file with the ionization hits to replay.");
+
+  G4GenericMessenger::Command& first_cmd =
+    msg_->DeclareProperty("first_event", first_event_,
+                          "Position in the input file of the first event to replay.");
+  first_cmd.SetParameterName("first_event", false);
+  first_cmd.SetRange("first_event>=0");
+
+  G4GenericMessenger::Command& ioni_cmd =
+    msg_->DeclarePropertyWithUnit("ioni_energy", "eV", ioni_energy_,
+                                  "Average energy needed to produce an ionization pair.");
+  ioni_cmd.SetParameterName("ioni_energy", false);
+  ioni_cmd.SetRange("ioni_energy>0.");
+
+  G4GenericMessenger::Command& fano_cmd =
+    msg_->DeclareProperty("fano_factor", fano_factor_,
+                          "Fano factor of the ionization charge.");
+  fano_cmd.SetParameterName("fano_factor", false);
+  fano_cmd.SetRange("fano_factor>=0.");
+
+  msg_->DeclareProperty("reseed", reseed_,
+                        "Reseed the random engine with the seed stored for each event, if any.");
+
+  G4GenericMessenger::Command& chunks_cmd =
+    msg_->DeclareProperty("num_chunks", num_chunks_,
+                          "Number of jobs among which the hits of each event are split.");
+  chunks_cmd.SetParameterName("num_chunks", false);
+  chunks_cmd.SetRange("num_chunks>0");
+
+  G4GenericMessenger::Command& chunk_cmd =
+    msg_->DeclareProperty("chunk", chunk_,
+                          "Chunk of the hits of each event replayed by this job (from 0 to num_chunks-1).");
+  chunk_cmd.SetParameterName("chunk", false);
+  chunk_cmd.SetRange("chunk>=0");
+}
+
+
+
+HitsReplayGenerator::~HitsReplayGenerator()
+{
+  CloseInputFile();
+  delete msg_;
+}
+
+
+
+void HitsReplayGenerator::OpenInputFile()
+{
+  if (chunk_ >= num_chunks_) {
+    G4Exception("[HitsReplayGenerator]", "OpenInputFile()", FatalException,
+                "The chunk must be smaller than the number of chunks.");
+  }
+
+  file_ = H5Fopen(input_file_.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (file_ < 0) {
+    G4Exception("[HitsReplayGenerator]", "OpenInputFile()", FatalException,
+                ("Could not open the input file " + input_file_).c_str());
+  }
+
+  if (H5Lexists(file_, "/MC/event_index", H5P_DEFAULT) <= 0) {
+    G4Exception("[HitsReplayGenerator]", "OpenInputFile()", FatalException,
+                ("The input file " + input_file_ +
+                 " has no event index. It must be produced with this version of nexus.").c_str());
+  }
+
+  // The index is small, so it is read at once
+  hid_t index = H5Dopen2(file_, "/MC/event_index", H5P_DEFAULT);
+  hid_t space = H5Dget_space(index);
+  hsize_t nevents = H5Sget_simple_extent_npoints(space);
+  hid_t index_type = createEventIndexType();
+
+  index_.resize(nevents);
+  if (nevents > 0)
+    H5Dread(index, index_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, index_.data());
+
+  H5Tclose(index_type);
+  H5Sclose(space);
+  H5Dclose(index);
+
+  // Only the columns needed are read from the hits table,
+  // whatever the format of the labels
+  hits_ = H5Dopen2(file_, "/MC/hits", H5P_DEFAULT);
+  hit_type_ = H5Tcreate(H5T_COMPOUND, sizeof(replay_hit_t));
+  H5Tinsert(hit_type_, "x",      HOFFSET(replay_hit_t, x),      H5T_NATIVE_FLOAT);
+  H5Tinsert(hit_type_, "y",      HOFFSET(replay_hit_t, y),      H5T_NATIVE_FLOAT);
+  H5Tinsert(hit_type_, "z",      HOFFSET(replay_hit_t, z),      H5T_NATIVE_FLOAT);
+  H5Tinsert(hit_type_, "time",   HOFFSET(replay_hit_t, time),   H5T_NATIVE_FLOAT);
+  H5Tinsert(hit_type_, "energy", HOFFSET(replay_hit_t, energy), H5T_NATIVE_FLOAT);
+
+  next_ = first_event_;
+
+  G4cout << "[HitsReplayGenerator] Replaying " << nevents
+         << " events of " << input_file_ << G4endl;
+}
+
+
+
+void HitsReplayGenerator::CloseInputFile()
+{
+  if (file_ < 0) return;
+  H5Tclose(hit_type_);
+  H5Dclose(hits_);
+  H5Fclose(file_);
+  file_ = -1;
+}
+
+
+
+void HitsReplayGenerator::GeneratePrimaryVertex(G4Event* event)
+{
+  if (file_ < 0) OpenInputFile();
+
+  if (next_ >= index_.size()) {
+    G4cout  << "[HitsReplayGenerator] End of the input file reached. "
+            << "Aborting the run..." << G4endl;
+    G4RunManager::GetRunManager()->AbortRun();
+    return;
+  }
+
+  const event_index_t& entry = index_[next_++];
+
+  // The detector response of each event is reproducible
+  // regardless of which events are replayed, and
+  // independent among the chunks of the event
+  if (reseed_ && entry.rng_seed > 0)
+    G4Random::setTheSeed(long(entry.rng_seed) * num_chunks_ + chunk_);
+
+  if (entry.hits_count == 0) {
+    event->SetUserInformation(new ReplayedEventInformation(0.));
+    return;
+  }
+
+  std::vector<replay_hit_t> hits(entry.hits_count);
+
+  hsize_t start = entry.hits_first;
+  hsize_t count = entry.hits_count;
+  hid_t file_space = H5Dget_space(hits_);
+  H5Sselect_hyperslab(file_space, H5S_SELECT_SET, &start, NULL, &count, NULL);
+  hid_t mem_space = H5Screate_simple(1, &count, NULL);
+  H5Dread(hits_, hit_type_, mem_space, file_space, H5P_DEFAULT, hits.data());
+  H5Sclose(mem_space);
+  H5Sclose(file_space);
+
+  // The event actions cannot add up the energy deposit from trajectories,
+  // so all the hits of the event are accounted for, in every chunk,
+  // and the chunks keep or discard the same events
+  G4double energy_deposit = 0.;
+  for (const replay_hit_t& hit: hits) energy_deposit += hit.energy;
+  event->SetUserInformation(new ReplayedEventInformation(energy_deposit));
+
+  // We set a value for the electron's momentum as required by Geant4
+  G4double kinetic_energy = 1. * eV;
+  G4double mass = IonizationElectron::Definition()->GetPDGMass();
+  G4double total_energy = kinetic_energy + mass;
+  G4double pz = std::sqrt(total_energy*total_energy - mass*mass);
+
+  // The hits are interleaved among the chunks,
+  // so that they have similar amounts of charge
+  for (size_t ihit=chunk_; ihit<hits.size(); ihit+=num_chunks_) {
+
+    const replay_hit_t& hit = hits[ihit];
+    G4ThreeVector position(hit.x, hit.y, hit.z);
+
+    // As in the clustering process, charges are produced
+    // only in the regions with a drift field
+    G4VPhysicalVolume* vol =
+      GeometryBase::GetNavigator()->LocateGlobalPointAndSetup(position, 0, false);
+    if (!vol) continue;
+    G4Region* region = vol->GetLogicalVolume()->GetRegion();
+    if (!dynamic_cast<BaseDriftField*>(region->GetUserInformation())) continue;
+
+    G4int num_charges = NumberOfCharges(hit.energy);
+    if (num_charges == 0) continue;
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(position, hit.time);
+    for (G4int i=0; i<num_charges; i++) {
+      G4PrimaryParticle* particle =
+        new G4PrimaryParticle(IonizationElectron::Definition(), 0., 0., pz);
+      vertex->SetPrimary(particle);
+    }
+    event->AddPrimaryVertex(vertex);
+  }
+}
+
+
+
+G4int HitsReplayGenerator::NumberOfCharges(G4double energy) const
+{
+  // Same fluctuations as in the IonizationClustering process
+  G4double mean = energy / ioni_energy_;
+
+  if (mean > 10.) {
+    G4double sigma = sqrt(mean*fano_factor_);
+    return std::max(G4int(G4RandGauss::shoot(mean, sigma) + 0.5), 0);
+  }
+  else {
+    return G4int(G4Poisson(mean));
+  }
+}
@@ -0,0 +1,71 @@
+// ----------------------------------------------------------------------------
+// nexus | HitsReplayGenerator.h
+//
+// This generator replays the ionization hits stored in a previous nexus
+// output file, producing the ionization electrons of each deposit as the
+// clustering process does. It allows simulating the detector response
+// again without simulating the transport of the original particles.
+// The hits of each event can be split among several jobs, whose sensor
+// responses are then summed with scripts/merge_chunks.py. Each event carries
+// the energy of all its replayed hits, which the DefaultEventAction uses
+// to decide whether to store it.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef HITS_REPLAY_GENERATOR_H
+#define HITS_REPLAY_GENERATOR_H
+
+#include "hdf5_functions.h"
+
+#include <G4VPrimaryGenerator.hh>
+
+#include <vector>
+
+class G4GenericMessenger;
+class G4Event;
+
+
+namespace nexus {
+
+  class HitsReplayGenerator: public G4VPrimaryGenerator
+  {
+  public:
+    /// Constructor
+    HitsReplayGenerator();
+    /// Destructor
+    ~HitsReplayGenerator();
+
+    /// This method is invoked at the beginning of the event. It adds
+    /// the ionization electrons of the next stored event.
+    void GeneratePrimaryVertex(G4Event*);
+
+  private:
+    void OpenInputFile();
+    void CloseInputFile();
+
+    /// Number of ionization electrons produced by an energy deposit
+    G4int NumberOfCharges(G4double energy) const;
+
+  private:
+    G4GenericMessenger* msg_;
+
+    G4String input_file_;  ///< Nexus output file with the hits to replay
+    G4int first_event_;    ///< Position in the file of the first event to replay
+    G4double ioni_energy_; ///< Average energy needed to produce an ionization pair
+    G4double fano_factor_; ///< Fano factor of the ionization charge
+    G4bool reseed_;        ///< Use the random seed stored for each event
+    G4int num_chunks_;     ///< Number of jobs among which the hits of an event are split
+    G4int chunk_;          ///< Chunk of the hits replayed by this job
+
+    hid_t file_;      ///< Input file
+    hid_t hits_;      ///< Hits table of the input file
+    hid_t hit_type_;  ///< Memory type of the hit columns needed for the replay
+
+    std::vector<event_index_t> index_; ///< Event index of the input file
+    size_t next_;  ///< Position in the index of the next event to replay
+  };
+
+} // end namespace nexus
+
+#endif
@@ -29,7 +29,7 @@ IonGenerator::IonGenerator():
   atomic_number_(0), mass_number_(0), energy_level_(0.),
   decay_at_time_zero_(true),
   region_(""),
-  msg_(nullptr), geom_(nullptr)
+  msg_(nullptr), geom_(nullptr), ion_(nullptr)
 {
   msg_ = new G4GenericMessenger(this, "/Generator/IonGenerator/",
                                 "Control commands of the ion gun "
@@ -94,13 +94,18 @@ G4ParticleDefinition* IonGenerator::IonDefinition()
 }
 
 
+G4ParticleDefinition* IonGenerator::GetIonDefinition()
+{
+  // The ion definition is only looked up once
+  if (!ion_) ion_ = IonDefinition();
+  return ion_;
+}
+
+
 void IonGenerator::GeneratePrimaryVertex(G4Event* event)
 {
-  // Pointer declared as static so that it gets allocated only once
-  // (i.e. the ion definition is only looked up in the first event).
-  static G4ParticleDefinition* pdef = IonDefinition();
   // Create the new primary particle (i.e. the ion)
-  G4PrimaryParticle* ion = new G4PrimaryParticle(pdef);
+  G4PrimaryParticle* ion = new G4PrimaryParticle(GetIonDefinition());
 
   // Generate an initial position for the ion using the geometry
   G4ThreeVector position = geom_->GenerateVertex(region_);
@@ -34,6 +34,11 @@ namespace nexus{
     // setting a primary vertex that contains the chosen ion
     void GeneratePrimaryVertex(G4Event*);
 
+    // Definition of the ion, looked up in the ion table the first
+    // time. The PrefetchGenerator calls it in the main thread before
+    // the run, since ions cannot be created in its helper thread.
+    G4ParticleDefinition* GetIonDefinition();
+
   private:
     G4ParticleDefinition* IonDefinition();
 
@@ -44,6 +49,7 @@ namespace nexus{
     G4String region_;
     G4GenericMessenger* msg_;
     const GeometryBase* geom_;
+    G4ParticleDefinition* ion_;
   };
 
 } // end namespace nexus
@@ -45,42 +45,49 @@ namespace nexus {
    energy_Xrays_.push_back(1.383*keV);
    probability_Xrays_.push_back(0.01*0.099);
    energy_Xrays_.push_back(1.435*keV);
-   probability_Xrays_.push_back(0.01*0.060 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.060);
    energy_Xrays_.push_back(1.580*keV);
-   probability_Xrays_.push_back(0.01*0.21 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.21);
    energy_Xrays_.push_back(1.581*keV);
-   probability_Xrays_.push_back(0.01*1.9 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*1.9);
    energy_Xrays_.push_back(1.632*keV);
-   probability_Xrays_.push_back(0.01*1.1 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*1.1);
    energy_Xrays_.push_back(1.647*keV);
-   probability_Xrays_.push_back(0.01*0.0094 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.0094);
    energy_Xrays_.push_back(1.699*keV);
-   probability_Xrays_.push_back(0.01*0.09  + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.09);
    energy_Xrays_.push_back(1.707*keV);
-   probability_Xrays_.push_back(0.01*0.14 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.14);
    energy_Xrays_.push_back(1.906*keV);
-   probability_Xrays_.push_back(0.01*0.008 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.008);
    energy_Xrays_.push_back(1.907*keV);
-   probability_Xrays_.push_back(0.01*0.025 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.025);
    energy_Xrays_.push_back(12.405*keV);
-   probability_Xrays_.push_back(0.01*3.90E-05 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*3.90E-05);
    energy_Xrays_.push_back(12.598*keV);
-   probability_Xrays_.push_back(0.01*5.05 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*5.05);
    energy_Xrays_.push_back(12.651*keV);
-   probability_Xrays_.push_back(0.01*9.8 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*9.8);
    energy_Xrays_.push_back(14.104*keV);
-   probability_Xrays_.push_back(0.01*0.70 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.70);
    energy_Xrays_.push_back(14.111*keV);
-   probability_Xrays_.push_back(0.01*1.36  + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*1.36);
    energy_Xrays_.push_back(14.231*keV);
-   probability_Xrays_.push_back(0.01*0.00429 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.00429);
    energy_Xrays_.push_back(14.311*keV);
-   probability_Xrays_.push_back(0.01*0.179 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.179);
    energy_Xrays_.push_back(14.326*keV);
-   probability_Xrays_.push_back(0.01*0.0064 + probability_Xrays_[probability_Xrays_.size() -1]);
+   probability_Xrays_.push_back(0.01*0.0064);
+
+   // The last entry of the sampler stands for no X-ray
+   G4double prob_Xray = 0.;
+   for (auto p : probability_Xrays_) prob_Xray += p;
+   std::vector<G4double> weights(probability_Xrays_);
+   weights.push_back(1. - prob_Xray);
+   xray_sampler_.SetWeights(weights);
 
    std::cerr << " Kr83Generator::Kr83Generator, probability to emit an X-ray "
-             << probability_Xrays_[probability_Xrays_.size() -1]*100. << " percent " << std::endl;
+             << prob_Xray*100. << " percent " << std::endl;
     /// For the moment, only random direction are allowed.
     // Since the transion are either E3, M4 (32 keV), E2, M1, (9 keV),
     // no strong asymmetry to start with..
@@ -126,17 +133,10 @@ namespace nexus {
    // Decide if we emit an X-ray..
    //
 
-    const double probXRay = G4UniformRand();
+    const size_t kSel = xray_sampler_.Sample();
     double eKin32 = energy_32_;
     double eXray = 0.;
-    if (probXRay < probability_Xrays_[probability_Xrays_.size() -1]) {
-      size_t kSel = probability_Xrays_.size() - 1;
-      for (size_t k=1; k!= probability_Xrays_.size(); k++) {
-        if ((probXRay >= probability_Xrays_[k-1]) && (probXRay < probability_Xrays_[k])) {
-          kSel = k-1;
-	  break;
-        }
-      }
+    if (kSel < energy_Xrays_.size()) {
       eKin32 = energy_32_ - energy_Xrays_[kSel];
       eXray = energy_Xrays_[kSel];
     }
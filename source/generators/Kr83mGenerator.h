@@ -10,6 +10,8 @@
 #ifndef Kr83m_GENERATOR_H
 #define Kr83m_GENERATOR_H
 
+#include "RandomUtils.h"
+
 #include <vector>
 #include <G4VPrimaryGenerator.hh>
 
@@ -68,7 +70,7 @@ namespace nexus {
     G4double lifetime_9_; // ...The lifetime of the intermediate state.
     std::vector<double> energy_Xrays_; // Energies of various X-ray, as the Kr83 atom relaxes to
     std::vector<double> probability_Xrays_; // Probability to emit an X-ray of the above energy, per decay.
-                                            // We make cumulative, for easy access for random number.
+    AliasSampler xray_sampler_; // Sampler of the X-ray emitted, if any, for the random number.
 
     G4String region_;
     G4ParticleDefinition*  particle_defgamma_;
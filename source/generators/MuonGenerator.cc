@@ -34,7 +34,7 @@ MuonGenerator::MuonGenerator():
   G4VPrimaryGenerator(), msg_(0), particle_definition_(0),
   use_lsc_dist_(true), axis_rotation_(150), rPhi_(NULL), user_dir_{},
   energy_min_(0.), energy_max_(0.), dist_name_("za"), bInitialize_(false),
-  geom_(0), geom_solid_(0), gen_rad_(223.33*cm)
+  geom_(0), geom_solid_(0), zenith_bins_(15708), gen_rad_(223.33*cm)
 {
   msg_ = new G4GenericMessenger(this, "/Generator/MuonGenerator/",
 				"Control commands of muongenerator.");
@@ -126,31 +126,25 @@ void MuonGenerator::LoadMuonDistribution()
 
   }
 
-  // Convert flux vector to arr
-  auto arr_flux = flux_.data();
-
-  // Initialise the Random Number Generator based on the flux distribution
-  // (in bin index)
-  fRandomGeneral_ = new G4RandGeneral( arr_flux, flux_.size() );
+  // Initialise the sampler of the bin index based on the flux distribution
+  flux_sampler_.SetWeights(flux_);
 
 }
 
 void MuonGenerator::InitMuonZenithDist()
 {
 
-  // Create a vector of values finely spaced from 0 -> pi/2
-  // Then take cos(x)*cos(x) to make a dist to sample from
-  std::vector<G4double> v_angles;
+  // Split 0 -> pi/2 in fine bins and take cos(x)*cos(x)
+  // at their centres to make a dist to sample from
+  std::vector<G4double> v_angles(zenith_bins_);
 
-  for (G4double i = 0; i <= pi/2; i+=0.0001){
-      v_angles.push_back(std::cos(i)*std::cos(i));
+  for (G4int i = 0; i < zenith_bins_; i++){
+    G4double x = (i + 0.5) * pi/2 / zenith_bins_;
+    v_angles[i] = std::cos(x)*std::cos(x);
   }
 
-  // Convert vector to arr
-  auto arr_ang = v_angles.data();
-
-  // Initialise the Random Number Generator based on cos(x)*cos(x) distribution
-  fRandomGeneral_ = new G4RandGeneral( arr_ang, v_angles.size() );
+  // Initialise the sampler of the bin index based on cos(x)*cos(x) distribution
+  zenith_sampler_.SetWeights(v_angles);
 
 }
 
@@ -318,8 +312,7 @@ void MuonGenerator::GetDirection(G4ThreeVector& dir, G4double& zenith,
   while(invalid_evt){
 
     // Generate random index weighted by the bin contents
-    // Scale by flux vec size, then round to nearest integer to get an index
-    G4int RN_indx = GetRandBinIndex(fRandomGeneral_, flux_);
+    G4int RN_indx = flux_sampler_.Sample();
 
     // Correct sampled values by Gaussian smearing
     azimuth = Sample(azimuths_[RN_indx], true, azimuth_smear_[RN_indx]);
@@ -385,7 +378,8 @@ G4ThreeVector MuonGenerator::ProjectToVertex(const G4ThreeVector& dir)
 
 G4double MuonGenerator::GetZenith() const
 {
-  return fRandomGeneral_->fire()*pi/2;
+  // Uniform within the bin sampled
+  return (zenith_sampler_.Sample() + G4UniformRand()) * pi/2 / zenith_bins_;
 }
 
 
@@ -9,6 +9,8 @@
 #ifndef MUON_GENERATOR_H
 #define MUON_GENERATOR_H
 
+#include "RandomUtils.h"
+
 #include <G4VPrimaryGenerator.hh>
 #include <G4RotationMatrix.hh>
 #include <Randomize.hh>
@@ -95,7 +97,9 @@ namespace nexus {
     std::vector<G4double> azimuth_smear_; ///< List of Azimuth bin smear values
     std::vector<G4double> zenith_smear_;  ///< List of Zenith bin smear values
     std::vector<G4double> energy_smear_;  ///< List of Energy bin smear values
-    G4RandGeneral *fRandomGeneral_; ///< Pointer to the RNG flux distribution
+    AliasSampler flux_sampler_;   ///< Sampler of the bins of the flux distribution
+    AliasSampler zenith_sampler_; ///< Sampler of the bins of the cos^2 zenith distribution
+    G4int zenith_bins_; ///< Number of bins of the cos^2 zenith distribution
 
     G4double gen_rad_; ///< Radius of disc for generation
 
@@ -0,0 +1,328 @@
+// ----------------------------------------------------------------------------
+// nexus | PrefetchGenerator.cc
+//
+// Wrapper that runs any primary generator on a helper thread, producing
+// the primaries of the next events of the run while the current one is
+// being tracked. The helper draws its random numbers from an engine of its
+// own, seeded from the main engine at the beginning of each run, so that
+// the results are reproducible and do not depend on the prefetch depth.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "PrefetchGenerator.h"
+
+#include "IonGenerator.h"
+#include "HitsReplayGenerator.h"
+
+#include <G4Event.hh>
+#include <G4PrimaryVertex.hh>
+#include <G4PrimaryParticle.hh>
+#include <G4RunManager.hh>
+#include <G4Run.hh>
+#include <G4TransportationManager.hh>
+#include <G4Navigator.hh>
+#include <G4WorkerThread.hh>
+#include <G4ParticleTable.hh>
+#include <G4IonTable.hh>
+#include <G4Threading.hh>
+#include <Randomize.hh>
+#include <CLHEP/Random/MixMaxRng.h>
+
+
+using namespace nexus;
+
+
+namespace {
+
+  // Copy of a primary particle, without the particles that follow it
+  G4PrimaryParticle* CopyParticle(G4PrimaryParticle* particle)
+  {
+    G4PrimaryParticle* copy = particle->GetG4code() ?
+      new G4PrimaryParticle(particle->GetG4code()) :
+      new G4PrimaryParticle(particle->GetPDGcode());
+
+    copy->SetMass(particle->GetMass());
+    copy->SetCharge(particle->GetCharge());
+    copy->SetKineticEnergy(particle->GetKineticEnergy());
+    copy->SetMomentumDirection(particle->GetMomentumDirection());
+    copy->SetPolarization(particle->GetPolarization());
+    copy->SetWeight(particle->GetWeight());
+    copy->SetProperTime(particle->GetProperTime());
+    copy->SetTrackID(particle->GetTrackID());
+
+    // Pre-assigned decay products are few, the copy constructor will do
+    if (particle->GetDaughter())
+      copy->SetDaughter(new G4PrimaryParticle(*particle->GetDaughter()));
+
+    copy->SetUserInformation(particle->GetUserInformation());
+
+    return copy;
+  }
+
+  // Unset in the particles copied the user information shared with the
+  // originals, so that only the latter delete it
+  void ReleaseInformation(G4PrimaryParticle* copy, G4PrimaryParticle* original)
+  {
+    for (; copy && original; copy = copy->GetNext(), original = original->GetNext()) {
+      if (copy->GetUserInformation() == original->GetUserInformation())
+        copy->SetUserInformation(nullptr);
+      ReleaseInformation(copy->GetDaughter(), original->GetDaughter());
+    }
+  }
+
+}
+
+
+
+PrefetchGenerator::PrefetchGenerator(std::unique_ptr<G4VPrimaryGenerator> generator,
+                                     G4int depth):
+  G4VPrimaryGenerator(), generator_(std::move(generator)), depth_(depth),
+  engine_(new CLHEP::MixMaxRng()), world_(nullptr),
+  current_(nullptr), served_(0),
+  run_id_(-1), next_id_(0), last_id_(0), batch_(0),
+  new_run_(false), busy_(false), quit_(false)
+{
+  // The replayed events are read in sequence, and the
+  // run is aborted from the generator at the end of the file
+  if (depth_ > 0 && dynamic_cast<HitsReplayGenerator*>(generator_.get())) {
+    G4Exception("[PrefetchGenerator]", "PrefetchGenerator()", FatalException,
+                "The HitsReplayGenerator cannot generate events in advance: "
+                "remove the command /nexus/prefetch_events.");
+  }
+
+#ifndef G4MULTITHREADED
+  // Without thread-local random engines and geometry
+  // the generator cannot run in another thread
+  G4Exception("[PrefetchGenerator]", "PrefetchGenerator()", JustWarning,
+              "Geant4 was built without multithreading support: "
+              "the primaries will be generated in the main thread.");
+  depth_ = 0;
+#endif
+}
+
+
+
+PrefetchGenerator::~PrefetchGenerator()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    quit_ = true;
+  }
+  cond_.notify_all();
+
+  if (helper_.joinable()) helper_.join();
+}
+
+
+
+void PrefetchGenerator::GeneratePrimaryVertex(G4Event* event)
+{
+  if (depth_ <= 0) {
+    generator_->GeneratePrimaryVertex(event);
+    return;
+  }
+
+  const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+  if (run->GetRunID() != run_id_) {
+    BeginOfRun(event->GetEventID(), run->GetNumberOfEventToBeProcessed());
+    run_id_ = run->GetRunID();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this]{ return !ready_.empty(); });
+  G4Event* produced = ready_.front();
+  ready_.pop_front();
+  lock.unlock();
+
+  CopyPrimaries(produced, event);
+  current_ = produced;
+  ++served_;
+}
+
+
+
+void PrefetchGenerator::EndOfEvent(G4Event* event)
+{
+  if (!current_) return;
+
+  if (event->GetUserInformation() == current_->GetUserInformation())
+    event->SetUserInformation(nullptr);
+
+  G4PrimaryVertex* original = current_->GetPrimaryVertex();
+  for (G4PrimaryVertex* copy = event->GetPrimaryVertex(); copy && original;
+       copy = copy->GetNext(), original = original->GetNext()) {
+    if (copy->GetUserInformation() == original->GetUserInformation())
+      copy->SetUserInformation(nullptr);
+    ReleaseInformation(copy->GetPrimary(), original->GetPrimary());
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.push_back(current_);
+  current_ = nullptr;
+  lock.unlock();
+  cond_.notify_all();
+}
+
+
+
+void PrefetchGenerator::BeginOfRun(G4int first_event_id, G4int num_events)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  ++batch_;
+  done_.insert(done_.end(), ready_.begin(), ready_.end());
+  ready_.clear();
+  cond_.wait(lock, [this]{ return !busy_; });
+
+  // The engine of the helper thread is seeded from the main one,
+  // so that the events depend only on the seed of the job
+  engine_->setSeed(long(100000000L * G4UniformRand()) + 1, 0);
+
+  // Ions must be created in this thread, which tracks them
+  if (auto ion_generator = dynamic_cast<IonGenerator*>(generator_.get()))
+    ion_generator->GetIonDefinition();
+
+  served_ = 0;
+
+  world_ = G4TransportationManager::GetTransportationManager()
+    ->GetNavigatorForTracking()->GetWorldVolume();
+
+  next_id_ = first_event_id;
+  last_id_ = first_event_id + num_events;
+  new_run_ = true;
+
+  if (!helper_.joinable())
+    helper_ = std::thread(&PrefetchGenerator::Produce, this);
+
+  lock.unlock();
+  cond_.notify_all();
+}
+
+
+
+void PrefetchGenerator::EndOfRun()
+{
+  if (depth_ <= 0) return;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  ++batch_;
+  last_id_ = next_id_;
+  done_.insert(done_.end(), ready_.begin(), ready_.end());
+  ready_.clear();
+  run_id_ = -1;
+
+  cond_.wait(lock, [this]{ return !busy_; });
+
+  lock.unlock();
+  cond_.notify_all();
+
+  G4cout << "[PrefetchGenerator] " << served_
+         << " events generated in advance by the helper thread" << G4endl;
+  served_ = 0;
+}
+
+
+
+void PrefetchGenerator::Produce()
+{
+  // Set up this thread as a Geant4 worker, with its own
+  // copy of the geometry and particle tables and its own engine
+  G4Threading::G4SetThreadId(0);
+  G4WorkerThread::BuildGeometryAndPhysicsVector();
+  G4ParticleTable::GetParticleTable()->WorkerG4ParticleTable();
+  G4Random::setTheEngine(engine_.get());
+
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    cond_.wait(lock, [this]{
+      return quit_ || new_run_ || !done_.empty() ||
+        (next_id_ < last_id_ && G4int(ready_.size()) < depth_); });
+
+    // The events consumed are deleted in this thread,
+    // so that their memory returns to its allocators
+    if (!done_.empty()) {
+      std::deque<G4Event*> done;
+      done.swap(done_);
+      lock.unlock();
+      for (G4Event* event : done) delete event;
+      lock.lock();
+      continue;
+    }
+
+    if (quit_) break;
+
+    if (new_run_) {
+      new_run_ = false;
+      busy_ = true;
+      G4VPhysicalVolume* world = world_;
+      lock.unlock();
+
+      // The geometry may have been modified between runs
+      G4WorkerThread::UpdateGeometryAndPhysicsVectorFromMaster();
+      G4TransportationManager::GetTransportationManager()->SetWorldForTracking(world);
+
+      lock.lock();
+      busy_ = false;
+      cond_.notify_all();
+      continue;
+    }
+
+    G4int event_id = next_id_++;
+    G4int batch = batch_;
+    busy_ = true;
+    lock.unlock();
+
+    G4Event* event = new G4Event(event_id);
+    G4int ions = G4IonTable::GetIonTable()->Entries();
+    generator_->GeneratePrimaryVertex(event);
+
+    // The helper thread has its own list of the ions created before it
+    // started: a new one means that an ion was created in this thread
+    if (G4IonTable::GetIonTable()->Entries() != ions) {
+      G4Exception("[PrefetchGenerator]", "Produce()", FatalException,
+                  "The generator created an ion in the helper thread. Ions must "
+                  "be created in the main thread, before the run.");
+    }
+
+    lock.lock();
+    busy_ = false;
+    // Events of a run that has already finished are discarded
+    if (batch == batch_) ready_.push_back(event);
+    else done_.push_back(event);
+    cond_.notify_all();
+  }
+
+  for (G4Event* event : ready_) delete event;
+  ready_.clear();
+  lock.unlock();
+
+  G4ParticleTable::GetParticleTable()->DestroyWorkerG4ParticleTable();
+  G4WorkerThread::DestroyGeometryAndPhysicsVector();
+}
+
+
+
+void PrefetchGenerator::CopyPrimaries(G4Event* from, G4Event* to)
+{
+  for (G4PrimaryVertex* vertex = from->GetPrimaryVertex(); vertex;
+       vertex = vertex->GetNext()) {
+
+    G4PrimaryVertex* copy =
+      new G4PrimaryVertex(vertex->GetPosition(), vertex->GetT0());
+    copy->SetWeight(vertex->GetWeight());
+    copy->SetUserInformation(vertex->GetUserInformation());
+    vertex->SetUserInformation(nullptr);
+
+    for (G4PrimaryParticle* particle = vertex->GetPrimary(); particle;
+         particle = particle->GetNext())
+      copy->SetPrimary(CopyParticle(particle));
+
+    to->AddPrimaryVertex(copy);
+  }
+
+  to->SetUserInformation(from->GetUserInformation());
+  from->SetUserInformation(nullptr);
+}
@@ -0,0 +1,109 @@
+// ----------------------------------------------------------------------------
+// nexus | PrefetchGenerator.h
+//
+// Wrapper that runs any primary generator on a helper thread, producing
+// the primaries of the next events of the run while the current one is
+// being tracked. The helper draws its random numbers from an engine of its
+// own, seeded from the main engine at the beginning of each run, so that
+// the results are reproducible and do not depend on the prefetch depth.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef PREFETCH_GENERATOR_H
+#define PREFETCH_GENERATOR_H
+
+#include <G4VPrimaryGenerator.hh>
+
+#include <memory>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class G4Event;
+class G4VPhysicalVolume;
+
+namespace CLHEP { class HepRandomEngine; }
+
+
+namespace nexus {
+
+  /// The wrapped generator runs in the helper thread as a Geant4 worker,
+  /// with its own copy of the geometry and particle tables, so it must not
+  /// rely on state shared with tracking. In particular, it must draw its
+  /// random numbers through G4UniformRand() or the static shoot() methods,
+  /// locate points with GeometryBase::GetNavigator(), neither reseed the
+  /// engine nor abort the run (HitsReplayGenerator is refused), and not
+  /// create ions, whose processes would only be set up for the helper
+  /// thread (the ion of IonGenerator is looked up before the run).
+  /// The user information of the primaries stays with the helper thread,
+  /// which deletes it once the event it was produced for is over.
+
+  class PrefetchGenerator: public G4VPrimaryGenerator
+  {
+  public:
+    /// Constructor, given the generator to wrap and the
+    /// number of events whose primaries are produced in advance
+    PrefetchGenerator(std::unique_ptr<G4VPrimaryGenerator> generator,
+                      G4int depth);
+    /// Destructor. Stops the helper thread.
+    ~PrefetchGenerator();
+
+    /// Add to the event the primaries produced for it by the helper thread
+    void GeneratePrimaryVertex(G4Event*);
+
+    /// Detach from the event processed the user information of its
+    /// primaries and hand it back to the helper thread for deletion
+    void EndOfEvent(G4Event*);
+
+    /// Discard the primaries left from the current run and wait until
+    /// the helper thread is idle, so that the generator can be modified
+    void EndOfRun();
+
+    /// Returns the generator wrapped
+    const G4VPrimaryGenerator* GetGenerator() const;
+
+  private:
+    void BeginOfRun(G4int first_event_id, G4int num_events);
+
+    /// Loop of the helper thread
+    void Produce();
+
+    /// Copy the primary vertices from the event produced by the helper
+    /// thread to the one being processed, so that the memory of each
+    /// thread returns to its own allocators. The user information is
+    /// shared, and remains owned by the event produced.
+    static void CopyPrimaries(G4Event* from, G4Event* to);
+
+  private:
+    std::unique_ptr<G4VPrimaryGenerator> generator_;
+    G4int depth_; ///< Number of events produced in advance
+
+    std::unique_ptr<CLHEP::HepRandomEngine> engine_; ///< Engine of the helper thread
+    G4VPhysicalVolume* world_; ///< World volume for the navigation of the helper thread
+
+    std::thread helper_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+
+    std::deque<G4Event*> ready_; ///< Events produced and not consumed yet
+    std::deque<G4Event*> done_;  ///< Events to be deleted by the helper thread
+    G4Event* current_; ///< Event produced for the one being processed
+    G4int served_;     ///< Events of the run given primaries produced in advance
+
+    G4int run_id_;  ///< ID of the run being produced
+    G4int next_id_; ///< ID of the next event to produce
+    G4int last_id_; ///< ID past the last event of the run
+    G4int batch_;   ///< Incremented at every beginning and end of run
+    G4bool new_run_; ///< The helper thread must update its geometry
+    G4bool busy_;   ///< The helper thread is running the generator
+    G4bool quit_;
+  };
+
+  inline const G4VPrimaryGenerator* PrefetchGenerator::GetGenerator() const
+  { return generator_.get(); }
+
+} // end namespace nexus
+
+#endif
@@ -0,0 +1,30 @@
+// ----------------------------------------------------------------------------
+// nexus | ReplayedEventInformation.cc
+//
+// This class is a utility to add the energy deposited by a replayed event
+// to the events of the HitsReplayGenerator class, since its ionization
+// electrons leave no trajectories to compute it from.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "ReplayedEventInformation.h"
+
+#include <G4SystemOfUnits.hh>
+
+using namespace nexus;
+
+ReplayedEventInformation::ReplayedEventInformation(G4double energy_deposit):
+  energy_deposit_(energy_deposit)
+{
+}
+
+ReplayedEventInformation::~ReplayedEventInformation()
+{
+}
+
+void ReplayedEventInformation::Print() const
+{
+  G4cout << "Replayed event with an energy deposit of "
+         << energy_deposit_/keV << " keV" << G4endl;
+}
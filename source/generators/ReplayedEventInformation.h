@@ -0,0 +1,40 @@
+// ----------------------------------------------------------------------------
+// nexus | ReplayedEventInformation.h
+//
+// This class is a utility to add the energy deposited by a replayed event
+// to the events of the HitsReplayGenerator class, since its ionization
+// electrons leave no trajectories to compute it from.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef REPLAYED_EVENT_INFORMATION_H
+#define REPLAYED_EVENT_INFORMATION_H
+
+#include <G4VUserEventInformation.hh>
+#include "globals.hh"
+
+namespace nexus {
+
+  class ReplayedEventInformation: public G4VUserEventInformation
+  {
+  public:
+    //constructor
+    ReplayedEventInformation(G4double energy_deposit);
+    //destructor
+    ~ReplayedEventInformation();
+
+    void Print() const;
+    G4double GetEnergyDeposit() const;
+
+  private:
+
+    G4double energy_deposit_; ///< Energy of all the hits of the replayed event
+  };
+
+  inline G4double ReplayedEventInformation::GetEnergyDeposit() const
+  { return energy_deposit_; }
+
+} // end namespace nexus
+
+#endif
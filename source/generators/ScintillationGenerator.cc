@@ -43,9 +43,6 @@ ScintillationGenerator::ScintillationGenerator() :
 
   msg_->DeclareProperty("nphotons", nphotons_, "Number of photons");
 
-  geom_navigator_ =
-    G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
   DetectorConstruction* detconst =
     (DetectorConstruction*) G4RunManager::GetRunManager()->GetUserDetectorConstruction();
   geom_ = detconst->GetGeometry();
@@ -66,7 +63,7 @@ void ScintillationGenerator::GeneratePrimaryVertex(G4Event* event)
   // Energy is sampled from integral (like it is done in G4Scintillation)
 
   G4VPhysicalVolume* vol =
-    geom_navigator_->LocateGlobalPointAndSetup(position, 0, false);
+    GeometryBase::GetNavigator()->LocateGlobalPointAndSetup(position, 0, false);
   G4Material* mat = vol->GetLogicalVolume()->GetMaterial();
   G4MaterialPropertiesTable* mpt = mat->GetMaterialPropertiesTable();
 
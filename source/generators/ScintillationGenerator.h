@@ -12,7 +12,6 @@
 #define SCINTILLATION_GENERATOR_H
 
 #include <G4VPrimaryGenerator.hh>
-#include <G4Navigator.hh>
 #include <G4TransportationManager.hh>
 #include <G4PhysicsOrderedFreeVector.hh>
 
@@ -42,7 +41,6 @@ namespace nexus {
                                        G4PhysicsOrderedFreeVector&);
 
     G4GenericMessenger* msg_;
-    G4Navigator* geom_navigator_; ///< Geometry Navigator
     const GeometryBase* geom_; ///< Pointer to the detector geometry
 
     G4String region_;
@@ -11,6 +11,7 @@
 #include "MaterialsList.h"
 #include "OpticalMaterialProperties.h"
 #include "Visibilities.h"
+#include "WLSFiberTransport.h"
 
 #include <G4Tubs.hh>
 #include <G4Box.hh>
@@ -22,6 +23,7 @@
 #include <G4OpticalSurface.hh>
 #include <G4LogicalSkinSurface.hh>
 #include <G4NistManager.hh>
+#include <G4Region.hh>
 
 
 using namespace nexus;
@@ -51,7 +53,8 @@ GenericWLSFiber::GenericWLSFiber(G4String    name,
   coating_mat_    (coating_mat),
   coating_optProp_(nullptr),
   core_optProp_   (nullptr),
-  visibility_     (visibility)
+  visibility_     (visibility),
+  fast_transport_ (false)
 {
 }
 
@@ -193,6 +196,8 @@ void GenericWLSFiber::BuildRoundFiber()
   new G4PVPlacement(nullptr, G4ThreeVector(0., 0., 0.), core_logic,
                     name_, iclad_logic, false, 0, false);
 
+  if (fast_transport_) BuildFastTransport(core_logic);
+
   if (aluminized_end_) {
     G4double fiber_end_z = 0.1 * mm;
     G4Tubs *fiber_end_solid_vol =
@@ -300,6 +305,8 @@ void GenericWLSFiber::BuildSquareFiber()
   new G4PVPlacement(nullptr, G4ThreeVector(0., 0., 0.), core_logic,
                     name_, iclad_logic, false, 0, false);
 
+  if (fast_transport_) BuildFastTransport(core_logic);
+
   // VISIBILITIES
   if (visibility_) {
     if (doubleclad_)
@@ -319,3 +326,13 @@ void GenericWLSFiber::BuildSquareFiber()
       coating_logic->SetVisAttributes(G4VisAttributes::GetInvisible());
   }
 }
+
+
+
+void GenericWLSFiber::BuildFastTransport(G4LogicalVolume* core_logic)
+{
+  // Photons trapped in the core are moved straight to the fiber ends
+  G4Region* core_region = new G4Region(name_);
+  core_region->AddRootLogicalVolume(core_logic);
+  new WLSFiberTransport(core_region);
+}
@@ -15,6 +15,7 @@
 class G4Material;
 class G4GenericMessenger;
 class G4MaterialPropertiesTable;
+class G4LogicalVolume;
 
 namespace nexus {
 
@@ -53,6 +54,7 @@ namespace nexus {
 
     // Setters
     void SetVisibility(G4bool visibility);
+    void SetFastTransport(G4bool fast_transport);
 
   private:
 
@@ -60,6 +62,7 @@ namespace nexus {
     void ComputeDimensions();
     void BuildRoundFiber();
     void BuildSquareFiber();
+    void BuildFastTransport(G4LogicalVolume* core_logic);
 
     G4String    name_;
     G4bool      verbosity_;
@@ -80,6 +83,7 @@ namespace nexus {
     G4MaterialPropertiesTable* core_optProp_;
 
     G4bool      visibility_;
+    G4bool      fast_transport_; // Parametrized photon transport along the core
   };
 
 
@@ -91,6 +95,8 @@ namespace nexus {
 
   inline void GenericWLSFiber::SetVisibility(G4bool visibility)
   { visibility_ = visibility; }
+  inline void GenericWLSFiber::SetFastTransport(G4bool fast_transport)
+  { fast_transport_ = fast_transport; }
   inline void GenericWLSFiber::SetCoatingOpticalProperties(G4MaterialPropertiesTable* ctmp)
   { coating_optProp_ = ctmp; }
   inline void GenericWLSFiber::SetCoreOpticalProperties(G4MaterialPropertiesTable* crmp)
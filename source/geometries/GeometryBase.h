@@ -10,8 +10,12 @@
 #define GEOMETRY_BASE_H
 
 #include <G4ThreeVector.hh>
+#include <G4TransportationManager.hh>
+#include <G4Navigator.hh>
 #include <CLHEP/Units/SystemOfUnits.h>
 
+#include <vector>
+
 class G4LogicalVolume;
 
 namespace nexus {
@@ -28,6 +32,16 @@ namespace nexus {
     /// construction phase
     virtual void Construct() = 0;
 
+    /// Propagates the parameters changed since the construction
+    /// to the volumes, materials and fields already built, if this
+    /// can be done without building the geometry again. Returns
+    /// false otherwise, which is what geometries do by default.
+    virtual G4bool UpdateParameters();
+
+    /// Commands whose parameter UpdateParameters() propagates,
+    /// that is, those that can be scanned (none by default)
+    virtual std::vector<G4String> ScannableParameters() const;
+
     /// Returns the logical volume representing the geometry
     G4LogicalVolume* GetLogicalVolume() const;
 
@@ -61,6 +75,12 @@ namespace nexus {
     /// Translates position to G4 global position
     void CalculateGlobalPos(G4ThreeVector& vertex) const;
 
+    /// Returns the navigator used to locate the vertices generated,
+    /// which is the tracking navigator of the calling thread. It must
+    /// be looked up on every use, since the primaries may be generated
+    /// in a thread other than the tracking one (see PrefetchGenerator).
+    static G4Navigator* GetNavigator();
+
     /// Destructor
     virtual ~GeometryBase();
 
@@ -99,6 +119,11 @@ namespace nexus {
 
   inline GeometryBase::~GeometryBase() {}
 
+  inline G4bool GeometryBase::UpdateParameters() { return false; }
+
+  inline std::vector<G4String> GeometryBase::ScannableParameters() const
+  { return {}; }
+
   inline G4LogicalVolume* GeometryBase::GetLogicalVolume() const
   { return logicVol_; }
 
@@ -129,6 +154,9 @@ namespace nexus {
 
   inline void GeometryBase::SetCoordOrigin(G4ThreeVector origin) {coord_origin_ = origin;}
 
+  inline G4Navigator* GeometryBase::GetNavigator()
+  { return G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking(); }
+
   // This methods is to be used only in the Next1EL and NEW geometries
   inline void GeometryBase::CalculateGlobalPos(G4ThreeVector& vertex) const
   {
@@ -205,6 +205,23 @@ namespace nexus {
   }
 
 
+  G4bool Next100::UpdateParameters()
+  {
+    // The vessel goes first: the field cage reads the gas properties
+    if (!vessel_->UpdateParameters()) return false;
+    return inner_elements_->UpdateParameters();
+  }
+
+
+  std::vector<G4String> Next100::ScannableParameters() const
+  {
+    std::vector<G4String> parameters = vessel_->ScannableParameters();
+    std::vector<G4String> inner = inner_elements_->ScannableParameters();
+    parameters.insert(parameters.end(), inner.begin(), inner.end());
+    return parameters;
+  }
+
+
   G4ThreeVector Next100::GenerateVertex(const G4String& region) const
   {
     G4ThreeVector vertex(0.,0.,0.);
@@ -42,6 +42,11 @@ namespace nexus {
 				  const G4ThreeVector& point,
 				  const G4ThreeVector& dir) const;
 
+    /// Updates the gas, field cage and EL parameters of the
+    /// geometry already built (see GeometryBase::UpdateParameters)
+    G4bool UpdateParameters();
+    std::vector<G4String> ScannableParameters() const;
+
 
   private:
     void BuildLab();
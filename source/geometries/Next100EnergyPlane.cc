@@ -24,7 +24,6 @@
 #include <G4LogicalSkinSurface.hh>
 #include <G4NistManager.hh>
 #include <G4VPhysicalVolume.hh>
-#include <G4TransportationManager.hh>
 #include <Randomize.hh>
 
 namespace nexus {
@@ -80,10 +79,6 @@ namespace nexus {
     ///    in the gas volume, inside the holes excavated in the copper.
 
 
-    /// Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ =
-      G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
     /// Messenger
     msg_ = new G4GenericMessenger(this, "/Geometry/Next100/",
 				  "Control commands of geometry Next100.");
@@ -448,7 +443,7 @@ namespace nexus {
         vertex = copper_gen_->GenerateVertex(VOLUME);
         G4ThreeVector glob_vtx(vertex);
         glob_vtx = glob_vtx - GetCoordOrigin();
-        VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != region);
     }
 
@@ -464,7 +459,7 @@ namespace nexus {
         vertex.setZ(vertex.z() + z_translation);
         G4ThreeVector glob_vtx(vertex);
         glob_vtx = glob_vtx - GetCoordOrigin();
-        VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != region);
     }
 
@@ -10,7 +10,6 @@
 #define NEXT100_ENERGY_PLANE_H
 
 #include <vector>
-#include <G4Navigator.hh>
 #include <G4RotationMatrix.hh>
 
 #include "PmtR11410.h"
@@ -79,9 +78,6 @@ namespace nexus {
     // Visibility of the energy plane
     G4bool visibility_, verbosity_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
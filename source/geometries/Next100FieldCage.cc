@@ -39,7 +39,7 @@
 #include <G4UserLimits.hh>
 #include <G4SDManager.hh>
 #include <G4UnitsTable.hh>
-#include <G4TransportationManager.hh>
+#include <G4RunManager.hh>
 
 #include <cassert>
 
@@ -115,17 +115,16 @@ Next100FieldCage::Next100FieldCage(G4double grid_thickn):
   // EL gap generation disk parameters
   el_gap_slice_min_(0.), el_gap_slice_max_(1.),
   sipm_pitch_(0),
-  photoe_prob_(0)
+  photoe_prob_(0),
+  drift_field_(nullptr),
+  el_field_(nullptr),
+  el_grid_mat_(nullptr)
 {
   /// Define new categories
   new G4UnitDefinition("kilovolt/cm","kV/cm","Electric field", kilovolt/cm);
   new G4UnitDefinition("mm/sqrt(cm)","mm/sqrt(cm)","Diffusion", mm/sqrt(cm));
   new G4UnitDefinition("mm/microsecond","mm/microsecond","drift velocity", mm/microsecond);
 
-  /// Initializing the geometry navigator (used in vertex generation)
-  geom_navigator_ =
-    G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
   /// Messenger
   msg_ = new G4GenericMessenger(this, "/Geometry/Next100/",
                                 "Control commands of geometry Next100.");
@@ -262,6 +261,9 @@ void Next100FieldCage::Construct()
   BuildELRegion();
   BuildLightTube();
   BuildFieldCage();
+
+  built_elfield_         = elfield_;
+  built_dielectric_grid_ = use_dielectric_grid_;
 }
 
 
@@ -353,6 +355,7 @@ void Next100FieldCage::BuildActive()
   field->SetLifetime(e_lifetime_);
   G4Region* drift_region = new G4Region("DRIFT");
   drift_region->SetUserInformation(field);
+  drift_field_ = field;
   drift_region->AddRootLogicalVolume(active_logic);
 
   /// Vertex generator
@@ -653,6 +656,7 @@ void Next100FieldCage::BuildELRegion()
       new G4Tubs("EL_GRID", 0., gate_int_diam_/2., grid_thickn_/2., 0, twopi);
 
     el_grid_logic = new G4LogicalVolume(diel_grid_solid, fgrid_mat, "EL_GRID");
+    el_grid_mat_ = fgrid_mat;
 
   }
   // EL Grids -- use SS hexagonal mesh
@@ -753,6 +757,7 @@ void Next100FieldCage::BuildELRegion()
     el_field->SetLightYield(XenonELLightYield(ELelectric_field_, pressure_));
     G4Region* el_region = new G4Region("EL_REGION");
     el_region->SetUserInformation(el_field);
+    el_field_ = el_field;
     el_region->AddRootLogicalVolume(el_gap_logic);
   }
 
@@ -1076,6 +1081,51 @@ void Next100FieldCage::BuildFieldCage()
 }
 
 
+G4bool Next100FieldCage::UpdateParameters()
+{
+  if (!drift_field_ || elfield_ != built_elfield_ ||
+      use_dielectric_grid_ != built_dielectric_grid_)
+    return false;
+
+  // The gas properties may have been updated by the vessel
+  sc_yield_    = gas_->GetMaterialPropertiesTable()->GetConstProperty("SCINTILLATIONYIELD");
+  e_lifetime_  = gas_->GetMaterialPropertiesTable()->GetConstProperty("ATTACHMENT");
+
+  drift_field_->SetDriftVelocity(drift_v_);
+  drift_field_->SetTransverseDiffusion(drift_transv_diff_);
+  drift_field_->SetLongitudinalDiffusion(drift_long_diff_);
+  drift_field_->SetLifetime(e_lifetime_);
+
+  if (el_field_) {
+    el_field_->SetDriftVelocity(EL_drift_v_);
+    el_field_->SetTransverseDiffusion(ELtransv_diff_);
+    el_field_->SetLongitudinalDiffusion(ELlong_diff_);
+    el_field_->SetLightYield(XenonELLightYield(ELelectric_field_, pressure_));
+  }
+
+  if (el_grid_mat_) {
+    G4MaterialPropertiesTable* mpt =
+      opticalprops::FakeGrid(pressure_, temperature_, el_grid_transparency_,
+                             grid_thickn_, sc_yield_, 1000.*ms, photoe_prob_);
+    if (mpt != el_grid_mat_->GetMaterialPropertiesTable()) {
+      el_grid_mat_->SetMaterialPropertiesTable(mpt);
+      G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    }
+  }
+
+  return true;
+}
+
+
+std::vector<G4String> Next100FieldCage::ScannableParameters() const
+{
+  return {"/Geometry/Next100/drift_v", "/Geometry/Next100/drift_transv_diff",
+          "/Geometry/Next100/drift_long_diff", "/Geometry/Next100/EL_drift_v",
+          "/Geometry/Next100/ELtransv_diff", "/Geometry/Next100/ELlong_diff",
+          "/Geometry/Next100/EL_field", "/Geometry/Next100/photoe_prob"};
+}
+
+
 Next100FieldCage::~Next100FieldCage()
 {
   delete active_gen_;
@@ -1110,7 +1160,7 @@ G4ThreeVector Next100FieldCage::GenerateVertex(const G4String& region) const
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx - GetCoordOrigin();
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (VertexVolume->GetName() != region);
   }
 
@@ -1129,7 +1179,7 @@ G4ThreeVector Next100FieldCage::GenerateVertex(const G4String& region) const
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx - GetCoordOrigin();
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (VertexVolume->GetName() != region);
   }
 
@@ -1140,7 +1190,7 @@ G4ThreeVector Next100FieldCage::GenerateVertex(const G4String& region) const
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx - GetCoordOrigin();
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (
     VertexVolume->GetName() != "ACTIVE" &&
     VertexVolume->GetName() != "BUFFER" &&
@@ -1154,7 +1204,7 @@ G4ThreeVector Next100FieldCage::GenerateVertex(const G4String& region) const
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx - GetCoordOrigin();
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (
     VertexVolume->GetName() != "LIGHT_TUBE_DRIFT" &&
     VertexVolume->GetName() != "LIGHT_TUBE_BUFFER" );
@@ -1179,7 +1229,7 @@ G4ThreeVector Next100FieldCage::GenerateVertex(const G4String& region) const
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx - GetCoordOrigin();
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (VertexVolume->GetName() != region);
   }
 
@@ -1198,7 +1248,7 @@ G4ThreeVector Next100FieldCage::GenerateVertex(const G4String& region) const
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx - GetCoordOrigin();
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (VertexVolume->GetName() != "STAVE");
  }
 
@@ -16,12 +16,12 @@ class G4Material;
 class G4LogicalVolume;
 class G4VPhysicalVolume;
 class G4GenericMessenger;
-class G4Navigator;
 
 namespace nexus {
 
   class CylinderPointSampler;
   class BoxPointSampler;
+  class UniformElectricDriftField;
 
 
   class Next100FieldCage: public GeometryBase
@@ -32,6 +32,11 @@ namespace nexus {
     void Construct() override;
     G4ThreeVector GenerateVertex(const G4String& region) const override;
 
+    /// Updates the gas properties, the drift and EL fields and the
+    /// EL grids. Switching the EL field or the grid kind needs a new geometry.
+    G4bool UpdateParameters() override;
+    std::vector<G4String> ScannableParameters() const override;
+
     G4ThreeVector GetActivePosition() const;
 
     void SetMotherLogicalVolume(G4LogicalVolume* mother_logic);
@@ -120,9 +125,6 @@ namespace nexus {
     // SiPM pitch for ELgap vertex generation
     G4double sipm_pitch_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
@@ -144,6 +146,12 @@ namespace nexus {
     G4Material* teflon_;
     G4Material* copper_;
     G4Material* steel_;
+
+    // Built by Construct(), kept for UpdateParameters()
+    UniformElectricDriftField* drift_field_;
+    UniformElectricDriftField* el_field_;
+    G4Material* el_grid_mat_;
+    G4bool built_elfield_, built_dielectric_grid_;
   };
 
 
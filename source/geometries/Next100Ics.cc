@@ -21,7 +21,6 @@
 #include <G4NistManager.hh>
 #include <G4Material.hh>
 #include <Randomize.hh>
-#include <G4TransportationManager.hh>
 
 
 namespace nexus {
@@ -35,10 +34,6 @@ namespace nexus {
     ics_ep_lip_width_ (ics_ep_lip_width),
     visibility_ (0)
   {
-
-    // Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
     /// Messenger
     msg_ = new G4GenericMessenger(this, "/Geometry/Next100/", "Control commands of geometry Next100.");
     msg_->DeclareProperty("ics_vis", visibility_, "ICS Visibility");
@@ -216,7 +211,7 @@ namespace nexus {
 
         G4ThreeVector glob_vtx(vertex);
         glob_vtx = glob_vtx - GetCoordOrigin();
-        VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "ICS");
     }
 
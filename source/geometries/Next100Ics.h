@@ -11,7 +11,6 @@
 
 #include "GeometryBase.h"
 
-#include <G4Navigator.hh>
 
 class G4GenericMessenger;
 
@@ -58,9 +57,6 @@ namespace nexus {
     // Vertex generator
     CylinderPointSampler* ics_gen_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
@@ -87,6 +87,18 @@ namespace nexus {
   }
 
 
+  G4bool Next100InnerElements::UpdateParameters()
+  {
+    return field_cage_->UpdateParameters();
+  }
+
+
+  std::vector<G4String> Next100InnerElements::ScannableParameters() const
+  {
+    return field_cage_->ScannableParameters();
+  }
+
+
   Next100InnerElements::~Next100InnerElements()
   {
     delete field_cage_;
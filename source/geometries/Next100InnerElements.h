@@ -58,6 +58,10 @@ namespace nexus {
     /// Builder
     void Construct();
 
+    /// Updates the parameters of the field cage
+    G4bool UpdateParameters();
+    std::vector<G4String> ScannableParameters() const;
+
 
   private:
 
@@ -22,6 +22,7 @@
 #include <G4VisAttributes.hh>
 #include <G4NistManager.hh>
 #include <G4UnitsTable.hh>
+#include <G4RunManager.hh>
 
 using namespace CLHEP;
 
@@ -42,7 +43,8 @@ namespace nexus {
     fc_displ_x_ (-3.7 * mm), // displacement of the field cage volumes from 0
     fc_displ_y_ (-6.4 * mm), // displacement of the field cage volumes from 0
     specific_vertex_{},
-    gas_("naturalXe")
+    gas_("naturalXe"),
+    gas_mat_(nullptr)
   {
     /// Messenger
     msg_ = new G4GenericMessenger(this, "/Geometry/Next100/",
@@ -126,6 +128,10 @@ namespace nexus {
                 "Unknown kind of gas, valid options are: naturalXe, enrichedXe, depletedXe.");
   }
 
+  gas_mat_        = gas_mat;
+  built_pressure_ = pressure_;
+  built_gas_      = gas_;
+
   G4double gas_size = lab_size - 10.*cm;
   G4Box* gas_solid = new G4Box("GAS", gas_size/2., gas_size/2., gas_size/2.);
   G4LogicalVolume* gas_logic = new G4LogicalVolume(gas_solid, gas_mat, "GAS");
@@ -155,6 +161,35 @@ namespace nexus {
   }
 
 
+  G4bool Next100OpticalGeometry::UpdateParameters()
+  {
+    // The gas materials are shared by name, so a different
+    // pressure or composition needs a new geometry
+    if (!gas_mat_ || pressure_ != built_pressure_ || gas_ != built_gas_)
+      return false;
+
+    G4MaterialPropertiesTable* mpt =
+      opticalprops::GXe(pressure_, temperature_, sc_yield_, e_lifetime_);
+
+    if (mpt != gas_mat_->GetMaterialPropertiesTable()) {
+      gas_mat_->SetMaterialPropertiesTable(mpt);
+      G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    }
+
+    return inner_elements_->UpdateParameters();
+  }
+
+
+  std::vector<G4String> Next100OpticalGeometry::ScannableParameters() const
+  {
+    std::vector<G4String> parameters =
+      {"/Geometry/Next100/sc_yield", "/Geometry/Next100/e_lifetime"};
+    std::vector<G4String> inner = inner_elements_->ScannableParameters();
+    parameters.insert(parameters.end(), inner.begin(), inner.end());
+    return parameters;
+  }
+
+
   G4ThreeVector Next100OpticalGeometry::GenerateVertex(const G4String& region) const
   {
     G4ThreeVector vertex(0.,0.,0.);
@@ -14,6 +14,7 @@
 #include "GeometryBase.h"
 
 class G4GenericMessenger;
+class G4Material;
 
 
 namespace nexus {
@@ -36,6 +37,11 @@ namespace nexus {
     /// Builder
     void Construct();
 
+    /// Updates the optical properties of the gas and the field
+    /// cage. The pressure and the kind of gas cannot be changed.
+    G4bool UpdateParameters();
+    std::vector<G4String> ScannableParameters() const;
+
 
   private:
 
@@ -56,6 +62,11 @@ namespace nexus {
 
     G4String gas_;
 
+    // Gas built by Construct(), kept for UpdateParameters()
+    G4Material* gas_mat_;
+    G4double built_pressure_;
+    G4String built_gas_;
+
     Next100InnerElements* inner_elements_;
 
   };
@@ -22,7 +22,6 @@
 #include <G4NistManager.hh>
 #include <G4Material.hh>
 #include <Randomize.hh>
-#include <G4TransportationManager.hh>
 #include <G4RotationMatrix.hh>
 #include <G4UserLimits.hh>
 
@@ -83,9 +82,6 @@ namespace nexus {
     msg_->DeclareProperty("shielding_vis", visibility_, "Shielding Visibility");
     msg_->DeclareProperty("shielding_verbosity", verbosity_, "Verbosity");
 
-    // Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
   }
 
 
@@ -650,7 +646,7 @@ namespace nexus {
           vertex = lead_gen_->GenerateVertex(VOLUME);
           G4ThreeVector glob_vtx(vertex);
           glob_vtx = glob_vtx - GetCoordOrigin();
-          VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+          VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
         } while (VertexVolume->GetName() != "LEAD_BOX");
     }
 
@@ -660,7 +656,7 @@ namespace nexus {
         vertex = steel_gen_->GenerateVertex(VOLUME);
         G4ThreeVector glob_vtx(vertex);
         glob_vtx = glob_vtx - GetCoordOrigin();
-        VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "STEEL_BOX");
     }
 
@@ -670,7 +666,7 @@ namespace nexus {
         vertex = inner_air_gen_->GenerateVertex(INSIDE);
         G4ThreeVector glob_vtx(vertex);
         glob_vtx = glob_vtx - GetCoordOrigin();
-        VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "INNER_AIR");
     }
 
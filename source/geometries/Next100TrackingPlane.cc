@@ -23,7 +23,6 @@
 #include <Randomize.hh>
 #include <G4VisAttributes.hh>
 #include <G4Navigator.hh>
-#include <G4TransportationManager.hh>
 
 using namespace nexus;
 
@@ -45,9 +44,6 @@ Next100TrackingPlane::Next100TrackingPlane():
 
   msg_->DeclareProperty("tracking_plane_vis", visibility_,
                         "Visibility of the tracking plane volumes.");
-
-  geom_navigator_ =
-                  G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
 }
 
 
@@ -227,7 +223,7 @@ G4ThreeVector Next100TrackingPlane::GenerateVertex(const G4String& region) const
         G4ThreeVector glob_vtx(vertex);
         glob_vtx = glob_vtx - GetCoordOrigin();
         VertexVolume =
-          geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+          GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
 
       } while ((VertexVolume->GetName() == "SIPM_BOARD_MASK_HOLE")  ||
               (VertexVolume->GetName() == "SIPM_BOARD_MASK_WLS_HOLE"));
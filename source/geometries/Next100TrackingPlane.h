@@ -15,7 +15,6 @@
 
 class G4VPhysicalVolume;
 class G4GenericMessenger;
-class G4Navigator;
 
 namespace nexus {
 
@@ -66,8 +65,6 @@ namespace nexus {
     G4VPhysicalVolume* mpv_; // Pointer to mother's physical volume
 
     G4GenericMessenger* msg_;
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
   };
 
   inline void Next100TrackingPlane::SetMotherPhysicalVolume(G4VPhysicalVolume* p)
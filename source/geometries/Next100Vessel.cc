@@ -25,9 +25,9 @@
 #include <G4NistManager.hh>
 #include <G4Material.hh>
 #include <Randomize.hh>
-#include <G4TransportationManager.hh>
 #include <G4UnitsTable.hh>
 #include <G4SubtractionSolid.hh>
+#include <G4RunManager.hh>
 
 #include <CLHEP/Units/SystemOfUnits.h>
 
@@ -75,6 +75,7 @@ namespace nexus {
     gas_("enrichedXe"),
     helium_mass_num_(4),
     xe_perc_(100.),
+    gas_mat_(nullptr),
     th_source_("no_source"),
     dist_th_zpos_end_(0.*mm)
   {
@@ -92,10 +93,6 @@ namespace nexus {
     /// This way, the inner part of the EP flange emerges as the part of
     // the inner volume of the vessel which is not occupied by xenon.
 
-    // Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ =
-      G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
     /// Messenger
     msg_ =
       new G4GenericMessenger(this, "/Geometry/Next100/", "Control commands of Next100 geometry.");
@@ -353,6 +350,12 @@ namespace nexus {
                                                                  sc_yield_,
                                                                  e_lifetime_));
 
+    gas_mat_               = vessel_gas_mat;
+    built_pressure_        = pressure_;
+    built_gas_             = gas_;
+    built_helium_mass_num_ = helium_mass_num_;
+    built_xe_perc_         = xe_perc_;
+
     G4LogicalVolume* vessel_gas_logic =
       new G4LogicalVolume(vessel_gas_final_solid, vessel_gas_mat, "VESSEL_GAS");
 
@@ -495,6 +498,32 @@ namespace nexus {
   }
 
 
+  G4bool Next100Vessel::UpdateParameters()
+  {
+    // The gas materials are shared by name, so a different
+    // pressure or composition needs a new geometry
+    if (!gas_mat_ || pressure_ != built_pressure_ || gas_ != built_gas_ ||
+        helium_mass_num_ != built_helium_mass_num_ || xe_perc_ != built_xe_perc_)
+      return false;
+
+    G4MaterialPropertiesTable* mpt =
+      opticalprops::GXe(pressure_, temperature_, sc_yield_, e_lifetime_);
+
+    if (mpt != gas_mat_->GetMaterialPropertiesTable()) {
+      gas_mat_->SetMaterialPropertiesTable(mpt);
+      G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    }
+
+    return true;
+  }
+
+
+  std::vector<G4String> Next100Vessel::ScannableParameters() const
+  {
+    return {"/Geometry/Next100/sc_yield", "/Geometry/Next100/e_lifetime"};
+  }
+
+
   G4LogicalVolume* Next100Vessel::GetInternalLogicalVolume()
   {
     return internal_logic_vol_;
@@ -533,7 +562,7 @@ namespace nexus {
           G4ThreeVector glob_vtx(vertex);
           // this->GetCoordOrigin() only has x and y set
           glob_vtx = glob_vtx - GetCoordOrigin() - G4ThreeVector(0, 0, gate_z_pos_);
-          VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+          VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
         } while (VertexVolume->GetName() != "VESSEL");
       }
       else if (rand < (perc_endcap_vol_ + perc_ep_flange_vol_ + perc_tp_flange_vol_)){// Tracking flange
@@ -547,7 +576,7 @@ namespace nexus {
           G4ThreeVector glob_vtx(vertex);
           // this->GetCoordOrigin() only has x and y set
           glob_vtx = glob_vtx - GetCoordOrigin() - G4ThreeVector(0, 0, gate_z_pos_);
-          VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+          VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
         } while (VertexVolume->GetName() != "VESSEL");
       }
     }
@@ -11,7 +11,6 @@
 
 #include "GeometryBase.h"
 
-#include <G4Navigator.hh>
 
 
 class G4GenericMessenger;
@@ -49,6 +48,11 @@ namespace nexus {
     /// Builder
     void Construct();
 
+    /// Updates the optical properties of the gas. The pressure
+    /// and the kind of gas cannot be changed after construction.
+    G4bool UpdateParameters();
+    std::vector<G4String> ScannableParameters() const;
+
   private:
     // Dimensions
     const G4double vessel_in_rad_, vessel_thickness_;
@@ -70,6 +74,13 @@ namespace nexus {
     G4int helium_mass_num_;
     G4double xe_perc_;
 
+    // Gas built by Construct(), kept for UpdateParameters()
+    G4Material* gas_mat_;
+    G4double built_pressure_;
+    G4String built_gas_;
+    G4int built_helium_mass_num_;
+    G4double built_xe_perc_;
+
     // Th calibration source
     G4String th_source_;
     G4double dist_th_zpos_end_;
@@ -94,9 +105,6 @@ namespace nexus {
     G4double perc_ep_flange_vol_;
     G4double perc_tp_flange_vol_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
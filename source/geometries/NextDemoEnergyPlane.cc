@@ -23,7 +23,6 @@
 #include <G4LogicalSkinSurface.hh>
 #include <G4NistManager.hh>
 #include <G4VPhysicalVolume.hh>
-#include <G4TransportationManager.hh>
 #include <Randomize.hh>
 #include <G4RotationMatrix.hh>
 
@@ -47,10 +46,6 @@ namespace nexus {
     visibility_ (1),
     verbosity_ (0)
   {
-    /// Initializing the geometry navigator (used in vertex generation) ///
-    geom_navigator_ =
-      G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
     /// Messenger ///
     msg_ = new G4GenericMessenger(this, "/Geometry/NextDemo/",
                                   "Control commands of the NextDemo geometry.");
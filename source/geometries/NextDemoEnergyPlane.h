@@ -10,7 +10,6 @@
 #define NEXT_DEMO_ENERGY_PLANE_H
 
 #include <vector>
-#include <G4Navigator.hh>
 
 #include "PmtR11410.h"
 
@@ -69,9 +68,6 @@ namespace nexus {
     // Visibility and verbosity
     G4bool visibility_, verbosity_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
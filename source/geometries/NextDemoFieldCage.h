@@ -12,7 +12,6 @@
 
 #include <vector>
 #include <G4LogicalVolume.hh>
-#include <G4Navigator.hh>
 #include <G4TransportationManager.hh>
 
 #include "GeometryBase.h"
@@ -58,8 +57,6 @@ namespace nexus {
 
   private:
 
-    G4Navigator* geom_navigator_;
-
     // Configuration
     G4String config_;
 
@@ -18,7 +18,6 @@
 #include "Visibilities.h"
 
 #include <G4GenericMessenger.hh>
-#include <G4TransportationManager.hh>
 #include <G4RotationMatrix.hh>
 #include <G4Box.hh>
 #include <G4SubtractionSolid.hh>
@@ -55,10 +54,6 @@ NextDemoTrackingPlane::NextDemoTrackingPlane():
 
   msg_->DeclareProperty("tracking_plane_vis", visibility_,
                         "Tracking Plane visibility");
-
-  // Initializing the geometry navigator
-  geom_navigator_ =
-    G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
 }
 
 
@@ -295,7 +290,7 @@ G4ThreeVector NextDemoTrackingPlane::GenerateVertex(const G4String& region) cons
       G4ThreeVector glob_vtx(vertex);
       glob_vtx = glob_vtx + G4ThreeVector(0, 0, -GetELzCoord());
       VertexVolume =
-        geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+        GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
     } while (VertexVolume->GetName() != region);
   }
 
@@ -15,7 +15,6 @@
 
 class G4VPhysicalVolume;
 class G4GenericMessenger;
-class G4Navigator;
 
 namespace nexus {
 
@@ -63,8 +62,6 @@ namespace nexus {
 
     G4GenericMessenger* msg_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
   };
 
   inline void NextDemoTrackingPlane::SetConfig(G4String config)
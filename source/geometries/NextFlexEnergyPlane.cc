@@ -21,7 +21,6 @@
 #include <G4GenericMessenger.hh>
 #include <G4Tubs.hh>
 #include <G4SubtractionSolid.hh>
-#include <G4TransportationManager.hh>
 #include <G4RotationMatrix.hh>
 
 #include <G4LogicalVolume.hh>
@@ -70,10 +69,6 @@ NextFlexEnergyPlane::NextFlexEnergyPlane():
 
   window_thickness_      = 6.0 * mm;
   optical_pad_thickness_ = 1.0 * mm;
-
-  // Initializing the geometry navigator (used in vertex generation)
-  geom_navigator_ =
-    G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
 }
 
 
@@ -547,7 +542,7 @@ G4ThreeVector NextFlexEnergyPlane::GenerateVertex(const G4String& region) const
     G4VPhysicalVolume *VertexVolume;
     do {
       vertex       = copper_gen_->GenerateVertex(VOLUME);
-      VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(vertex, 0, false);
+      VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(vertex, 0, false);
     } while (VertexVolume->GetName() != region);
   }
 
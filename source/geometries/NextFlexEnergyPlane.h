@@ -19,7 +19,6 @@ class G4Material;
 class G4GenericMessenger;
 class G4Tubs;
 class G4SubtractionSolid;
-class G4Navigator;
 
 
 namespace nexus {
@@ -97,9 +96,6 @@ namespace nexus {
     // The messenger
     G4GenericMessenger* msg_; // Messenger for configuration parameters
 
-   // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Energy Plane Configuration
     G4bool ep_with_PMTs_;    // PMTs arranged ala NEXT100
     G4bool ep_with_teflon_;  // Teflon mask to reflect light
@@ -13,6 +13,7 @@
 #include "XenonProperties.h"
 #include "IonizationSD.h"
 #include "UniformElectricDriftField.h"
+#include "WLSFiberTransport.h"
 #include "CylinderPointSampler.h"
 #include "GenericPhotosensor.h"
 #include "SensorSD.h"
@@ -46,6 +47,7 @@ NextFlexFieldCage::NextFlexFieldCage():
   fiber_sensor_visibility_ (false),
   msg_                     (nullptr),
   fc_with_fibers_          (true),
+  fiber_fast_transport_    (false),
   active_diam_             (984. * mm),          // Same as NEXT100 (something btwn 1000 & 984 mm)
   active_length_           (116. * cm),          // Distance GATE - CATHODE (meshes not included)
   drift_transv_diff_       (1. * mm/sqrt(cm)),   // Drift field transversal diffusion
@@ -130,6 +132,9 @@ void NextFlexFieldCage::DefineConfigurationParameters()
   // FIELD_CAGE configuration
   msg_->DeclareProperty("fc_with_fibers", fc_with_fibers_, "FIELD_CAGE with fibers");
 
+  msg_->DeclareProperty("fiber_fast_transport", fiber_fast_transport_,
+                        "Parametrize the transport of the photons trapped in the fibers");
+
   // ACTIVE dimensions
   G4GenericMessenger::Command& active_length_cmd =
     msg_->DeclareProperty("active_length", active_length_,
@@ -844,6 +849,13 @@ void NextFlexFieldCage::BuildFibers()
   // Updating info
   if (fiber_claddings_ == 0) out_logic_volume = core_logic;
 
+  // Photons trapped in the core are moved straight to the fiber ends
+  if (fiber_fast_transport_) {
+    G4Region* core_region = new G4Region(core_name);
+    core_region->AddRootLogicalVolume(core_logic);
+    new WLSFiberTransport(core_region);
+  }
+
   // Vertex generator
   fiber_gen_ =
     new CylinderPointSampler(inner_rad, outer_rad, fiber_length/2., 0., twopi,
@@ -102,6 +102,7 @@ namespace nexus {
 
     // Energy Plane Configuration
     G4bool fc_with_fibers_;
+    G4bool fiber_fast_transport_; // Parametrized photon transport along the fibers
 
     // ACTIVE
     G4double active_diam_,       active_length_;
@@ -19,7 +19,6 @@ class G4Material;
 class G4GenericMessenger;
 class G4Tubs;
 class G4SubtractionSolid;
-class G4Navigator;
 
 
 namespace nexus {
@@ -97,9 +96,6 @@ namespace nexus {
     // The messenger
     G4GenericMessenger* msg_; // Messenger for configuration parameters
 
-   // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Materials & Components
     G4Material* xenon_gas_;
     G4Material* copper_mat_;
@@ -24,7 +24,6 @@
 #include <G4LogicalSkinSurface.hh>
 #include <G4NistManager.hh>
 #include <G4VPhysicalVolume.hh>
-#include <G4TransportationManager.hh>
 #include <Randomize.hh>
 
 #include <CLHEP/Units/SystemOfUnits.h>
@@ -54,8 +53,6 @@ namespace nexus {
     visibility_(1)
 
   {
-    /// Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
     /// Messenger
     msg_ = new G4GenericMessenger(this, "/Geometry/NextNew/", "Control commands of geometry NextNewEnergyPlane.");
     msg_->DeclareProperty("energy_plane_vis", visibility_, "Energy Plane Visibility");
@@ -217,7 +214,7 @@ namespace nexus {
 	G4ThreeVector glob_vtx(vertex);
 	CalculateGlobalPos(glob_vtx);
 	VertexVolume =
-	  geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	  GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "CARRIER_PLATE");
     }
     //NextNewPmtEnclosures
@@ -10,7 +10,6 @@
 #define NEXTNEW_ENERGY_PLANE_H
 
 #include <vector>
-#include <G4Navigator.hh>
 #include <G4TransportationManager.hh>
 
 #include "NextNewPmtEnclosure.h"
@@ -75,8 +74,6 @@ namespace nexus {
     // Vertex generators
     CylinderPointSamplerLegacy* carrier_gen_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
   };
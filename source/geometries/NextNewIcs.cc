@@ -20,7 +20,6 @@
 #include <G4NistManager.hh>
 #include <G4Material.hh>
 #include <Randomize.hh>
-#include <G4TransportationManager.hh>
 #include <G4RotationMatrix.hh>
 
 #include <CLHEP/Units/SystemOfUnits.h>
@@ -51,9 +50,6 @@ namespace nexus {
     center_nozzle_z_pos_ (25. *mm)   //  position of the nozzles (lateral and upper side) with respect to the center of the volume
 
   {
-    // Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
     /// Messenger
     msg_ = new G4GenericMessenger(this, "/Geometry/NextNew/", "Control commands of geometry Next100.");
     msg_->DeclareProperty("ics_vis", visibility_, "ICS Visibility");
@@ -192,7 +188,7 @@ namespace nexus {
           // First rotate, then shift
           glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
           glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-          VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+          VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
         } while (VertexVolume->GetName() != "ICS");
       }
       // Generating in the tread
@@ -203,7 +199,7 @@ namespace nexus {
           G4ThreeVector glob_vtx(vertex);
           glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
           glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-          VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+          VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
         } while (VertexVolume->GetName() != "ICS");
       }
     } else {
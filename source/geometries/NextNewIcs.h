@@ -11,7 +11,6 @@
 
 #include "GeometryBase.h"
 
-#include <G4Navigator.hh>
 
 class G4GenericMessenger;
 
@@ -61,9 +60,6 @@ namespace nexus {
     CylinderPointSamplerLegacy* tread_gen_;
     G4double body_perc_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
@@ -43,9 +43,6 @@ namespace nexus {
     msg_ = new G4GenericMessenger(this, "/Geometry/NextNew/",
                                   "Control commands of geometry NextNew.");
     msg_->DeclareProperty("minicastle_vis", visibility_, "NEW mini castle visibility");
-
-    /// Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
   }
 
   void NextNewMiniCastle::SetLogicalVolume(G4LogicalVolume* mother_logic)
@@ -216,7 +213,7 @@ namespace nexus {
 	// First rotate, then shift
 	glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
 	glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-	VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "MINI_CASTLE");
     }
     else if (region == "RN_MINI_CASTLE") {
@@ -229,7 +226,7 @@ namespace nexus {
 	  // First rotate, then shift
 	  glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
 	  glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-	  VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	  VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
 	} while (VertexVolume->GetName() != "MINI_CASTLE");
       }
     else if (region == "MINI_CASTLE_STEEL") {
@@ -242,7 +239,7 @@ namespace nexus {
 	// First rotate, then shift
 	glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
 	glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-	VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "MINI_CASTLE_STEEL");
     }
     else {
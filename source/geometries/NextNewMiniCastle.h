@@ -11,7 +11,6 @@
 
 #include "GeometryBase.h"
 
-#include <G4Navigator.hh>
 #include <G4TransportationManager.hh>
 
 class G4GenericMessenger;
@@ -56,9 +55,6 @@ namespace nexus {
     BoxPointSamplerLegacy* mini_castle_external_surf_gen_;
     BoxPointSamplerLegacy* steel_box_gen_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Position of the pedestal surface in y
     G4double pedestal_surf_y_;
 
@@ -10,7 +10,6 @@
 #define NEXTNEW_ENCLOSURE_H
 
 #include <G4ThreeVector.hh>
-#include <G4Navigator.hh>
 #include <G4TransportationManager.hh>
 #include "GeometryBase.h"
 
@@ -72,9 +71,6 @@ namespace nexus{
     G4double flange_perc_;
     G4double int_surf_perc_, int_cap_surf_perc_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
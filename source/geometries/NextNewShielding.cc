@@ -22,7 +22,6 @@
 #include <G4NistManager.hh>
 #include <G4Material.hh>
 #include <Randomize.hh>
-#include <G4TransportationManager.hh>
 #include <G4RotationMatrix.hh>
 #include <G4UserLimits.hh>
 
@@ -61,9 +60,6 @@ namespace nexus {
     msg_ = new G4GenericMessenger(this, "/Geometry/NextNew/", "Control commands of geometry NextNew.");
     msg_->DeclareProperty("shielding_vis", visibility_, "Shielding Visibility");
 
-    // Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
   }
 
 
@@ -330,7 +326,7 @@ namespace nexus {
 	// First rotate, then shift
 	glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
 	glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-	VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
       } while (VertexVolume->GetName() != "LEAD_BOX");
     }
 
@@ -11,7 +11,6 @@
 
 #include "GeometryBase.h"
 
-#include <G4Navigator.hh>
 
 class G4GenericMessenger;
 
@@ -75,9 +74,6 @@ namespace nexus {
     G4double perc_struc_x_vol_;
 
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
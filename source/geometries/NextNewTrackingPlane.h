@@ -10,7 +10,6 @@
 #define NEXTNEW_TRACKING_PLANE_H
 
 #include <G4LogicalVolume.hh>
-#include <G4Navigator.hh>
 #include <G4TransportationManager.hh>
 
 #include "NextNewKDB.h"
@@ -83,9 +82,6 @@ namespace nexus {
     G4double body_perc_;
     G4double flange_perc_;
 
-    // Geometry Navigator
-    G4Navigator* geom_navigator_;
-
     // Messenger for the definition of control commands
     G4GenericMessenger* msg_;
 
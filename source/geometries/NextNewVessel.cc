@@ -24,7 +24,6 @@
 #include <G4NistManager.hh>
 #include <G4Material.hh>
 #include <Randomize.hh>
-#include <G4TransportationManager.hh>
 #include <G4RotationMatrix.hh>
 #include <G4UnitsTable.hh>
 #include <G4Transform3D.hh>
@@ -121,9 +120,6 @@ namespace nexus {
     /// 3) Bear in mind that visualizing this geometry could take to a crash of OpenGL, because of its complexity. Don't worry, geant4 tracking is being done correctly.
     /// 4) The source that fits inside the tube with a screw is a piece of aluminum with a disk of 2 mm thickness, 6 mm diameter placed at 0.5 mm from the bottom of the piece
 
-    // Initializing the geometry navigator (used in vertex generation)
-    geom_navigator_ = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking();
-
     /// Messenger
     msg_ = new G4GenericMessenger(this, "/Geometry/NextNew/", "Control commands of geometry NextNew.");
     msg_->DeclareProperty("vessel_vis", visibility_, "Vessel Visibility");
@@ -860,7 +856,7 @@ void NextNewVessel::Construct()
 	  // First rotate, then shift
 	  glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
 	  glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-	  VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	  VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
 	  // std::cout<<vertex<<std::endl;
 	} while (VertexVolume->GetName() != "VESSEL");
       }
@@ -882,7 +878,7 @@ void NextNewVessel::Construct()
 	  // First rotate, then shift
 	  glob_vtx.rotate(pi, G4ThreeVector(0., 1., 0.));
 	  glob_vtx = glob_vtx + G4ThreeVector(0, 0, GetELzCoord());
-	  VertexVolume = geom_navigator_->LocateGlobalPointAndSetup(glob_vtx, 0, false);
+	  VertexVolume = GetNavigator()->LocateGlobalPointAndSetup(glob_vtx, 0, false);
 	  //std::cout<<vertex<<std::endl;
 	} while (VertexVolume->GetName() != "VESSEL");
       }
@@ -12,15 +12,36 @@
 
 #include <G4MaterialPropertiesTable.hh>
 
+#include <map>
+
 
 using namespace nexus;
 using namespace CLHEP;
 
+
+namespace {
+
+  /// Property tables already built, keyed by the name of the function
+  /// and its parameters, so that identical tables are shared instead
+  /// of being rebuilt for every material or surface using them
+  G4MaterialPropertiesTable*& Cached(const G4String& name,
+                                     const std::vector<G4double>& params = {})
+  {
+    static std::map<std::pair<G4String, std::vector<G4double>>,
+                    G4MaterialPropertiesTable*> cache;
+    return cache[{name, params}];
+  }
+
+}
+
+
 namespace opticalprops {
 
   G4MaterialPropertiesTable* Vacuum()
   {
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("Vacuum");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     std::vector<G4double> photEnergy = {optPhotMinE_, optPhotMaxE_};
 
@@ -42,7 +63,9 @@ namespace opticalprops {
     // Optical properties of Suprasil 311/312(c) synthetic fused silica.
     // Obtained from http://heraeus-quarzglas.com
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("FusedSilica");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     // The range is chosen to be up to ~10.7 eV because Sellmeier's equation
@@ -112,7 +135,9 @@ namespace opticalprops {
     // Optical properties of Suprasil 311/312(c) synthetic fused silica.
     // Obtained from http://heraeus-quarzglas.com
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("FakeFusedSilica", {transparency, thickness});
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     G4MaterialPropertiesTable* fused_sil_pt = opticalprops::FusedSilica();
     mpt->AddProperty("RINDEX", fused_sil_pt->GetProperty("RINDEX"));
@@ -131,7 +156,9 @@ namespace opticalprops {
   {
     // This is the material used as a window for NEXT-100 SiPMs.
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("Epoxy");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     // The only information we have is that n = 1.55 at a
@@ -251,7 +278,9 @@ namespace opticalprops {
     // https://refractiveindex.info/?shelf=other&book=In2O3-SnO2&page=Moerland
     // Only valid in [1000 - 400] nm
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("ITO");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     std::vector<G4double> energies = {
       optPhotMinE_,
@@ -304,7 +333,9 @@ namespace opticalprops {
     // https://refractiveindex.info/?shelf=other&book=PEDOT-PSS&page=Chen
     // Only valid in [1097 - 302] nm
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("PEDOT");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     std::vector<G4double> energies = {
       optPhotMinE_,
@@ -357,7 +388,9 @@ namespace opticalprops {
     // Obtained from http://refractiveindex.info and
     // https://www.zeonex.com/Optics.aspx.html#glass-like
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("GlassEpoxy");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     // The range is chosen to be up to ~10.7 eV because Sellmeier's equation
@@ -411,7 +444,9 @@ namespace opticalprops {
     // https://refractiveindex.info/?shelf=3d&book=crystals&page=sapphire
     // C[i] coeficients at line 362 are squared.
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("Sapphire");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     G4double um2 = micrometer*micrometer;
@@ -471,7 +506,9 @@ namespace opticalprops {
   G4MaterialPropertiesTable* OptCoupler()
   {
     // gel NyoGel OCK-451
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("OptCoupler");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     G4double um2 = micrometer*micrometer;
@@ -530,7 +567,9 @@ namespace opticalprops {
     // Updated scintillation decay and yields from:
     // Triplet Lifetime in Gaseous Argon. Michael Akashi-Ronquest et al.
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("GAr", {sc_yield, e_lifetime});
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     const G4int ri_entries = 200;
@@ -597,11 +636,13 @@ namespace opticalprops {
 
   /// Gaseous xenon ///
   G4MaterialPropertiesTable* GXe(G4double pressure,
-                                 G4double /*temperature*/,
+                                 G4double temperature,
                                 G4int    sc_yield,
                                 G4double e_lifetime)
   {
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("GXe", {pressure, temperature, G4double(sc_yield), e_lifetime});
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     const G4int ri_entries = 200;
@@ -663,7 +704,9 @@ namespace opticalprops {
   G4MaterialPropertiesTable* LXe()
   {
     /// The time constants are taken from E. Hogenbirk et al 2018 JINST 13 P10031
-    G4MaterialPropertiesTable* LXe_mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& LXe_mpt = Cached("LXe");
+    if (LXe_mpt) return LXe_mpt;
+    LXe_mpt = new G4MaterialPropertiesTable();
 
     const G4int ri_entries = 200;
     G4double eWidth = (optPhotMaxE_ - optPhotMinE_) / ri_entries;
@@ -732,7 +775,10 @@ namespace opticalprops {
                                       G4double e_lifetime,
                                       G4double photoe_p)
   {
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("FakeGrid", {pressure, temperature, transparency, thickness,
+                                                        G4double(sc_yield), e_lifetime, photoe_p});
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // PROPERTIES FROM XENON
     G4MaterialPropertiesTable* xenon_pt = opticalprops::GXe(pressure, temperature, sc_yield, e_lifetime);
@@ -769,7 +815,9 @@ namespace opticalprops {
   /// PTFE (== TEFLON) ///
   G4MaterialPropertiesTable* PTFE()
   {
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("PTFE");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFLECTIVITY
     std::vector<G4double> ENERGIES = {
@@ -809,7 +857,9 @@ namespace opticalprops {
 
   G4MaterialPropertiesTable* PolishedAl()
   {
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("PolishedAl");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     std::vector<G4double> ENERGIES = {
        hc_ / (2456.42541 * nm), hc_ / (2396.60266 * nm), hc_ / (2276.95716 * nm),
@@ -873,7 +923,9 @@ namespace opticalprops {
   G4MaterialPropertiesTable* TPB()
   {
     // Data from https://doi.org/10.1140/epjc/s10052-018-5807-z
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("TPB");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> rIndex_energies = {optPhotMinE_, optPhotMaxE_};
@@ -1001,7 +1053,9 @@ namespace opticalprops {
     // It has all the same properties of TPB except the WaveLengthShifting probability
     // that is set by parameter, trying to model a degraded behaviour of the TPB coating
 
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("DegradedTPB", {wls_eff});
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // All Optical Material Properties from normal TPB ...
     mpt->AddProperty("RINDEX",       opticalprops::TPB()->GetProperty("RINDEX"));
@@ -1023,7 +1077,9 @@ namespace opticalprops {
   {
     // Data from https://doi.org/10.1016/j.nima.2011.12.036
     // and https://iopscience.iop.org/article/10.1088/1748-0221/5/04/P04007/
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("TPH");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> rIndex_energies = {optPhotMinE_, optPhotMaxE_};
@@ -1114,7 +1170,9 @@ namespace opticalprops {
   {
     // https://eljentechnology.com/products/wavelength-shifting-plastics/ej-280-ej-282-ej-284-ej-286
     // and data sheets from the provider.
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("EJ280");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> ri_energy = {
@@ -1238,7 +1296,9 @@ namespace opticalprops {
   {
     // https://eljentechnology.com/products/wavelength-shifting-plastics/ej-280-ej-282-ej-284-ej-286
     // and data sheets from the provider.
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("EJ286");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> ri_energy = {
@@ -1363,7 +1423,9 @@ namespace opticalprops {
     // http://kuraraypsf.jp/psf/index.html
     // http://kuraraypsf.jp/psf/ws.html
     // Excel provided by kuraray with Tabulated WLS absorption lengths
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("Y11");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> ri_energy = {
@@ -1450,7 +1512,9 @@ namespace opticalprops {
     // http://kuraraypsf.jp/psf/index.html
     // http://kuraraypsf.jp/psf/ws.html
     // Excel provided by kuraray with Tabulated WLS absorption lengths
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("B2");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> ri_energy = {
@@ -1557,7 +1621,9 @@ namespace opticalprops {
   {
     // Fiber cladding material.
     // Properties from geant4/examples/extended/optical/wls
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("Pethylene");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> rIndex_energies = {optPhotMinE_, optPhotMaxE_};
@@ -1578,7 +1644,9 @@ namespace opticalprops {
   {
     // Fiber cladding material.
     // Properties from geant4/examples/extended/optical/wls
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("FPethylene");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> rIndex_energies = {optPhotMinE_, optPhotMaxE_};
@@ -1600,7 +1668,9 @@ namespace opticalprops {
   {
     // Fiber cladding material.
     // Properties from geant4/examples/extended/optical/wls
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("PMMA");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> rIndex_energies = {optPhotMinE_, optPhotMaxE_};
@@ -1628,7 +1698,9 @@ namespace opticalprops {
   // Copper Optical Properties Table
   G4MaterialPropertiesTable * Copper()
   {
-       G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+       G4MaterialPropertiesTable*& mpt = Cached("Copper");
+       if (mpt) return mpt;
+       mpt = new G4MaterialPropertiesTable();
 
       // Reflectivity
       std::vector<G4double> refl_energies = {
@@ -1655,7 +1727,9 @@ namespace opticalprops {
   // Stainles Steel Optical Properties Table
   G4MaterialPropertiesTable * Steel()
   {
-      G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+      G4MaterialPropertiesTable*& mpt = Cached("Steel");
+      if (mpt) return mpt;
+      mpt = new G4MaterialPropertiesTable();
 
       // Reflectivity
       std::vector<G4double> refl_energies = {
@@ -1681,7 +1755,9 @@ namespace opticalprops {
   G4MaterialPropertiesTable* XXX()
   {
     // Playing material properties
-    G4MaterialPropertiesTable* mpt = new G4MaterialPropertiesTable();
+    G4MaterialPropertiesTable*& mpt = Cached("XXX");
+    if (mpt) return mpt;
+    mpt = new G4MaterialPropertiesTable();
 
     // REFRACTIVE INDEX
     std::vector<G4double> rIndex_energies = {optPhotMinE_, optPhotMaxE_};
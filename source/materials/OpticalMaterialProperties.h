@@ -21,6 +21,8 @@ namespace opticalprops {
 
   using namespace CLHEP;
 
+  // Each table is built once per set of parameters and shared by
+  // all the materials and surfaces using it, so it must not be modified.
 
   G4MaterialPropertiesTable* Vacuum();
 
@@ -305,15 +305,27 @@ std::pair<G4int, G4int> MakeXeDensityDataTable(std::vector<std::vector<G4double>
 }
 
 
+namespace {
+
+  /// Density data table, read from file once per process
+  struct XeDensityDataTable {
+    std::vector<std::vector<G4double>> data;
+    std::pair<G4int, G4int> nkeys;
+    XeDensityDataTable(): nkeys(MakeXeDensityDataTable(data)) {}
+  };
+
+}
+
+
 G4double GetGasDensity(G4double pressure, G4double temperature)
 {
   // Interpolate to calculate the density
   // at a given pressure and temperature
   G4double density = 5.324 * kg/m3;
-  std::vector<std::vector<G4double>> data;
-  std::pair<G4int, G4int> nkeys = MakeXeDensityDataTable(data);
-  G4int npressures = nkeys.first;
-  G4int ntemps     = nkeys.second;
+  static const XeDensityDataTable table;
+  const std::vector<std::vector<G4double>>& data = table.data;
+  G4int npressures = table.nkeys.first;
+  G4int ntemps     = table.nkeys.second;
 
   // Find correct interval and use bilinear interpolation
   G4bool found = false;
@@ -8,6 +8,7 @@
 
 #include "NexusApp.h"
 #include "NexusExceptionHandler.h"
+#include "NexusServer.h"
 
 #include <G4StateManager.hh>
 #include <G4UImanager.hh>
@@ -16,19 +17,26 @@
 #include <G4SteppingVerbose.hh>
 
 #include <getopt.h>
+#include <fstream>
 
 using namespace nexus;
 
 
 void PrintUsage()
 {
-  G4cerr  << "\nUsage: ./nexus [-b|i] [-n number] <init_macro>\n" << G4endl;
+  G4cerr  << "\nUsage: ./nexus [-b|i] [-n number] <init_macro>\n"
+          << "       ./nexus -s socket <init_macro>\n"
+          << "       ./nexus -c socket [-n number] <job_macro>\n"
+          << "       ./nexus -c socket --shutdown\n" << G4endl;
   G4cerr  << "Available options:" << G4endl;
   G4cerr  << "   -b, --batch           : Run in batch mode (default)\n"
           << "   -i, --interactive     : Run in interactive mode\n"
           << "   -o, --overlap-check   : Turn warnings into exceptions and increase precision in overlap check\n"
           << "   -n, --nevents         : Number of events to simulate\n"
-          << "   -p, --precision       : Number of significant figures in verbosity"
+          << "   -p, --precision       : Number of significant figures in verbosity\n"
+          << "   -s, --server          : Initialize and then run the jobs received on the socket\n"
+          << "   -c, --client          : Send a job macro to the server listening on the socket\n"
+          << "       --shutdown        : With -c, stop the server"
           << G4endl;
   exit(EXIT_FAILURE);
 }
@@ -47,6 +55,9 @@ G4int main(int argc, char** argv)
   G4bool overlap_check = false;
   G4int nevents = 0;
   G4int precision = -1;
+  G4String server_socket = "";
+  G4String client_socket = "";
+  G4bool shutdown = false;
 
   static struct option long_options[] =
   {
@@ -55,6 +66,9 @@ G4int main(int argc, char** argv)
     {"overlaps",    no_argument,       0, 'o'},
     {"precision",   required_argument, 0, 'p'},
     {"nevents",     required_argument, 0, 'n'},
+    {"server",      required_argument, 0, 's'},
+    {"client",      required_argument, 0, 'c'},
+    {"shutdown",    no_argument,       0, 'x'},
     {0, 0, 0, 0}
   };
 
@@ -64,7 +78,7 @@ G4int main(int argc, char** argv)
 
     //  int option_index = 0;
     opterr = 0;
-    c = getopt_long(argc, argv, "biop:n:", long_options, 0);
+    c = getopt_long(argc, argv, "biop:n:s:c:", long_options, 0);
 
     if (c==-1) break; // Exit if we are done reading options
 
@@ -90,6 +104,18 @@ G4int main(int argc, char** argv)
         nevents = atoi(optarg);
         break;
 
+      case 's':
+        server_socket = optarg;
+        break;
+
+      case 'c':
+        client_socket = optarg;
+        break;
+
+      case 'x':
+        shutdown = true;
+        break;
+
       case '?':
         break;
 
@@ -98,6 +124,38 @@ G4int main(int argc, char** argv)
     }
   }
 
+  // As a client, nexus just sends the job to the server and reports
+  // its reply, without initializing anything itself
+  if (client_socket != "") {
+    std::vector<G4String> job;
+    if (shutdown) {
+      job.push_back("shutdown");
+    }
+    else {
+      if (optind == argc) PrintUsage();
+      std::ifstream job_macro(argv[optind]);
+      if (!job_macro) {
+        G4cerr << "Cannot read " << argv[optind] << G4endl;
+        return EXIT_FAILURE;
+      }
+      G4String line;
+      while (std::getline(job_macro, line)) {
+        // The number of events given in the command line takes precedence
+        if (nevents > 0 && line.rfind("/run/beamOn", 0) == 0) continue;
+        job.push_back(line);
+      }
+      if (nevents > 0) job.push_back("/run/beamOn " + std::to_string(nevents));
+    }
+
+    G4String reply = NexusServer::Submit(client_socket, job);
+    if (reply == "") {
+      G4cerr << "No reply from the server at " << client_socket << G4endl;
+      return EXIT_FAILURE;
+    }
+    G4cout << reply << G4endl;
+    return reply.rfind("OK", 0) == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
   // If there is no other command-line argument to be processed, abort
   // because the user has not provided a configuration macro.
   // (The variable optind is set by getopt_long to the index of the next
@@ -121,6 +179,8 @@ G4int main(int argc, char** argv)
   }
 
   NexusApp* app = new NexusApp(macro_filename);
+  // Every job of the server writes its own output file
+  if (server_socket != "") app->DeferOutputFile();
   app->Initialize();
 
   G4UImanager* UI = G4UImanager::GetUIpointer();
@@ -135,8 +195,12 @@ G4int main(int argc, char** argv)
 
   // CLHEP::HepRandom::showEngineStatus();
 
+  if (server_socket != "") {
+    NexusServer server(app, server_socket);
+    server.Serve();
+  }
   // visual mode
-  if (!batch) {
+  else if (!batch) {
     std::unique_ptr<G4UIExecutive> ui{new G4UIExecutive{1, argv}};
     std::unique_ptr<G4VisManager> visManager{new G4VisExecutive};
     visManager->Initialize();
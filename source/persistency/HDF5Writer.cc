@@ -20,8 +20,9 @@ using namespace nexus;
 
 
 HDF5Writer::HDF5Writer():
-  file_(0), irun_(0), ismp_(0), ihit_(0),
-  ipart_(0), ipos_(0), istep_(0), istrmap_(0)
+  file_(0), swmr_(false), flushInterval_(0), nUnflushed_(0), profile_(false),
+  irun_(0), ismp_(0), ihit_(0),
+  ipart_(0), ipos_(0), istep_(0), istepname_(0), istrmap_(0), ievt_(0), iprof_(0)
 {
 }
 
@@ -29,12 +30,36 @@ HDF5Writer::~HDF5Writer()
 {
 }
 
+void HDF5Writer::SetSWMR(bool swmr, unsigned int flush_interval)
+{
+  swmr_ = swmr;
+  flushInterval_ = flush_interval;
+}
+
+void HDF5Writer::SetProfile(bool profile)
+{
+  profile_ = profile;
+}
+
 void HDF5Writer::Open(std::string fileName, bool debug, bool save_str)
 {
   firstEvent_= true;
 
+  // Row counters are per file
+  irun_ = ismp_ = ihit_ = ipart_ = ipos_ = istep_ = istepname_ = istrmap_ = ievt_ = iprof_ = 0;
+  nUnflushed_ = 0;
+
+  // SWMR access requires the latest version of the file format
+  hid_t fapl = H5P_DEFAULT;
+  if (swmr_) {
+    fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_libver_bounds(fapl, H5F_LIBVER_LATEST, H5F_LIBVER_LATEST);
+  }
+
   file_ = H5Fcreate( fileName.c_str(), H5F_ACC_TRUNC,
-                      H5P_DEFAULT, H5P_DEFAULT );
+                      H5P_DEFAULT, fapl );
+
+  if (swmr_) H5Pclose(fapl);
 
   std::string group_name = "/MC";
   size_t group = createGroup(file_, group_name);
@@ -59,29 +84,110 @@ void HDF5Writer::Open(std::string fileName, bool debug, bool save_str)
   memtypeSnsPos_ = createSensorPosType();
   snsPosTable_ = createTable(group, sns_pos_table_name, memtypeSnsPos_);
 
+  memtypeStringMap_ = createStringMapType();
   if (!save_str) {
     std::string str_map_table_name = "string_map";
-    memtypeStringMap_ = createStringMapType();
     stringMapTable_ = createTable(group, str_map_table_name, memtypeStringMap_);
   }
 
+  std::string event_index_table_name = "event_index";
+  memtypeEventIndex_ = createEventIndexType();
+  eventIndexTable_ = createTable(group, event_index_table_name, memtypeEventIndex_);
+
   if (debug) {
     std::string debug_group_name = "/DEBUG";
     size_t debug_group = createGroup(file_, debug_group_name);
     std::string step_table_name = "steps";
     memtypeStep_ = createStepType();
     stepTable_   = createTable(debug_group, step_table_name, memtypeStep_);
+    std::string step_name_table_name = "string_map";
+    stepNameTable_ = createTable(debug_group, step_name_table_name, memtypeStringMap_);
+    tables_.push_back(stepTable_);
+    tables_.push_back(stepNameTable_);
+    H5Gclose(debug_group);
+  }
+
+  if (profile_) {
+    std::string profile_group_name = "/PROFILE";
+    size_t profile_group = createGroup(file_, profile_group_name);
+    std::string profile_table_name = "steps";
+    memtypeProfile_ = createProfileType();
+    profileTable_   = createTable(profile_group, profile_table_name, memtypeProfile_);
+    tables_.push_back(profileTable_);
+    memtypes_.push_back(memtypeProfile_);
+    H5Gclose(profile_group);
   }
 
+  H5Gclose(group);
+
+  tables_.push_back(runTable_);
+  tables_.push_back(snsDataTable_);
+  tables_.push_back(hitInfoTable_);
+  tables_.push_back(particleInfoTable_);
+  tables_.push_back(snsPosTable_);
+  tables_.push_back(eventIndexTable_);
+  if (!save_str) tables_.push_back(stringMapTable_);
+
+  memtypes_.insert(memtypes_.end(),
+                   {memtypeRun_, memtypeSnsData_, memtypeHitInfo_,
+                    memtypeParticleInfo_, memtypeSnsPos_, memtypeStringMap_,
+                    memtypeEventIndex_});
+  if (debug) memtypes_.push_back(memtypeStep_);
+
+  // No new objects can be created in the file from now on,
+  // only the existing tables can be extended
+  if (swmr_) H5Fstart_swmr_write(file_);
+
   isOpen_ = true;
 }
 
 void HDF5Writer::Close()
 {
+  Flush();
   isOpen_=false;
+
+  // Release the datasets so that the file is really closed
+  for (hid_t table : tables_) H5Dclose(table);
+  tables_.clear();
+  for (size_t memtype : memtypes_) H5Tclose(memtype);
+  memtypes_.clear();
   H5Fclose(file_);
 }
 
+unsigned long long HDF5Writer::GetFileSize() const
+{
+  hsize_t size = 0;
+  H5Fget_filesize(file_, &size);
+  return size;
+}
+
+void HDF5Writer::Flush()
+{
+  writeRows(snsDataBuffer_.data(), snsDataBuffer_.size(),
+            snsDataTable_, memtypeSnsData_, ismp_);
+  ismp_ += snsDataBuffer_.size();
+  snsDataBuffer_.clear();
+
+  writeRows(hitInfoBuffer_.data(), hitInfoBuffer_.size(),
+            hitInfoTable_, memtypeHitInfo_, ihit_);
+  ihit_ += hitInfoBuffer_.size();
+  hitInfoBuffer_.clear();
+
+  writeRows(particleInfoBuffer_.data(), particleInfoBuffer_.size(),
+            particleInfoTable_, memtypeParticleInfo_, ipart_);
+  ipart_ += particleInfoBuffer_.size();
+  particleInfoBuffer_.clear();
+
+  if (swmr_ && flushInterval_ > 0 && ++nUnflushed_ >= flushInterval_)
+    FlushDatasets();
+}
+
+void HDF5Writer::FlushDatasets()
+{
+  for (hid_t table : tables_) H5Dflush(table);
+  nUnflushed_ = 0;
+}
+
 void HDF5Writer::WriteRunInfo(const char* param_key, const char* param_value)
 {
   run_info_t runData;
@@ -97,19 +203,18 @@ void HDF5Writer::WriteRunInfo(const char* param_key, const char* param_value)
 
 void HDF5Writer::WriteSensorDataInfo(int64_t evt_number, unsigned int sensor_id, unsigned int time_bin, unsigned int charge)
 {
-  sns_data_t snsData;
+  snsDataBuffer_.emplace_back();
+  sns_data_t& snsData = snsDataBuffer_.back();
   snsData.event_id = evt_number;
   snsData.sensor_id = sensor_id;
   snsData.time_bin = time_bin;
   snsData.charge = charge;
-  writeSnsData(&snsData, snsDataTable_, memtypeSnsData_, ismp_);
-
-  ismp_++;
 }
 
 void HDF5Writer::WriteHitInfo(bool str, int64_t evt_number, int particle_indx, int hit_indx, float hit_position_x, float hit_position_y, float hit_position_z, float hit_time, float hit_energy, const char* label_str, int label)
 {
-  hit_info_t trueInfo;
+  hitInfoBuffer_.emplace_back();
+  hit_info_t& trueInfo = hitInfoBuffer_.back();
   trueInfo.event_id = evt_number;
   trueInfo.x = hit_position_x;
   trueInfo.y = hit_position_y;
@@ -124,14 +229,12 @@ void HDF5Writer::WriteHitInfo(bool str, int64_t evt_number, int particle_indx, i
   }
   trueInfo.particle_id = particle_indx;
   trueInfo.hit_id = hit_indx;
-  writeHit(&trueInfo,  hitInfoTable_, memtypeHitInfo_, ihit_);
-
-  ihit_++;
 }
 
 void HDF5Writer::WriteParticleInfo(bool str, int64_t evt_number, int particle_indx, const char* particle_name_str, int particle_name, char primary, int mother_id, float initial_vertex_x, float initial_vertex_y, float initial_vertex_z, float initial_vertex_t, float final_vertex_x, float final_vertex_y, float final_vertex_z, float final_vertex_t, const char* initial_volume_str, const char* final_volume_str, int initial_volume, int final_volume, float ini_momentum_x, float ini_momentum_y, float ini_momentum_z, float final_momentum_x, float final_momentum_y, float final_momentum_z, float kin_energy, float length, const char* creator_proc_str, const char* final_proc_str, int creator_proc, int final_proc)
 {
-  particle_info_t trueInfo;
+  particleInfoBuffer_.emplace_back();
+  particle_info_t& trueInfo = particleInfoBuffer_.back();
   trueInfo.event_id = evt_number;
   trueInfo.particle_id = particle_indx;
   if (str) {
@@ -176,9 +279,6 @@ void HDF5Writer::WriteParticleInfo(bool str, int64_t evt_number, int particle_in
     trueInfo.creator_proc = creator_proc;
     trueInfo.final_proc = final_proc;
   }
-  writeParticle(&trueInfo,  particleInfoTable_, memtypeParticleInfo_, ipart_);
-
-  ipart_++;
 }
 
 void HDF5Writer::WriteSensorPosInfo(unsigned int sensor_id, const char* sensor_name, float x, float y, float z)
@@ -195,39 +295,45 @@ void HDF5Writer::WriteSensorPosInfo(unsigned int sensor_id, const char* sensor_n
   ipos_++;
 }
 
-void HDF5Writer::WriteStep(int64_t evt_number,
-                           int particle_id, const char* particle_name,
-                           int step_id,
-                           const char* initial_volume,
-                           const char*   final_volume,
-                           const char*      proc_name,
-                           float initial_x, float initial_y, float initial_z,
-                           float   final_x, float   final_y, float   final_z,
-                           float time)
-{
-  step_info_t step;
-  step.event_id    = evt_number;
-  step.particle_id = particle_id;
-  memset(step.particle_name , 0,  STRLEN);
-  strcpy(step.particle_name ,  particle_name);
-  step.step_id    = step_id;
-  memset(step.initial_volume, 0, STRLEN);
-  strcpy(step.initial_volume, initial_volume);
-  memset(step.  final_volume, 0, STRLEN);
-  strcpy(step.  final_volume,   final_volume);
-  memset(step.     proc_name, 0, STRLEN);
-  strcpy(step.     proc_name,      proc_name);
-  step.initial_x   = initial_x;
-  step.initial_y   = initial_y;
-  step.initial_z   = initial_z;
-  step.  final_x   =   final_x;
-  step.  final_y   =   final_y;
-  step.  final_z   =   final_z;
-  step.time        =      time;
-
-  writeStep(&step, stepTable_, memtypeStep_, istep_);
-
-  istep_++;
+void HDF5Writer::WriteSteps(int64_t evt_number, const step_columns_t& steps)
+{
+  // The columns are gathered into rows, so that
+  // the steps of the event are written at once
+  const size_t nsteps = steps.size();
+  stepInfoBuffer_.resize(nsteps);
+
+  for (size_t i=0; i<nsteps; ++i) {
+    step_info_t& step = stepInfoBuffer_[i];
+    step.event_id       = evt_number;
+    step.particle_id    = steps.particle_id[i];
+    step.particle_name  = steps.particle_name[i];
+    step.step_id        = steps.step_id[i];
+    step.initial_volume = steps.initial_volume[i];
+    step.final_volume   = steps.final_volume[i];
+    step.proc_name      = steps.proc_name[i];
+    step.initial_x      = steps.initial_x[i];
+    step.initial_y      = steps.initial_y[i];
+    step.initial_z      = steps.initial_z[i];
+    step.final_x        = steps.final_x[i];
+    step.final_y        = steps.final_y[i];
+    step.final_z        = steps.final_z[i];
+    step.time           = steps.time[i];
+  }
+
+  writeRows(stepInfoBuffer_.data(), nsteps, stepTable_, memtypeStep_, istep_);
+
+  istep_ += nsteps;
+}
+
+void HDF5Writer::WriteStepNameInfo(const char* name, int name_id)
+{
+  string_map_t strmap;
+  memset(strmap.name, 0, STRLEN);
+  strcpy(strmap.name, name);
+  strmap.name_id = name_id;
+
+  writeStringMap(&strmap, stepNameTable_, memtypeStringMap_, istepname_);
+  istepname_++;
 }
 
 void HDF5Writer::WriteStringMapInfo(const char* name, int name_id)
@@ -240,3 +346,34 @@ void HDF5Writer::WriteStringMapInfo(const char* name, int name_id)
   writeStringMap(&strmap, stringMapTable_, memtypeStringMap_, istrmap_);
   istrmap_++;
 }
+
+void HDF5Writer::WriteEventIndex(int64_t evt_number, uint64_t rng_seed)
+{
+  // The rows of the event start after those already written
+  event_index_t index;
+  index.event_id        = evt_number;
+  index.hits_first      = ihit_;
+  index.hits_count      = hitInfoBuffer_.size();
+  index.particles_first = ipart_;
+  index.particles_count = particleInfoBuffer_.size();
+  index.rng_seed        = rng_seed;
+  writeRows(&index, 1, eventIndexTable_, memtypeEventIndex_, ievt_);
+
+  ievt_++;
+}
+
+void HDF5Writer::WriteProfile(const char* particle, const char* volume, const char* process,
+                              uint64_t steps, uint64_t tracks, double time)
+{
+  profile_t entry;
+  memset(&entry, 0, sizeof(entry));
+  strncpy(entry.particle, particle, STRLEN-1);
+  strncpy(entry.volume,   volume,   STRLEN-1);
+  strncpy(entry.process,  process,  STRLEN-1);
+  entry.steps  = steps;
+  entry.tracks = tracks;
+  entry.time   = time;
+  writeRows(&entry, 1, profileTable_, memtypeProfile_, iprof_);
+
+  iprof_++;
+}
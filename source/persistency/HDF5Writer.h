@@ -13,6 +13,7 @@
 
 #include <hdf5.h>
 #include <iostream>
+#include <vector>
 
 namespace nexus {
 
@@ -24,34 +25,57 @@ namespace nexus {
     /// destructor
     ~HDF5Writer();
 
+    /// set single-writer/multiple-reader mode, flushing the
+    /// datasets every flush_interval events. Must be set before Open().
+    void SetSWMR(bool swmr, unsigned int flush_interval);
+
+    /// create the /PROFILE group for the step profile.
+    /// Must be set before Open().
+    void SetProfile(bool profile);
+
     /// open file
     void Open(std::string filename, bool debug, bool save_str);
 
     /// close file
     void Close();
 
+    /// write the rows buffered for the current event
+    void Flush();
+
+    /// current size of the output file in bytes
+    unsigned long long GetFileSize() const;
+
     void WriteRunInfo(const char* param_key, const char* param_value);
     void WriteSensorDataInfo(int64_t evt_number, unsigned int sensor_id, unsigned int time_bin, unsigned int charge);
     void WriteHitInfo(bool str, int64_t evt_number, int particle_indx, int hit_indx, float hit_position_x, float hit_position_y, float hit_position_z, float hit_time, float hit_energy, const char* label_str, int label);
     void WriteParticleInfo(bool str, int64_t evt_number, int particle_indx, const char* particle_name_str, int particle_name, char primary, int mother_id, float initial_vertex_x, float initial_vertex_y, float initial_vertex_z, float initial_vertex_t, float final_vertex_x, float final_vertex_y, float final_vertex_z, float final_vertex_t, const char* initial_volume_str, const char* final_volume_str, int initial_volume, int final_volume, float ini_momentum_x, float ini_momentum_y, float ini_momentum_z, float final_momentum_x, float final_momentum_y, float final_momentum_z, float kin_energy, float length, const char* creator_proc_str, const char* final_proc_str, int creator_proc, int final_proc);
     void WriteSensorPosInfo(unsigned int sensor_id, const char* sensor_name, float x, float y, float z);
-    void WriteStep(int64_t evt_number,
-                   int particle_id, const char* particle_name,
-                   int step_id,
-                   const char* initial_volume,
-                   const char*   final_volume,
-                   const char*      proc_name,
-                   float initial_x, float initial_y, float initial_z,
-                   float   final_x, float   final_y, float   final_z,
-                   float time);
+    void WriteSteps(int64_t evt_number, const step_columns_t& steps);
+    void WriteStepNameInfo(const char* name, int name_id);
     void WriteStringMapInfo(const char* name, int name_id);
+    /// Index the rows buffered for the current event. Must be called before Flush().
+    void WriteEventIndex(int64_t evt_number, uint64_t rng_seed);
+    void WriteProfile(const char* particle, const char* volume, const char* process,
+                      uint64_t steps, uint64_t tracks, double time);
 
   private:
+    /// make the written data visible to SWMR readers
+    void FlushDatasets();
+
     size_t file_; ///< HDF5 file
 
     bool isOpen_;
     bool firstEvent_; ///< First event
 
+    bool swmr_; ///< Single-writer/multiple-reader mode
+    unsigned int flushInterval_; ///< Events between dataset flushes in SWMR mode
+    unsigned int nUnflushed_; ///< Events written since the last flush
+
+    bool profile_; ///< Write the step profile
+
+    std::vector<hid_t> tables_; ///< All the datasets of the file
+    std::vector<size_t> memtypes_; ///< All the memory types of the file
+
     //Datasets
     size_t runTable_;
     size_t snsDataTable_;
@@ -59,7 +83,10 @@ namespace nexus {
     size_t particleInfoTable_;
     size_t snsPosTable_;
     size_t stepTable_;
+    size_t stepNameTable_;
     size_t stringMapTable_;
+    size_t eventIndexTable_;
+    size_t profileTable_;
 
     size_t memtypeRun_;
     size_t memtypeSnsData_;
@@ -68,6 +95,8 @@ namespace nexus {
     size_t memtypeSnsPos_;
     size_t memtypeStep_;
     size_t memtypeStringMap_;
+    size_t memtypeEventIndex_;
+    size_t memtypeProfile_;
 
     size_t irun_; ///< counter for configuration parameters
     size_t ismp_; ///< counter for written waveform samples
@@ -75,7 +104,17 @@ namespace nexus {
     size_t ipart_; ///< counter for particle information
     size_t ipos_; ///< counter for sensor positions
     size_t istep_; ///< counter for steps
+    size_t istepname_; ///< counter for step name map
     size_t istrmap_;  ///< counter for string map
+    size_t ievt_; ///< counter for event index
+    size_t iprof_; ///< counter for profile entries
+
+    // Rows of the current event, written in bulk by Flush().
+    // They are reused across events to avoid reallocations.
+    std::vector<sns_data_t>      snsDataBuffer_;
+    std::vector<hit_info_t>      hitInfoBuffer_;
+    std::vector<particle_info_t> particleInfoBuffer_;
+    std::vector<step_info_t>     stepInfoBuffer_;
 
   };
 
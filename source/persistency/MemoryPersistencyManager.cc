@@ -0,0 +1,318 @@
+// ----------------------------------------------------------------------------
+// nexus | MemoryPersistencyManager.cc
+//
+// This persistency manager keeps the simulated events in memory, instead
+// of writing them to a file, so that nexus can be embedded in another
+// application. The events are stored in a ring of reusable slots: when
+// the ring is full, the oldest event is overwritten. The application
+// retrieves the manager with G4VPersistencyManager::GetPersistencyManager()
+// and reads (and pops) the events after each call to BeamOn, or from
+// the end-of-event action.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "MemoryPersistencyManager.h"
+
+#include "Trajectory.h"
+#include "TrajectoryMap.h"
+#include "IonizationSD.h"
+#include "SensorSD.h"
+#include "SaveAllSteppingAction.h"
+#include "FactoryBase.h"
+
+#include <G4GenericMessenger.hh>
+#include <G4Event.hh>
+#include <G4TrajectoryContainer.hh>
+#include <G4SDManager.hh>
+#include <G4HCtable.hh>
+#include <G4RunManager.hh>
+
+using namespace nexus;
+
+
+REGISTER_CLASS(MemoryPersistencyManager, PersistencyManagerBase)
+
+
+MemoryPersistencyManager::MemoryPersistencyManager():
+  PersistencyManagerBase(), msg_(0), output_file_(""), event_type_(""),
+  save_str_(true), swmr_(false), swmr_flush_(100), max_file_size_(0.),
+  events_per_file_(0), save_seeds_(false), particles_(true), ring_(100), first_(0), size_(0),
+  overwritten_(0), nevt_(0), start_id_(0), first_evt_(true)
+{
+  msg_ = new G4GenericMessenger(this, "/nexus/persistency/");
+  msg_->DeclareMethod("ring_size", &MemoryPersistencyManager::SetRingSize,
+                      "Maximum number of events kept in memory.");
+  msg_->DeclareMethod("start_id", &MemoryPersistencyManager::SetStartID,
+                      "Starting event ID for this job.");
+  msg_->DeclareProperty("save_particles", particles_,
+                        "True if particles are stored.");
+  msg_->DeclareProperty("output_file", output_file_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("event_type", event_type_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("save_strings", save_str_, "Ignored: names are always stored as IDs.");
+  msg_->DeclareProperty("swmr", swmr_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("swmr_flush_interval", swmr_flush_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("max_file_size", max_file_size_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("events_per_file", events_per_file_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("save_rng_seeds", save_seeds_, "Ignored: no output file is written.");
+}
+
+
+
+MemoryPersistencyManager::~MemoryPersistencyManager()
+{
+  delete msg_;
+}
+
+
+
+void MemoryPersistencyManager::SetRingSize(G4int n)
+{
+  if (n < 1) {
+    G4Exception("[MemoryPersistencyManager]", "SetRingSize()", FatalException,
+                "The ring must hold at least one event.");
+  }
+  ring_.resize(n);
+  Clear();
+}
+
+
+
+void MemoryPersistencyManager::SetStartID(G4String s)
+{
+  start_id_ = atoll(s);
+}
+
+
+
+void MemoryPersistencyManager::PopEvent()
+{
+  if (size_ == 0) return;
+  first_ = (first_ + 1) % ring_.size();
+  size_--;
+}
+
+
+
+void MemoryPersistencyManager::Clear()
+{
+  first_ = 0;
+  size_  = 0;
+}
+
+
+
+G4bool MemoryPersistencyManager::Store(const G4Event* event)
+{
+  if (store_steps_) {
+    SaveAllSteppingAction* sa = (SaveAllSteppingAction*)
+      G4RunManager::GetRunManager()->GetUserSteppingAction();
+    sa->Reset();
+  }
+
+  if (!store_evt_) {
+    TrajectoryMap::Clear();
+    return false;
+  }
+
+  if (first_evt_) {
+    first_evt_ = false;
+    nevt_ = start_id_;
+  }
+
+  // Overwrite the oldest event if the ring is full
+  if (size_ == ring_.size()) {
+    PopEvent();
+    overwritten_++;
+  }
+
+  MemoryEvent& evt = ring_[(first_ + size_) % ring_.size()];
+  size_++;
+
+  evt.event_id = nevt_;
+  evt.hits.clear();
+  evt.particles.clear();
+  evt.sns_response.clear();
+
+  if (particles_) {
+    StoreTrajectories(event->GetTrajectoryContainer(), evt);
+  }
+
+  StoreHits(event->GetHCofThisEvent(), evt);
+
+  // Reset the hit counters of the tracks seen in this event
+  for (auto trackid : hit_tracks_) hit_counts_[trackid] = 0;
+  hit_tracks_.clear();
+
+  nevt_++;
+
+  TrajectoryMap::Clear();
+  StoreCurrentEvent(true);
+
+  return true;
+}
+
+
+
+void MemoryPersistencyManager::StoreTrajectories(G4TrajectoryContainer* tc,
+                                                 MemoryEvent& evt)
+{
+  if (!tc) return;
+
+  for (size_t i=0; i<tc->entries(); ++i) {
+    Trajectory* trj = dynamic_cast<Trajectory*>((*tc)[i]);
+    if (!trj) continue;
+
+    G4ThreeVector ini_xyz   = trj->GetInitialPosition();
+    G4ThreeVector final_xyz = trj->GetFinalPosition();
+    G4ThreeVector ini_mom   = trj->GetInitialMomentum();
+    G4ThreeVector final_mom = trj->GetFinalMomentum();
+    G4double mass           = trj->GetParticleDefinition()->GetPDGMass();
+
+    evt.particles.emplace_back();
+    MemoryParticle& p = evt.particles.back();
+
+    p.particle_id   = trj->GetTrackID();
+    p.particle_name = FindStringID(trj->GetParticleName());
+    p.primary       = (trj->GetParentID() == 0);
+    p.mother_id     = trj->GetParentID();
+    p.initial_x     = ini_xyz.x();
+    p.initial_y     = ini_xyz.y();
+    p.initial_z     = ini_xyz.z();
+    p.initial_t     = trj->GetInitialTime();
+    p.final_x       = final_xyz.x();
+    p.final_y       = final_xyz.y();
+    p.final_z       = final_xyz.z();
+    p.final_t       = trj->GetFinalTime();
+    p.initial_volume = FindStringID(trj->GetInitialVolume());
+    p.final_volume   = FindStringID(trj->GetFinalVolume());
+    p.initial_momentum_x = ini_mom.x();
+    p.initial_momentum_y = ini_mom.y();
+    p.initial_momentum_z = ini_mom.z();
+    p.final_momentum_x   = final_mom.x();
+    p.final_momentum_y   = final_mom.y();
+    p.final_momentum_z   = final_mom.z();
+    p.kin_energy    = sqrt(ini_mom.mag2() + mass*mass) - mass;
+    p.length        = trj->GetTrackLength();
+    p.creator_proc  = FindStringID(trj->GetCreatorProcess());
+    p.final_proc    = FindStringID(trj->GetFinalProcess());
+  }
+}
+
+
+
+void MemoryPersistencyManager::StoreHits(G4HCofThisEvent* hce, MemoryEvent& evt)
+{
+  if (!hce) return;
+
+  G4SDManager* sdmgr = G4SDManager::GetSDMpointer();
+  G4HCtable* hct = sdmgr->GetHCtable();
+
+  for (auto i=0; i<hct->entries(); i++) {
+
+    G4String hcname = hct->GetHCname(i);
+    G4String sdname = hct->GetSDname(i);
+    int hcid = sdmgr->GetCollectionID(sdname+"/"+hcname);
+
+    G4VHitsCollection* hits = hce->GetHC(hcid);
+
+    if (hcname == IonizationSD::GetCollectionUniqueName())
+      StoreIonizationHits(hits, evt);
+    else if (hcname == SensorSD::GetCollectionUniqueName())
+      StoreSensorHits(hits, evt);
+  }
+}
+
+
+
+void MemoryPersistencyManager::StoreIonizationHits(G4VHitsCollection* hc,
+                                                   MemoryEvent& evt)
+{
+  IonizationHitsCollection* hits =
+    dynamic_cast<IonizationHitsCollection*>(hc);
+  if (!hits) return;
+
+  G4int label = FindStringID(hits->GetSDname());
+
+  for (size_t i=0; i<hits->entries(); i++) {
+
+    IonizationHit* hit = (*hits)[i];
+
+    G4int trackid = hit->GetTrackID();
+    if (trackid >= (G4int) hit_counts_.size())
+      hit_counts_.resize(2 * trackid + 1, 0);
+    if (hit_counts_[trackid] == 0)
+      hit_tracks_.push_back(trackid);
+
+    G4ThreeVector xyz = hit->GetPosition();
+
+    evt.hits.emplace_back();
+    MemoryHit& h = evt.hits.back();
+    h.particle_id = trackid;
+    h.hit_id      = hit_counts_[trackid]++;
+    h.x           = xyz.x();
+    h.y           = xyz.y();
+    h.z           = xyz.z();
+    h.time        = hit->GetTime();
+    h.energy      = hit->GetEnergyDeposit();
+    h.label       = label;
+  }
+}
+
+
+
+void MemoryPersistencyManager::StoreSensorHits(G4VHitsCollection* hc,
+                                               MemoryEvent& evt)
+{
+  SensorHitsCollection* hits = dynamic_cast<SensorHitsCollection*>(hc);
+  if (!hits) return;
+
+  const G4String& sdname = hits->GetSDname();
+
+  if ((hits->entries() > 0) && (sensdet_bin_.find(sdname) == sensdet_bin_.end())) {
+    sensdet_bin_[sdname] = (*hits)[0]->GetBinSize();
+  }
+
+  for (size_t i=0; i<hits->entries(); i++) {
+
+    SensorHit* hit = (*hits)[i];
+    G4double binsize = hit->GetBinSize();
+
+    const std::map<G4double, G4int>& wvfm = hit->GetHistogram();
+    for (auto it = wvfm.begin(); it != wvfm.end(); ++it) {
+      evt.sns_response.emplace_back();
+      MemorySensorCharge& q = evt.sns_response.back();
+      q.sensor_id = hit->GetSensorID();
+      q.time_bin  = (G4int)(it->first/binsize + 0.5);
+      q.charge    = it->second;
+    }
+
+    if (sns_pos_.find(hit->GetSensorID()) == sns_pos_.end())
+      sns_pos_[hit->GetSensorID()] = hit->GetPosition();
+  }
+}
+
+
+
+G4bool MemoryPersistencyManager::Store(const G4Run*)
+{
+  if (overwritten_ > 0) {
+    G4String msg = std::to_string(overwritten_) +
+      " events were overwritten before being read. Consider increasing the ring size.";
+    G4Exception("[MemoryPersistencyManager]", "Store()", JustWarning, msg);
+  }
+  return true;
+}
+
+
+
+G4int MemoryPersistencyManager::FindStringID(const G4String& name)
+{
+  auto found = str_map_.find(name);
+  if (found != str_map_.end()) return found->second;
+
+  G4int id = str_table_.size();
+  str_map_[name] = id;
+  str_table_.push_back(name);
+  return id;
+}
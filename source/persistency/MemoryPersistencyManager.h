@@ -0,0 +1,185 @@
+// ----------------------------------------------------------------------------
+// nexus | MemoryPersistencyManager.h
+//
+// This persistency manager keeps the simulated events in memory, instead
+// of writing them to a file, so that nexus can be embedded in another
+// application. The events are stored in a ring of reusable slots: when
+// the ring is full, the oldest event is overwritten. The application
+// retrieves the manager with G4VPersistencyManager::GetPersistencyManager()
+// and reads (and pops) the events after each call to BeamOn, or from
+// the end-of-event action.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef MEMORY_PERSISTENCY_MANAGER_H
+#define MEMORY_PERSISTENCY_MANAGER_H
+
+#include "PersistencyManagerBase.h"
+
+#include <G4ThreeVector.hh>
+
+#include <map>
+#include <vector>
+
+class G4GenericMessenger;
+class G4HCofThisEvent;
+class G4TrajectoryContainer;
+class G4VHitsCollection;
+
+
+namespace nexus {
+
+  /// Ionization deposit of an event. Labels are indices in the string table.
+  struct MemoryHit {
+    G4int particle_id;
+    G4int hit_id;
+    G4float x, y, z;
+    G4float time;
+    G4float energy;
+    G4int label;
+  };
+
+  /// Particle of an event. Names are indices in the string table.
+  struct MemoryParticle {
+    G4int particle_id;
+    G4int particle_name;
+    G4bool primary;
+    G4int mother_id;
+    G4float initial_x, initial_y, initial_z, initial_t;
+    G4float final_x, final_y, final_z, final_t;
+    G4int initial_volume, final_volume;
+    G4float initial_momentum_x, initial_momentum_y, initial_momentum_z;
+    G4float final_momentum_x, final_momentum_y, final_momentum_z;
+    G4float kin_energy;
+    G4float length;
+    G4int creator_proc, final_proc;
+  };
+
+  /// Charge detected by a sensor in a time bin
+  struct MemorySensorCharge {
+    G4int sensor_id;
+    G4int time_bin;
+    G4int charge;
+  };
+
+  /// Slot of the event ring. Its vectors keep their capacity when reused.
+  struct MemoryEvent {
+    int64_t event_id;
+    std::vector<MemoryHit> hits;
+    std::vector<MemoryParticle> particles;
+    std::vector<MemorySensorCharge> sns_response;
+  };
+
+
+  class MemoryPersistencyManager: public PersistencyManagerBase
+  {
+  public:
+    MemoryPersistencyManager();
+    ~MemoryPersistencyManager();
+
+    virtual G4bool Store(const G4Event*);
+    virtual G4bool Store(const G4Run*);
+    virtual G4bool Store(const G4VPhysicalVolume*);
+
+    virtual G4bool Retrieve(G4Event*&);
+    virtual G4bool Retrieve(G4Run*&);
+    virtual G4bool Retrieve(G4VPhysicalVolume*&);
+
+  public:
+    void OpenFile();
+    void CloseFile();
+
+    /// Number of events available in the ring
+    size_t GetNumberOfEvents() const;
+    /// Return the i-th available event, the oldest being 0
+    const MemoryEvent& GetEvent(size_t i) const;
+    /// Release the oldest event, so that its slot can be reused
+    void PopEvent();
+    /// Release all the events
+    void Clear();
+    /// Number of events overwritten before being popped
+    int64_t GetNumberOfOverwrittenEvents() const;
+
+    /// Names of particles, volumes, processes and sensitive detectors
+    const std::vector<G4String>& GetStringTable() const;
+    /// Position of each sensor seen so far, by sensor ID
+    const std::map<G4int, G4ThreeVector>& GetSensorPositions() const;
+    /// Time bin width of each sensitive detector seen so far
+    const std::map<G4String, G4double>& GetSensorBinning() const;
+
+  private:
+    void StoreTrajectories(G4TrajectoryContainer*, MemoryEvent&);
+    void StoreHits(G4HCofThisEvent*, MemoryEvent&);
+    void StoreIonizationHits(G4VHitsCollection*, MemoryEvent&);
+    void StoreSensorHits(G4VHitsCollection*, MemoryEvent&);
+
+    G4int FindStringID(const G4String&);
+
+    void SetRingSize(G4int);
+    void SetStartID(G4String);
+
+  private:
+    G4GenericMessenger* msg_; ///< User configuration messenger
+
+    // Accepted for compatibility with the default persistency
+    // manager configuration, but not used
+    G4String output_file_;
+    G4String event_type_;
+    G4bool save_str_;
+    G4bool swmr_;
+    G4int swmr_flush_;
+    G4double max_file_size_;
+    G4int events_per_file_;
+    G4bool save_seeds_;
+
+    G4bool particles_; ///< Store particles
+
+    std::vector<MemoryEvent> ring_; ///< Reusable event slots
+    size_t first_; ///< Slot of the oldest event
+    size_t size_;  ///< Number of events in the ring
+    int64_t overwritten_; ///< Events overwritten before being popped
+
+    int64_t nevt_; ///< Event ID
+    int64_t start_id_; ///< ID for the first event
+    G4bool first_evt_; ///< true only for the first event of the run
+
+    std::map<G4String, G4int> str_map_;
+    std::vector<G4String> str_table_;
+    std::map<G4int, G4ThreeVector> sns_pos_;
+    std::map<G4String, G4double> sensdet_bin_;
+
+    std::vector<G4int> hit_counts_; ///< Number of hits per track ID
+    std::vector<G4int> hit_tracks_; ///< Track IDs with hits in the current event
+  };
+
+
+  // INLINE DEFINITIONS //////////////////////////////////////////////
+
+  inline G4bool MemoryPersistencyManager::Store(const G4VPhysicalVolume*)
+  { return false; }
+  inline G4bool MemoryPersistencyManager::Retrieve(G4Event*&)
+  { return false; }
+  inline G4bool MemoryPersistencyManager::Retrieve(G4Run*&)
+  { return false; }
+  inline G4bool MemoryPersistencyManager::Retrieve(G4VPhysicalVolume*&)
+  { return false; }
+  inline void MemoryPersistencyManager::OpenFile() {}
+  inline void MemoryPersistencyManager::CloseFile() {}
+
+  inline size_t MemoryPersistencyManager::GetNumberOfEvents() const
+  { return size_; }
+  inline const MemoryEvent& MemoryPersistencyManager::GetEvent(size_t i) const
+  { return ring_[(first_ + i) % ring_.size()]; }
+  inline int64_t MemoryPersistencyManager::GetNumberOfOverwrittenEvents() const
+  { return overwritten_; }
+  inline const std::vector<G4String>& MemoryPersistencyManager::GetStringTable() const
+  { return str_table_; }
+  inline const std::map<G4int, G4ThreeVector>& MemoryPersistencyManager::GetSensorPositions() const
+  { return sns_pos_; }
+  inline const std::map<G4String, G4double>& MemoryPersistencyManager::GetSensorBinning() const
+  { return sensdet_bin_; }
+
+} // namespace nexus
+
+#endif
@@ -0,0 +1,146 @@
+// ----------------------------------------------------------------------------
+// nexus | NullPersistencyManager.cc
+//
+// This persistency manager walks through the trajectories and hits of
+// every event, as the default one does, but discards them instead of
+// writing an output file. It is meant to measure the throughput of the
+// simulation itself. A summary with the number of processed hits is
+// printed at the end of the run.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "NullPersistencyManager.h"
+
+#include "Trajectory.h"
+#include "TrajectoryMap.h"
+#include "IonizationSD.h"
+#include "SensorSD.h"
+#include "SaveAllSteppingAction.h"
+#include "FactoryBase.h"
+
+#include <G4GenericMessenger.hh>
+#include <G4Event.hh>
+#include <G4TrajectoryContainer.hh>
+#include <G4SDManager.hh>
+#include <G4HCtable.hh>
+#include <G4RunManager.hh>
+
+using namespace nexus;
+
+
+REGISTER_CLASS(NullPersistencyManager, PersistencyManagerBase)
+
+
+NullPersistencyManager::NullPersistencyManager():
+  PersistencyManagerBase(), msg_(0), output_file_(""), event_type_(""),
+  start_id_(""), save_str_(true), particles_(true), swmr_(false),
+  swmr_flush_(100), max_file_size_(0.), events_per_file_(0), save_seeds_(false),
+  saved_evts_(0), interacting_evts_(0), nparticles_(0),
+  nihits_(0), nsns_bins_(0), nsns_charge_(0)
+{
+  msg_ = new G4GenericMessenger(this, "/nexus/persistency/");
+  msg_->DeclareProperty("output_file", output_file_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("event_type", event_type_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("start_id", start_id_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("save_strings", save_str_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("save_particles", particles_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("swmr", swmr_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("swmr_flush_interval", swmr_flush_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("max_file_size", max_file_size_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("events_per_file", events_per_file_, "Ignored: no output file is written.");
+  msg_->DeclareProperty("save_rng_seeds", save_seeds_, "Ignored: no output file is written.");
+}
+
+
+
+NullPersistencyManager::~NullPersistencyManager()
+{
+  delete msg_;
+}
+
+
+
+G4bool NullPersistencyManager::Store(const G4Event* event)
+{
+  if (interacting_evt_) {
+    interacting_evts_++;
+  }
+
+  if (store_steps_) {
+    SaveAllSteppingAction* sa = (SaveAllSteppingAction*)
+      G4RunManager::GetRunManager()->GetUserSteppingAction();
+    sa->Reset();
+  }
+
+  if (!store_evt_) {
+    TrajectoryMap::Clear();
+    return false;
+  }
+
+  saved_evts_++;
+
+  G4TrajectoryContainer* tc = event->GetTrajectoryContainer();
+  if (tc) {
+    for (size_t i=0; i<tc->entries(); ++i) {
+      if (dynamic_cast<Trajectory*>((*tc)[i])) nparticles_++;
+    }
+  }
+
+  WalkHits(event->GetHCofThisEvent());
+
+  TrajectoryMap::Clear();
+  StoreCurrentEvent(true);
+
+  return true;
+}
+
+
+
+void NullPersistencyManager::WalkHits(G4HCofThisEvent* hce)
+{
+  if (!hce) return;
+
+  G4SDManager* sdmgr = G4SDManager::GetSDMpointer();
+  G4HCtable* hct = sdmgr->GetHCtable();
+
+  for (auto i=0; i<hct->entries(); i++) {
+
+    G4String hcname = hct->GetHCname(i);
+    G4String sdname = hct->GetSDname(i);
+    int hcid = sdmgr->GetCollectionID(sdname+"/"+hcname);
+
+    G4VHitsCollection* hc = hce->GetHC(hcid);
+
+    if (hcname == IonizationSD::GetCollectionUniqueName()) {
+      IonizationHitsCollection* hits = dynamic_cast<IonizationHitsCollection*>(hc);
+      if (hits) nihits_ += hits->entries();
+    }
+    else if (hcname == SensorSD::GetCollectionUniqueName()) {
+      SensorHitsCollection* hits = dynamic_cast<SensorHitsCollection*>(hc);
+      if (!hits) continue;
+      for (size_t j=0; j<hits->entries(); j++) {
+        const std::map<G4double, G4int>& wvfm = (*hits)[j]->GetHistogram();
+        for (auto it = wvfm.begin(); it != wvfm.end(); ++it) {
+          nsns_bins_++;
+          nsns_charge_ += it->second;
+        }
+      }
+    }
+  }
+}
+
+
+
+G4bool NullPersistencyManager::Store(const G4Run*)
+{
+  G4cout << "[NullPersistencyManager] Discarded events: " << saved_evts_ << G4endl;
+  if (save_ie_numb_)
+    G4cout << "[NullPersistencyManager] Interacting events: " << interacting_evts_ << G4endl;
+  G4cout << "[NullPersistencyManager] Particles: " << nparticles_
+         << ", ionization hits: " << nihits_
+         << ", sensor time bins: " << nsns_bins_
+         << ", sensor charge: " << nsns_charge_ << G4endl;
+
+  return true;
+}
@@ -0,0 +1,85 @@
+// ----------------------------------------------------------------------------
+// nexus | NullPersistencyManager.h
+//
+// This persistency manager walks through the trajectories and hits of
+// every event, as the default one does, but discards them instead of
+// writing an output file. It is meant to measure the throughput of the
+// simulation itself. A summary with the number of processed hits is
+// printed at the end of the run.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef NULL_PERSISTENCY_MANAGER_H
+#define NULL_PERSISTENCY_MANAGER_H
+
+#include "PersistencyManagerBase.h"
+
+class G4GenericMessenger;
+class G4HCofThisEvent;
+
+
+namespace nexus {
+
+  class NullPersistencyManager: public PersistencyManagerBase
+  {
+  public:
+    NullPersistencyManager();
+    ~NullPersistencyManager();
+
+    virtual G4bool Store(const G4Event*);
+    virtual G4bool Store(const G4Run*);
+    virtual G4bool Store(const G4VPhysicalVolume*);
+
+    virtual G4bool Retrieve(G4Event*&);
+    virtual G4bool Retrieve(G4Run*&);
+    virtual G4bool Retrieve(G4VPhysicalVolume*&);
+
+  public:
+    void OpenFile();
+    void CloseFile();
+
+  private:
+    void WalkHits(G4HCofThisEvent*);
+
+  private:
+    G4GenericMessenger* msg_; ///< User configuration messenger
+
+    // Accepted for compatibility with the default persistency
+    // manager configuration, but not used
+    G4String output_file_;
+    G4String event_type_;
+    G4String start_id_;
+    G4bool save_str_;
+    G4bool particles_;
+    G4bool swmr_;
+    G4int swmr_flush_;
+    G4double max_file_size_;
+    G4int events_per_file_;
+    G4bool save_seeds_;
+
+    int64_t saved_evts_; ///< number of events that would have been saved
+    int64_t interacting_evts_; ///< number of events interacting in ACTIVE
+    int64_t nparticles_; ///< number of particles walked through
+    int64_t nihits_; ///< number of ionization hits walked through
+    int64_t nsns_bins_; ///< number of sensor time bins walked through
+    int64_t nsns_charge_; ///< total charge in the sensor time bins
+  };
+
+
+  // INLINE DEFINITIONS //////////////////////////////////////////////
+
+  inline G4bool NullPersistencyManager::Store(const G4VPhysicalVolume*)
+  { return false; }
+  inline G4bool NullPersistencyManager::Retrieve(G4Event*&)
+  { return false; }
+  inline G4bool NullPersistencyManager::Retrieve(G4Run*&)
+  { return false; }
+  inline G4bool NullPersistencyManager::Retrieve(G4VPhysicalVolume*&)
+  { return false; }
+  inline void NullPersistencyManager::OpenFile() {}
+  inline void NullPersistencyManager::CloseFile() {}
+
+} // namespace nexus
+
+#endif
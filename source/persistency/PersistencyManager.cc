@@ -16,6 +16,8 @@
 #include "NexusApp.h"
 #include "DetectorConstruction.h"
 #include "SaveAllSteppingAction.h"
+#include "ProfilingSteppingAction.h"
+#include "RunTelemetry.h"
 #include "GeometryBase.h"
 #include "HDF5Writer.h"
 #include "PersistencyManagerBase.h"
@@ -29,9 +31,11 @@
 #include <G4HCtable.hh>
 #include <G4RunManager.hh>
 #include <G4Run.hh>
+#include <Randomize.hh>
 
 #include <string>
 #include <sstream>
+#include <iomanip>
 #include <iostream>
 #include <string>
 
@@ -43,11 +47,12 @@ REGISTER_CLASS(PersistencyManager, PersistencyManagerBase)
 
 PersistencyManager::PersistencyManager():
 PersistencyManagerBase(), msg_(0), output_file_("nexus_out"), ready_(false),
-  store_evt_(true), store_steps_(false),
-  interacting_evt_(false), save_ie_numb_(false), event_type_("other"),
+  event_type_("other"),
   saved_evts_(0), interacting_evts_(0), pmt_bin_size_(-1), sipm_bin_size_(-1),
   nevt_(0), start_id_(0), first_evt_(true), h5writer_(0),
-  str_counter_(0), save_str_(true), particles_(true)
+  str_counter_(0), save_str_(true), particles_(true), swmr_(false),
+  swmr_flush_(100), max_file_size_(0.), events_per_file_(0), file_index_(0),
+  save_seeds_(false), event_seed_(0), nstep_names_(0)
 {
   msg_ = new G4GenericMessenger(this, "/nexus/persistency/");
   msg_->DeclareProperty("output_file", output_file_, "Path of output file.");
@@ -59,6 +64,28 @@ PersistencyManagerBase(), msg_(0), output_file_("nexus_out"), ready_(false),
                         "True if volume, process... names are saved as strings.");
   msg_->DeclareProperty("save_particles", particles_,
                         "True if particles table is saved.");
+  msg_->DeclareProperty("swmr", swmr_,
+                        "True if the output file can be read while being written (SWMR mode).");
+  G4GenericMessenger::Command& flush_cmd =
+    msg_->DeclareProperty("swmr_flush_interval", swmr_flush_,
+                          "Number of events between flushes of the output file in SWMR mode.");
+  flush_cmd.SetParameterName("swmr_flush_interval", false);
+  flush_cmd.SetRange("swmr_flush_interval>0");
+
+  G4GenericMessenger::Command& size_cmd =
+    msg_->DeclareProperty("max_file_size", max_file_size_,
+                          "Size (in MB) after which the output continues in a new file (0 = no limit).");
+  size_cmd.SetParameterName("max_file_size", false);
+  size_cmd.SetRange("max_file_size>=0.");
+
+  G4GenericMessenger::Command& evts_cmd =
+    msg_->DeclareProperty("events_per_file", events_per_file_,
+                          "Number of events after which the output continues in a new file (0 = no limit).");
+  evts_cmd.SetParameterName("events_per_file", false);
+  evts_cmd.SetRange("events_per_file>=0");
+
+  msg_->DeclareProperty("save_rng_seeds", save_seeds_,
+                        "True if a random seed is stored per event to replay its detector response.");
 
   init_macro_ = "";
   macros_.clear();
@@ -81,8 +108,19 @@ void PersistencyManager::OpenFile()
   // If the output file was not set yet, do so
   if (!h5writer_) {
     h5writer_ = new HDF5Writer();
-    G4String hdf5file = output_file_ + ".h5";
-    h5writer_->Open(hdf5file, store_steps_, save_str_);
+    h5writer_->SetSWMR(swmr_, swmr_flush_);
+    h5writer_->SetProfile(Profiler() != 0);
+
+    // A new output file (e.g., for every job of the server)
+    // starts its numbering and bookkeeping from scratch
+    saved_evts_ = 0;
+    interacting_evts_ = 0;
+    sns_pos_ids_.clear();
+    nstep_names_ = 0;
+    file_index_ = 0;
+    first_evt_ = true;
+
+    h5writer_->Open(FileName(file_index_), store_steps_, save_str_);
     return;
   } else {
     G4Exception("[PersistencyManager]", "OpenFile()",
@@ -97,12 +135,79 @@ void PersistencyManager::CloseFile()
   if (!h5writer_) return;
 
   h5writer_->Close();
+  delete h5writer_;
+  h5writer_ = 0;
+}
+
+
+
+G4String PersistencyManager::FileName(G4int index) const
+{
+  // Without limits everything goes to a single file
+  if (max_file_size_ <= 0. && events_per_file_ <= 0)
+    return output_file_ + ".h5";
+
+  std::ostringstream name;
+  name << output_file_ << "_" << std::setw(3) << std::setfill('0')
+       << index << ".h5";
+  return name.str();
+}
+
+
+
+G4bool PersistencyManager::FileIsFull() const
+{
+  if (events_per_file_ > 0 && saved_evts_ >= events_per_file_)
+    return true;
+
+  if (max_file_size_ > 0. &&
+      h5writer_->GetFileSize() >= max_file_size_ * 1024. * 1024.)
+    return true;
+
+  return false;
+}
+
+
+
+void PersistencyManager::NextFile()
+{
+  StoreFileInfo();
+  h5writer_->Close();
+
+  // Everything written once per file has to be written again
+  saved_evts_ = 0;
+  interacting_evts_ = 0;
+  sns_pos_ids_.clear();
+  nstep_names_ = 0;
+
+  ++file_index_;
+  h5writer_->Open(FileName(file_index_), store_steps_, save_str_);
+}
+
+
+
+void PersistencyManager::BeginOfEvent()
+{
+  // The seed is drawn before the event starts, and the engine is
+  // reseeded with it, so that the seed (a valid /nexus/random_seed)
+  // reproduces the whole event. It is only drawn on request, so
+  // that the random sequence is not altered otherwise.
+  event_seed_ = 0;
+  if (!save_seeds_) return;
+
+  event_seed_ = uint64_t(G4RandFlat::shootInt(2147483646L)) + 1;
+  G4Random::setTheSeed(long(event_seed_));
 }
 
 
 
 G4bool PersistencyManager::Store(const G4Event* event)
 {
+  // Start a new file only when there is an event to write in it,
+  // so that no empty file is left behind at the end of the run
+  if (store_evt_ && saved_evts_ > 0 && FileIsFull())
+    NextFile();
+
   if (interacting_evt_) {
     interacting_evts_++;
   }
@@ -133,10 +238,16 @@ G4bool PersistencyManager::Store(const G4Event* event)
   }
 
   // Store ionization hits and sensor hits
-  ihits_ = nullptr;
-  hit_map_.clear();
   StoreHits(event->GetHCofThisEvent());
 
+  h5writer_->WriteEventIndex(nevt_, event_seed_);
+
+  h5writer_->Flush();
+
+  // Reset the hit counters of the tracks seen in this event
+  for (auto trackid : hit_tracks_) hit_counts_[trackid] = 0;
+  hit_tracks_.clear();
+
   nevt_++;
 
   TrajectoryMap::Clear();
@@ -258,28 +369,22 @@ void PersistencyManager::StoreIonizationHits(G4VHitsCollection* hc)
     dynamic_cast<IonizationHitsCollection*>(hc);
   if (!hits) return;
 
-  std::string sdname = hits->GetSDname();
+  const G4String& sdname = hits->GetSDname();
   G4int sdname_id = FindStringIDInMap(str_map_, sdname, str_counter_);
 
   for (size_t i=0; i<hits->entries(); i++) {
 
-    IonizationHit* hit = dynamic_cast<IonizationHit*>(hits->GetHit(i));
-    if (!hit) continue;
+    IonizationHit* hit = (*hits)[i];
 
+    // The hit index is a running counter of the hits of each track
     G4int trackid = hit->GetTrackID();
-
-    std::map<G4int, std::vector<G4int>* >::iterator it = hit_map_.find(trackid);
-    if (it != hit_map_.end()) {
-      ihits_ = it->second;
-    } else {
-      ihits_ = new std::vector<G4int>;
-      hit_map_[trackid] = ihits_;
-    }
-
-    ihits_->push_back(1);
+    if (trackid >= (G4int) hit_counts_.size())
+      hit_counts_.resize(2 * trackid + 1, 0);
+    if (hit_counts_[trackid] == 0)
+      hit_tracks_.push_back(trackid);
 
     G4ThreeVector xyz = hit->GetPosition();
-    h5writer_->WriteHitInfo(save_str_, nevt_, trackid,  ihits_->size() - 1,
+    h5writer_->WriteHitInfo(save_str_, nevt_, trackid, hit_counts_[trackid]++,
 			    xyz[0], xyz[1], xyz[2],
 			    hit->GetTime(), hit->GetEnergyDeposit(),
                             sdname.c_str(), sdname_id);
@@ -293,49 +398,33 @@ void PersistencyManager::StoreSensorHits(G4VHitsCollection* hc)
   SensorHitsCollection* hits = dynamic_cast<SensorHitsCollection*>(hc);
   if (!hits) return;
 
-  std::string sdname = hits->GetSDname();
+  const G4String& sdname = hits->GetSDname();
 
-  std::map<G4String, G4double>::const_iterator sensdet_it = sensdet_bin_.find(sdname);
-  if (sensdet_it == sensdet_bin_.end()) {
-    for (size_t j=0; j<hits->entries(); j++) {
-      SensorHit* hit = dynamic_cast<SensorHit*>(hits->GetHit(j));
-      if (!hit) continue;
-      G4double bin_size = hit->GetBinSize();
-      sensdet_bin_[sdname] = bin_size;
-      break;
-    }
+  if ((hits->entries() > 0) && (sensdet_bin_.find(sdname) == sensdet_bin_.end())) {
+    sensdet_bin_[sdname] = (*hits)[0]->GetBinSize();
   }
 
   for (size_t i=0; i<hits->entries(); i++) {
 
-    SensorHit* hit = dynamic_cast<SensorHit*>(hits->GetHit(i));
-    if (!hit) continue;
+    SensorHit* hit = (*hits)[i];
 
-    G4ThreeVector xyz = hit->GetPosition();
     G4double binsize = hit->GetBinSize();
+    unsigned int sns_id = (unsigned int)hit->GetSensorID();
 
     const std::map<G4double, G4int>& wvfm = hit->GetHistogram();
     std::map<G4double, G4int>::const_iterator it;
-    std::vector< std::pair<unsigned int,float> > data;
-    G4double amplitude = 0.;
 
     for (it = wvfm.begin(); it != wvfm.end(); ++it) {
       unsigned int time_bin = (unsigned int)((*it).first/binsize+0.5);
       unsigned int charge = (unsigned int)((*it).second+0.5);
 
-      data.push_back(std::make_pair(time_bin, charge));
-      amplitude = amplitude + (*it).second;
-
-      h5writer_->WriteSensorDataInfo(nevt_, (unsigned int)hit->GetSensorID(),
-                                     time_bin, charge);
+      h5writer_->WriteSensorDataInfo(nevt_, sns_id, time_bin, charge);
     }
 
-    std::vector<G4int>::iterator pos_it =
-      std::find(sns_posvec_.begin(), sns_posvec_.end(), hit->GetSensorID());
-    if (pos_it == sns_posvec_.end()) {
-      h5writer_->WriteSensorPosInfo((unsigned int)hit->GetSensorID(), sdname.c_str(),
+    if (sns_pos_ids_.insert(hit->GetSensorID()).second) {
+      G4ThreeVector xyz = hit->GetPosition();
+      h5writer_->WriteSensorPosInfo(sns_id, sdname.c_str(),
 				    (float)xyz.x(), (float)xyz.y(), (float)xyz.z());
-      sns_posvec_.push_back(hit->GetSensorID());
     }
 
   }
@@ -347,37 +436,50 @@ void PersistencyManager::StoreSteps()
   SaveAllSteppingAction* sa = (SaveAllSteppingAction*)
     G4RunManager::GetRunManager()->GetUserSteppingAction();
 
-  StepContainer<G4String> initial_volumes = sa->get_initial_volumes();
-  StepContainer<G4String>   final_volumes = sa->get_final_volumes  ();
-  StepContainer<G4String>      proc_names = sa->get_proc_names     ();
-
-  StepContainer<G4ThreeVector> initial_poss = sa->get_initial_poss();
-  StepContainer<G4ThreeVector>   final_poss = sa->get_final_poss  ();
-  StepContainer<G4double>             times = sa->get_times       ();
-
-  for (auto it = initial_volumes.begin(); it != initial_volumes.end(); ++it) {
-    std::pair<G4int, G4String> key           = it->first;
-    G4int                      track_id      = key.first;
-    G4String                   particle_name = key.second;
-
-    for (size_t step_id=0; step_id < it->second.size(); ++step_id) {
-      h5writer_->WriteStep(nevt_, track_id, particle_name, step_id,
-                           initial_volumes[key][step_id],
-                             final_volumes[key][step_id],
-                                proc_names[key][step_id],
-                           initial_poss   [key][step_id].x(),
-                           initial_poss   [key][step_id].y(),
-                           initial_poss   [key][step_id].z(),
-                             final_poss   [key][step_id].x(),
-                             final_poss   [key][step_id].y(),
-                             final_poss   [key][step_id].z(),
-                                  times   [key][step_id]);
-    }
+  h5writer_->WriteSteps(nevt_, sa->GetSteps());
+
+  // Store the names interned since the last event
+  const std::vector<G4String>& names = sa->GetNames();
+  for (; nstep_names_ < names.size(); ++nstep_names_) {
+    h5writer_->WriteStepNameInfo(names[nstep_names_].c_str(), nstep_names_);
   }
+
   sa->Reset();
 }
 
 G4bool PersistencyManager::Store(const G4Run*)
+{
+  StoreFileInfo();
+
+  // Final telemetry summary of the run
+  if (const RunTelemetry* telemetry = RunTelemetry::Instance()) {
+    for (const auto& entry : telemetry->GetSummary())
+      h5writer_->WriteRunInfo(entry.first.c_str(), entry.second.c_str());
+  }
+
+  // Report where the time went, if the run was profiled
+  if (const ProfilingSteppingAction* profiler = Profiler()) {
+    profiler->PrintReport();
+    for (const auto& entry : profiler->GetReport())
+      h5writer_->WriteProfile(entry.particle.c_str(), entry.volume.c_str(),
+                              entry.process.c_str(), entry.steps, entry.tracks,
+                              entry.time);
+  }
+
+  return true;
+}
+
+
+
+const ProfilingSteppingAction* PersistencyManager::Profiler() const
+{
+  return dynamic_cast<const ProfilingSteppingAction*>
+    (G4RunManager::GetRunManager()->GetUserSteppingAction());
+}
+
+
+
+void PersistencyManager::StoreFileInfo()
 {
   // Store the event type
   G4String key = "event_type";
@@ -404,7 +506,9 @@ G4bool PersistencyManager::Store(const G4Run*)
                            (std::to_string(it->second/microsecond)+" mus").c_str());
   }
 
-  // Store configuration parameters
+  // Store configuration parameters. The nested macros found on the
+  // way are dropped afterwards, as the next file reads them again.
+  size_t nsecondary = secondary_macros_.size();
   SaveConfigurationInfo(init_macro_);
   for (unsigned long i=0; i<macros_.size(); i++) {
     SaveConfigurationInfo(macros_[i]);
@@ -412,9 +516,13 @@ G4bool PersistencyManager::Store(const G4Run*)
   for (unsigned long i=0; i<delayed_macros_.size(); i++) {
     SaveConfigurationInfo(delayed_macros_[i]);
   }
+  for (unsigned long i=0; i<job_commands_.size(); i++) {
+    SaveConfigurationLine(job_commands_[i]);
+  }
   for (unsigned long i=0; i<secondary_macros_.size(); i++) {
     SaveConfigurationInfo(secondary_macros_[i]);
   }
+  secondary_macros_.resize(nsecondary);
 
   // Store map with string --> int correspondence
   if (!save_str_) {
@@ -427,9 +535,6 @@ G4bool PersistencyManager::Store(const G4Run*)
       h5writer_->WriteStringMapInfo(p.second, p.first);
     }
   }
-
-
-  return true;
 }
 
 void PersistencyManager::SaveConfigurationInfo(G4String file_name)
@@ -439,44 +544,49 @@ void PersistencyManager::SaveConfigurationInfo(G4String file_name)
 
     G4String line;
     std::getline(history, line);
-    if (line[0] == '#')
-      continue;
-
-    std::stringstream ss(line);
-    G4String key, value;
-    std::getline(ss, key, ' ');
-    std::getline(ss, value);
-
-    if (key != "") {
-      auto found_binning = key.find("binning");
-      auto found_other_macro = key.find("/control/execute");
-      if ((found_binning == std::string::npos) &&
-          (found_other_macro == std::string::npos)) {
-        if (key[0] == '\n') {
-          key.erase(0, 1);
-        }
-	h5writer_->WriteRunInfo(key.c_str(), value.c_str());
-      }
+    SaveConfigurationLine(line);
+  }
+
+  history.close();
+}
+
+
 
-      if (found_other_macro != std::string::npos)
-        secondary_macros_.push_back(value);
+void PersistencyManager::SaveConfigurationLine(G4String line)
+{
+  if (line[0] == '#')
+    return;
+
+  std::stringstream ss(line);
+  G4String key, value;
+  std::getline(ss, key, ' ');
+  std::getline(ss, value);
+
+  if (key != "") {
+    auto found_binning = key.find("binning");
+    auto found_other_macro = key.find("/control/execute");
+    if ((found_binning == std::string::npos) &&
+        (found_other_macro == std::string::npos)) {
+      if (key[0] == '\n') {
+        key.erase(0, 1);
+      }
+      h5writer_->WriteRunInfo(key.c_str(), value.c_str());
     }
 
+    if (found_other_macro != std::string::npos)
+      secondary_macros_.push_back(value);
   }
-
-  history.close();
 }
 
 
 G4int PersistencyManager::FindStringIDInMap(std::map<G4String, G4int>& vmap,
-                                            G4String vol, G4int& counter)
+                                            const G4String& vol, G4int& counter)
 {
   auto found = vmap.find(vol);
   if (found != vmap.end()) {
     return found->second;
   } else {
     vmap[vol] = counter;
-    counter++;
-    return vmap[vol];
+    return counter++;
   }
 }
@@ -13,7 +13,9 @@
 #include "PersistencyManagerBase.h"
 
 #include <G4VPersistencyManager.hh>
+#include <cstdint>
 #include <map>
+#include <set>
 #include <vector>
 
 
@@ -25,6 +27,7 @@ class G4VHitsCollection;
 namespace nexus {
   class HDF5Writer;
   class IonizationHit;
+  class ProfilingSteppingAction;
 }
 
 namespace nexus {
@@ -40,12 +43,6 @@ namespace nexus {
    // static void Initialize(G4String init_macro, std::vector<G4String>& macros,
     //                       std::vector<G4String>& delayed_macros);
 
-    /// Set whether to store or not the current event
-    void StoreCurrentEvent(G4bool);
-    void InteractingEvent(G4bool);
-    void StoreSteps(G4bool);
-    void SaveNumbOfInteractingEvents(G4bool);
-
     ///
     virtual G4bool Store(const G4Event*);
     virtual G4bool Store(const G4Run*);
@@ -59,6 +56,8 @@ namespace nexus {
     void OpenFile();
     void CloseFile();
 
+    void BeginOfEvent();
+
 
   private:
     void StoreTrajectories(G4TrajectoryContainer*);
@@ -68,8 +67,21 @@ namespace nexus {
     void StoreSteps();
 
     void SaveConfigurationInfo(G4String history);
-
-    G4int FindStringIDInMap(std::map<G4String, G4int>& vmap, G4String vol, G4int& counter);
+    /// Store a "command value" line in the configuration table
+    void SaveConfigurationLine(G4String line);
+
+    /// Write the run information that makes an output file self-contained
+    void StoreFileInfo();
+    /// Profiling stepping action in use, if any
+    const ProfilingSteppingAction* Profiler() const;
+    /// Name of the output file with the given index
+    G4String FileName(G4int index) const;
+    /// True if the current output file has reached any of its limits
+    G4bool FileIsFull() const;
+    /// Close the current output file and open the next one
+    void NextFile();
+
+    G4int FindStringIDInMap(std::map<G4String, G4int>& vmap, const G4String& vol, G4int& counter);
 
     void SetStartID(G4String& s);
 
@@ -80,15 +92,11 @@ namespace nexus {
 
     G4String output_file_; ///< Path of output file
     G4bool ready_;     ///< Is the PersistencyManager ready to go?
-    G4bool store_evt_; ///< Should we store the current event?
-    G4bool store_steps_; ///< Should we store the steps for the current event?
-    G4bool interacting_evt_; ///< Has the current event interacted in ACTIVE?
-    G4bool save_ie_numb_; ///< Should we save the number of interacting events in the configuration table?
 
     G4String event_type_; ///< event type: bb0nu, bb2nu, background or not set
 
-    int64_t saved_evts_; ///< number of events to be saved
-    int64_t interacting_evts_; ///< number of events interacting in ACTIVE
+    int64_t saved_evts_; ///< number of events saved in the current file
+    int64_t interacting_evts_; ///< number of events interacting in ACTIVE in the current file
     G4double pmt_bin_size_, sipm_bin_size_; ///< bin width of sensors
 
     int64_t nevt_; ///< Event ID
@@ -97,14 +105,22 @@ namespace nexus {
 
     HDF5Writer* h5writer_;  ///< Event writer to hdf5 file
 
-    std::vector<G4int>* ihits_;
-    std::map<G4int, std::vector<G4int>* > hit_map_;
-    std::vector<G4int> sns_posvec_;
+    std::vector<G4int> hit_counts_; ///< Number of hits per track ID, reused across events
+    std::vector<G4int> hit_tracks_; ///< Track IDs with hits in the current event
+    std::set<G4int> sns_pos_ids_; ///< IDs of the sensors whose position has been stored
     std::map<G4String, G4int> str_map_; ///< map with string-int correspondence
 
     G4int str_counter_; ///< incrementing counter for string map
     G4bool save_str_; ///< Should we store strings as volume names etc.?
     G4bool particles_; ///< Store particles table
+    G4bool swmr_; ///< Open the output file in single-writer/multiple-reader mode
+    G4int swmr_flush_; ///< Events between flushes of the output file in SWMR mode
+    G4double max_file_size_; ///< Size in MB above which a new output file is started
+    G4int events_per_file_; ///< Number of events after which a new output file is started
+    G4int file_index_; ///< Index of the current output file
+    G4bool save_seeds_; ///< Store a random seed per event to replay its detector response
+    uint64_t event_seed_; ///< Seed of the current event, if stored
+    size_t nstep_names_; ///< Number of step names already written
 
     std::map<G4String, G4double> sensdet_bin_;
   };
@@ -112,14 +128,6 @@ namespace nexus {
 
   // INLINE DEFINITIONS //////////////////////////////////////////////
 
-  inline void PersistencyManager::StoreCurrentEvent(G4bool sce)
-  { store_evt_ = sce; }
-  inline void PersistencyManager::StoreSteps(G4bool ss)
-  { store_steps_ = ss; }
-  inline void PersistencyManager::InteractingEvent(G4bool ie)
-  { interacting_evt_ = ie; }
-  inline void PersistencyManager::SaveNumbOfInteractingEvents(G4bool sie)
-  {save_ie_numb_ = sie;}
   inline G4bool PersistencyManager::Store(const G4VPhysicalVolume*)
   { return false; }
   inline G4bool PersistencyManager::Retrieve(G4Event*&)
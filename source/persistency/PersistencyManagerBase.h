@@ -14,13 +14,31 @@ class PersistencyManagerBase: public G4VPersistencyManager
     virtual void OpenFile() = 0;
     virtual void CloseFile() = 0;
 
+    /// Called before any random number of each event is drawn
+    virtual void BeginOfEvent() {}
+
+    /// Set whether to store or not the current event
+    void StoreCurrentEvent(G4bool sce) { store_evt_ = sce; }
+    void InteractingEvent(G4bool ie) { interacting_evt_ = ie; }
+    void StoreSteps(G4bool ss) { store_steps_ = ss; }
+    void SaveNumbOfInteractingEvents(G4bool sie) { save_ie_numb_ = sie; }
+
     G4String init_macro_;
     std::vector<G4String> macros_;
     std::vector<G4String> delayed_macros_;
+    std::vector<G4String> job_commands_; ///< Commands of the current server job, if any
 
     inline void SetMacros(G4String init, std::vector<G4String> mcrs, std::vector<G4String> delayed)
     {init_macro_ = init; macros_ = mcrs; delayed_macros_ = delayed;}
 
+    inline void SetJobCommands(std::vector<G4String> cmds)
+    {job_commands_ = cmds;}
+
+  protected:
+    G4bool store_evt_ = true; ///< Should we store the current event?
+    G4bool store_steps_ = false; ///< Should we store the steps for the current event?
+    G4bool interacting_evt_ = false; ///< Has the current event interacted in ACTIVE?
+    G4bool save_ie_numb_ = false; ///< Should we save the number of interacting events in the configuration table?
 
   };
 
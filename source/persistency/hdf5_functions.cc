@@ -17,6 +17,7 @@ hsize_t createRunType()
   hsize_t memtype = H5Tcreate (H5T_COMPOUND, sizeof (run_info_t));
   H5Tinsert (memtype, "param_key" , HOFFSET (run_info_t, param_key), strtype);
   H5Tinsert (memtype, "param_value" , HOFFSET (run_info_t, param_value), strtype);
+  H5Tclose(strtype);
   return memtype;
 }
 
@@ -53,6 +54,7 @@ hsize_t createHitInfoType(bool str)
   }
   H5Tinsert (memtype, "particle_id", HOFFSET (hit_info_t, particle_id), H5T_NATIVE_INT);
   H5Tinsert (memtype, "hit_id", HOFFSET (hit_info_t, hit_id), H5T_NATIVE_INT);
+  H5Tclose(strtype);
   return memtype;
 }
 
@@ -109,6 +111,7 @@ hsize_t createParticleInfoType(bool str)
     H5Tinsert (memtype, "creator_proc", HOFFSET (particle_info_t, creator_proc), H5T_NATIVE_INT);
     H5Tinsert (memtype, "final_proc", HOFFSET (particle_info_t, final_proc), H5T_NATIVE_INT);
   }
+  H5Tclose(strtype);
   return memtype;
 }
 
@@ -125,27 +128,22 @@ hsize_t createSensorPosType()
   H5Tinsert (memtype, "x", HOFFSET (sns_pos_t, x), H5T_NATIVE_FLOAT);
   H5Tinsert (memtype, "y", HOFFSET (sns_pos_t, y), H5T_NATIVE_FLOAT);
   H5Tinsert (memtype, "z", HOFFSET (sns_pos_t, z), H5T_NATIVE_FLOAT);
+  H5Tclose(strtype);
   return memtype;
 }
 
 
 hsize_t createStepType()
 {
-  hid_t strtype = H5Tcopy(H5T_C_S1);
-  H5Tset_size (strtype, STRLEN);
-
-  hid_t proc_strtype = H5Tcopy(H5T_C_S1);
-  H5Tset_size (proc_strtype, STRLEN);
-
   //Create compound datatype for the table
   hsize_t memtype = H5Tcreate (H5T_COMPOUND, sizeof(step_info_t));
   H5Tinsert (memtype, "event_id"      , HOFFSET(step_info_t, event_id      ), H5T_NATIVE_INT64);
   H5Tinsert (memtype, "particle_id"   , HOFFSET(step_info_t, particle_id   ), H5T_NATIVE_INT  );
-  H5Tinsert (memtype, "particle_name" , HOFFSET(step_info_t, particle_name ), strtype         );
+  H5Tinsert (memtype, "particle_name" , HOFFSET(step_info_t, particle_name ), H5T_NATIVE_INT  );
   H5Tinsert (memtype, "step_id"       , HOFFSET(step_info_t, step_id       ), H5T_NATIVE_INT  );
-  H5Tinsert (memtype, "initial_volume", HOFFSET(step_info_t, initial_volume), proc_strtype    );
-  H5Tinsert (memtype, "final_volume"  , HOFFSET(step_info_t, final_volume  ), proc_strtype    );
-  H5Tinsert (memtype, "proc_name"     , HOFFSET(step_info_t, proc_name     ), proc_strtype    );
+  H5Tinsert (memtype, "initial_volume", HOFFSET(step_info_t, initial_volume), H5T_NATIVE_INT  );
+  H5Tinsert (memtype, "final_volume"  , HOFFSET(step_info_t, final_volume  ), H5T_NATIVE_INT  );
+  H5Tinsert (memtype, "proc_name"     , HOFFSET(step_info_t, proc_name     ), H5T_NATIVE_INT  );
   H5Tinsert (memtype, "initial_x"     , HOFFSET(step_info_t, initial_x     ), H5T_NATIVE_FLOAT);
   H5Tinsert (memtype, "initial_y"     , HOFFSET(step_info_t, initial_y     ), H5T_NATIVE_FLOAT);
   H5Tinsert (memtype, "initial_z"     , HOFFSET(step_info_t, initial_z     ), H5T_NATIVE_FLOAT);
@@ -166,6 +164,38 @@ hsize_t createStringMapType()
   hsize_t memtype = H5Tcreate (H5T_COMPOUND, sizeof(string_map_t));
   H5Tinsert (memtype, "name"   , HOFFSET(string_map_t, name   ), strtype);
   H5Tinsert (memtype, "name_id" , HOFFSET(string_map_t, name_id ), H5T_NATIVE_INT);
+  H5Tclose(strtype);
+  return memtype;
+}
+
+
+hsize_t createEventIndexType()
+{
+  //Create compound datatype for the table
+  hsize_t memtype = H5Tcreate (H5T_COMPOUND, sizeof(event_index_t));
+  H5Tinsert (memtype, "event_id",        HOFFSET(event_index_t, event_id),        H5T_NATIVE_INT64);
+  H5Tinsert (memtype, "hits_first",      HOFFSET(event_index_t, hits_first),      H5T_NATIVE_UINT64);
+  H5Tinsert (memtype, "hits_count",      HOFFSET(event_index_t, hits_count),      H5T_NATIVE_UINT64);
+  H5Tinsert (memtype, "particles_first", HOFFSET(event_index_t, particles_first), H5T_NATIVE_UINT64);
+  H5Tinsert (memtype, "particles_count", HOFFSET(event_index_t, particles_count), H5T_NATIVE_UINT64);
+  H5Tinsert (memtype, "rng_seed",        HOFFSET(event_index_t, rng_seed),        H5T_NATIVE_UINT64);
+  return memtype;
+}
+
+hsize_t createProfileType()
+{
+  hid_t strtype = H5Tcopy(H5T_C_S1);
+  H5Tset_size (strtype, STRLEN);
+
+  //Create compound datatype for the table
+  hsize_t memtype = H5Tcreate (H5T_COMPOUND, sizeof(profile_t));
+  H5Tinsert (memtype, "particle", HOFFSET(profile_t, particle), strtype);
+  H5Tinsert (memtype, "volume",   HOFFSET(profile_t, volume),   strtype);
+  H5Tinsert (memtype, "process",  HOFFSET(profile_t, process),  strtype);
+  H5Tinsert (memtype, "steps",    HOFFSET(profile_t, steps),    H5T_NATIVE_UINT64);
+  H5Tinsert (memtype, "tracks",   HOFFSET(profile_t, tracks),   H5T_NATIVE_UINT64);
+  H5Tinsert (memtype, "time",     HOFFSET(profile_t, time),     H5T_NATIVE_DOUBLE);
+  H5Tclose(strtype);
   return memtype;
 }
 
@@ -224,68 +254,6 @@ void writeRun(run_info_t* runData, hid_t dataset, hid_t memtype, hsize_t counter
 }
 
 
-void writeSnsData(sns_data_t* snsData, hid_t dataset, hid_t memtype, hsize_t counter)
-{
-  hid_t memspace, file_space;
-  //Create memspace for one more row
-  const hsize_t n_dims = 1;
-  hsize_t dims[n_dims] = {1};
-  memspace = H5Screate_simple(n_dims, dims, NULL);
-
-  //Extend dataset
-  dims[0] = counter+1;
-  H5Dset_extent(dataset, dims);
-
-  //Write waveforms
-  file_space = H5Dget_space(dataset);
-  hsize_t start[1] = {counter};
-  hsize_t count[1] = {1};
-  H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
-  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, snsData);
-  H5Sclose(file_space);
-  H5Sclose(memspace);
-}
-
-void writeHit(hit_info_t* hitInfo, hid_t dataset, hid_t memtype, hsize_t counter)
-{
-  hid_t memspace, file_space;
-
-  const hsize_t n_dims = 1;
-  hsize_t dims[n_dims] = {1};
-  memspace = H5Screate_simple(n_dims, dims, NULL);
-
-  dims[0] = counter+1;
-  H5Dset_extent(dataset, dims);
-
-  file_space = H5Dget_space(dataset);
-  hsize_t start[1] = {counter};
-  hsize_t count[1] = {1};
-  H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
-  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, hitInfo);
-  H5Sclose(file_space);
-  H5Sclose(memspace);
-}
-
-void writeParticle(particle_info_t* particleInfo, hid_t dataset, hid_t memtype, hsize_t counter)
-{
-  hid_t memspace, file_space;
-
-  const hsize_t n_dims = 1;
-  hsize_t dims[n_dims] = {1};
-  memspace = H5Screate_simple(n_dims, dims, NULL);
-
-  dims[0] = counter+1;
-  H5Dset_extent(dataset, dims);
-
-  file_space = H5Dget_space(dataset);
-  hsize_t start[1] = {counter};
-  hsize_t count[1] = {1};
-  H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
-  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, particleInfo);
-  H5Sclose(file_space);
-  H5Sclose(memspace);
-}
-
 void writeSnsPos(sns_pos_t* snsPos, hid_t dataset, hid_t memtype, hsize_t counter)
 {
   hid_t memspace, file_space;
@@ -308,7 +276,7 @@ void writeSnsPos(sns_pos_t* snsPos, hid_t dataset, hid_t memtype, hsize_t counte
   H5Sclose(memspace);
 }
 
-void writeStep(step_info_t* step, hid_t dataset, hid_t memtype, hsize_t counter)
+void writeStringMap(string_map_t* strmap, hid_t dataset, hid_t memtype, hsize_t counter)
 {
   hid_t memspace, file_space;
 
@@ -323,27 +291,29 @@ void writeStep(step_info_t* step, hid_t dataset, hid_t memtype, hsize_t counter)
   hsize_t start[1] = {counter};
   hsize_t count[1] = {1};
   H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
-  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, step);
+  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, strmap);
   H5Sclose(file_space);
   H5Sclose(memspace);
 }
 
-void writeStringMap(string_map_t* strmap, hid_t dataset, hid_t memtype, hsize_t counter)
+void writeRows(const void* rows, hsize_t nrows, hid_t dataset, hid_t memtype, hsize_t counter)
 {
+  if (nrows == 0) return;
+
   hid_t memspace, file_space;
 
   const hsize_t n_dims = 1;
-  hsize_t dims[n_dims] = {1};
+  hsize_t dims[n_dims] = {nrows};
   memspace = H5Screate_simple(n_dims, dims, NULL);
 
-  dims[0] = counter + 1;
+  dims[0] = counter + nrows;
   H5Dset_extent(dataset, dims);
 
   file_space = H5Dget_space(dataset);
   hsize_t start[1] = {counter};
-  hsize_t count[1] = {1};
+  hsize_t count[1] = {nrows};
   H5Sselect_hyperslab(file_space, H5S_SELECT_SET, start, NULL, count, NULL);
-  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, strmap);
+  H5Dwrite(dataset, memtype, memspace, file_space, H5P_DEFAULT, rows);
   H5Sclose(file_space);
   H5Sclose(memspace);
 }
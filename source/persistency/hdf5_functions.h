@@ -11,6 +11,7 @@
 
 #include <hdf5.h>
 #include <iostream>
+#include <vector>
 
 #define CONFLEN 300
 #define STRLEN 100
@@ -84,11 +85,11 @@
   typedef struct{
     int64_t event_id;
     int32_t particle_id;
-    char    particle_name[STRLEN];
+    int32_t particle_name;
     int     step_id;
-    char    initial_volume[STRLEN];
-    char      final_volume[STRLEN];
-    char         proc_name[STRLEN];
+    int32_t initial_volume;
+    int32_t   final_volume;
+    int32_t      proc_name;
     float   initial_x;
     float   initial_y;
     float   initial_z;
@@ -98,11 +99,60 @@
     float        time;
   } step_info_t;
 
+  // Column-wise (struct-of-arrays) buffer of the steps of an event,
+  // gathered into step_info_t rows when the event is written
+  struct step_columns_t{
+    std::vector<int32_t> particle_id;
+    std::vector<int32_t> particle_name;
+    std::vector<int32_t> step_id;
+    std::vector<int32_t> initial_volume;
+    std::vector<int32_t>   final_volume;
+    std::vector<int32_t>      proc_name;
+    std::vector<float>   initial_x;
+    std::vector<float>   initial_y;
+    std::vector<float>   initial_z;
+    std::vector<float>     final_x;
+    std::vector<float>     final_y;
+    std::vector<float>     final_z;
+    std::vector<float>        time;
+
+    size_t size() const { return time.size(); }
+
+    // Empty the columns, keeping their capacity for the next event
+    void clear() {
+      particle_id.clear(); particle_name.clear(); step_id.clear();
+      initial_volume.clear(); final_volume.clear(); proc_name.clear();
+      initial_x.clear(); initial_y.clear(); initial_z.clear();
+      final_x.clear(); final_y.clear(); final_z.clear(); time.clear();
+    }
+  };
+
 typedef struct{
   char name[STRLEN];
   int32_t name_id;
 } string_map_t;
 
+  // Rows of the hits and particles tables belonging to each event,
+  // and the seed to reproduce its detector response
+  typedef struct{
+    int64_t  event_id;
+    uint64_t hits_first;
+    uint64_t hits_count;
+    uint64_t particles_first;
+    uint64_t particles_count;
+    uint64_t rng_seed;
+  } event_index_t;
+
+  // Steps, tracks and time spent per particle, volume and process
+  typedef struct{
+    char     particle[STRLEN];
+    char     volume[STRLEN];
+    char     process[STRLEN];
+    uint64_t steps;
+    uint64_t tracks;
+    double   time;
+  } profile_t;
+
   hsize_t createRunType();
   hsize_t createSensorDataType();
   hsize_t createHitInfoType(bool str);
@@ -110,16 +160,15 @@ typedef struct{
   hsize_t createSensorPosType();
   hsize_t createStepType();
   hsize_t createStringMapType();
+  hsize_t createEventIndexType();
+  hsize_t createProfileType();
 
   hid_t createTable(hid_t group, std::string& table_name, hsize_t memtype);
   hid_t createGroup(hid_t file, std::string& groupName);
 
   void writeRun(run_info_t* runData, hid_t dataset, hid_t memtype, hsize_t counter);
-  void writeSnsData(sns_data_t* snsData, hid_t dataset, hid_t memtype, hsize_t counter);
-  void writeHit(hit_info_t* hitInfo, hid_t dataset, hid_t memtype, hsize_t counter);
-  void writeParticle(particle_info_t* particleInfo, hid_t dataset, hid_t memtype, hsize_t counter);
   void writeSnsPos(sns_pos_t* snsPos, hid_t dataset, hid_t memtype, hsize_t counter);
-  void writeStep(step_info_t* step, hid_t dataset, hid_t memtype, hsize_t counter);
+  void writeRows(const void* rows, hsize_t nrows, hid_t dataset, hid_t memtype, hsize_t counter);
   void writeStringMap(string_map_t* strmap, hid_t dataset, hid_t memtype, hsize_t counter);
 
 
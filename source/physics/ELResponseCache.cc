@@ -0,0 +1,303 @@
+// ----------------------------------------------------------------------------
+// nexus | ELResponseCache.cc
+//
+// Sensor response to the EL light, learned during the simulation for the
+// cells of a grid in the (x, y) plane. The photons of the first electrons
+// reaching each cell are tracked, and their detections are counted per
+// sensor. Once enough electrons have been seen in a cell in the events
+// already completed, the response to the next ones is sampled from the
+// learned detection probabilities.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "ELResponseCache.h"
+
+#include "BaseDriftField.h"
+#include "LightTableHits.h"
+#include "SensorHit.h"
+
+#include <G4OpticalPhoton.hh>
+#include <G4Track.hh>
+#include <G4EventManager.hh>
+#include <G4Event.hh>
+#include <G4SystemOfUnits.hh>
+#include <CLHEP/Random/RandBinomial.h>
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+
+namespace nexus {
+
+
+  ELResponseCache* ELResponseCache::learning_ = 0;
+
+
+
+  ELResponseCache::ELResponseCache(G4double cell_size, G4int min_electrons,
+                                   const G4String& filename):
+    cell_size_(cell_size), min_electrons_(min_electrons), filename_(filename),
+    hits_(0), event_id_(-1)
+  {
+    if (cell_size_ <= 0. || min_electrons_ < 1) {
+      G4Exception("[ELResponseCache]", "ELResponseCache()", FatalException,
+                  "The cell size and the number of learning electrons must be positive.");
+    }
+
+    std::ifstream cached(filename_);
+    if (cached.good()) Load();
+    cached.close();
+
+    // The sensors are resolved as they show up, since the
+    // cache is created once the geometry has been built
+    hits_ = new LightTableHits(sensors_);
+
+    learning_ = this;
+  }
+
+
+
+  ELResponseCache::~ELResponseCache()
+  {
+    // The photons of the last event have all been tracked by now
+    CommitLearning();
+    Save();
+    learning_ = 0;
+    delete hits_;
+  }
+
+
+
+  G4long ELResponseCache::FindCell(const G4ThreeVector& position) const
+  {
+    return CellKey(G4long(std::floor(position.x() / cell_size_)),
+                   G4long(std::floor(position.y() / cell_size_)));
+  }
+
+
+
+  G4long ELResponseCache::CellKey(G4long ix, G4long iy)
+  {
+    return G4long((uint64_t(ix) << 32) | uint32_t(iy));
+  }
+
+
+
+  G4bool ELResponseCache::IsConverged(G4long cell) const
+  {
+    auto it = cells_.find(cell);
+    return (it != cells_.end() && it->second.electrons >= min_electrons_);
+  }
+
+
+
+  void ELResponseCache::Learn(G4long cell, const G4Track& electron, G4double num_photons)
+  {
+    CheckEvent();
+
+    // The electron only counts once its photons have been tracked,
+    // which is not until the end of the event in lazy emission mode
+    Cell& c = cells_[cell];
+    if (c.pending_electrons == 0) learning_cells_.push_back(cell);
+    c.pending_electrons += 1;
+    c.pending_photons   += num_photons;
+
+    ancestor_[electron.GetTrackID()] = cell;
+  }
+
+
+
+  void ELResponseCache::RegisterTrack(const G4Track* track)
+  {
+    static auto opticalphoton = G4OpticalPhoton::Definition();
+    if (track->GetParticleDefinition() != opticalphoton) return;
+
+    CheckEvent();
+
+    // EL photons and their reemissions (wavelength shifting)
+    // inherit the cell of their parent
+    auto parent = ancestor_.find(track->GetParentID());
+    if (parent != ancestor_.end())
+      ancestor_[track->GetTrackID()] = parent->second;
+  }
+
+
+
+  void ELResponseCache::RecordDetection(const G4Track& track, const G4String& sd_name,
+                                        const SensorHit* hit, G4int counts)
+  {
+    auto it = ancestor_.find(track.GetTrackID());
+    if (it == ancestor_.end()) return;
+
+    Cell& cell = cells_[it->second];
+    if (cell.frozen) return;
+
+    G4int isensor = SensorIndex(sd_name, hit->GetSensorID(), hit->GetPosition());
+    cell.detected[isensor] += counts;
+  }
+
+
+
+  void ELResponseCache::Sample(G4long cell, G4int num_photons, BaseDriftField* field,
+                               const G4LorentzVector& initial_position,
+                               const G4LorentzVector& final_position)
+  {
+    Cell& c = cells_[cell];
+
+    // The probabilities are frozen as soon as they are used
+    if (!c.frozen) {
+      for (const auto& detected : c.detected)
+        c.probs.push_back({detected.first, detected.second / c.photons});
+      c.frozen = true;
+    }
+
+    G4HCofThisEvent* hce =
+      G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetHCofThisEvent();
+
+    // Multinomial sampling of the detections, as a sequence of binomials
+    // for the photons not assigned yet. The optical transit time is
+    // negligible compared to the emission time along the EL gap.
+    G4long remaining = num_photons;
+    G4double remaining_prob = 1.;
+
+    for (const auto& prob : c.probs) {
+      if (remaining == 0) break;
+
+      G4double p = (prob.second < remaining_prob) ? prob.second / remaining_prob : 1.;
+      G4long counts = G4long(CLHEP::RandBinomial::shoot(remaining, p));
+      remaining      -= counts;
+      remaining_prob -= prob.second;
+      if (counts == 0) continue;
+
+      SensorHit* hit = hits_->GetHit(prob.first, hce);
+      if (!hit) continue;
+
+      for (G4long i=0; i<counts; ++i)
+        hit->Fill(field->GeneratePointAlongDriftLine(initial_position, final_position).t());
+    }
+  }
+
+
+
+  G4int ELResponseCache::SensorIndex(const G4String& sd_name, G4int id,
+                                     const G4ThreeVector& position)
+  {
+    auto key = std::make_pair(sd_name, id);
+    auto it = sensor_index_.find(key);
+    if (it != sensor_index_.end()) return it->second;
+
+    G4int index = sensors_.size();
+    sensors_.push_back({id, sd_name, position});
+    sensor_index_[key] = index;
+    return index;
+  }
+
+
+
+  void ELResponseCache::CheckEvent()
+  {
+    G4int event_id = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+    if (event_id != event_id_) {
+      CommitLearning();
+      ancestor_.clear();
+      event_id_ = event_id;
+    }
+  }
+
+
+
+  void ELResponseCache::CommitLearning()
+  {
+    for (G4long key : learning_cells_) {
+      Cell& cell = cells_[key];
+      cell.electrons += cell.pending_electrons;
+      cell.photons   += cell.pending_photons;
+      cell.pending_electrons = 0;
+      cell.pending_photons   = 0.;
+    }
+    learning_cells_.clear();
+  }
+
+
+
+  void ELResponseCache::Save() const
+  {
+    std::ofstream out(filename_);
+    if (!out.is_open()) {
+      G4Exception("[ELResponseCache]", "Save()", JustWarning,
+                  ("Could not write the EL response cache to " + filename_).c_str());
+      return;
+    }
+
+    out << "cell_size," << cell_size_/mm << "\n";
+
+    for (size_t i=0; i<sensors_.size(); ++i) {
+      const LightTable::Sensor& sensor = sensors_[i];
+      out << "sensor," << i << "," << sensor.sd_name << "," << sensor.id << ","
+          << sensor.position.x()/mm << "," << sensor.position.y()/mm << ","
+          << sensor.position.z()/mm << "\n";
+    }
+
+    for (const auto& cell : cells_) {
+      G4long ix = G4int(uint64_t(cell.first) >> 32);
+      G4long iy = G4int(uint32_t(cell.first));
+      out << "cell," << ix << "," << iy << "," << cell.second.electrons << ","
+          << cell.second.photons << "\n";
+      for (const auto& detected : cell.second.detected)
+        out << "detected," << ix << "," << iy << "," << detected.first << ","
+            << detected.second << "\n";
+    }
+
+    out.close();
+  }
+
+
+
+  void ELResponseCache::Load()
+  {
+    std::ifstream in(filename_);
+
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream ss(line);
+      std::vector<std::string> fields;
+      std::string field;
+      while (std::getline(ss, field, ',')) fields.push_back(field);
+      if (fields.empty()) continue;
+
+      const std::string& header = fields[0];
+
+      if (header == "cell_size" && fields.size() == 2) {
+        // The cells are only meaningful for the grid they were learned with
+        if (std::abs(std::stod(fields[1])*mm - cell_size_) > 1.e-6*mm) {
+          G4Exception("[ELResponseCache]", "Load()", FatalException,
+                      ("The EL response cache " + filename_ +
+                       " was learned with a different cell size.").c_str());
+        }
+      }
+      else if (header == "sensor" && fields.size() == 7) {
+        G4ThreeVector position(std::stod(fields[4])*mm, std::stod(fields[5])*mm,
+                               std::stod(fields[6])*mm);
+        SensorIndex(fields[2], std::stoi(fields[3]), position);
+      }
+      else if (header == "cell" && fields.size() == 5) {
+        Cell& cell = cells_[CellKey(std::stol(fields[1]), std::stol(fields[2]))];
+        cell.electrons = std::stol(fields[3]);
+        cell.photons   = std::stod(fields[4]);
+      }
+      else if (header == "detected" && fields.size() == 5) {
+        cells_[CellKey(std::stol(fields[1]), std::stol(fields[2]))].detected[std::stoi(fields[3])] = std::stod(fields[4]);
+      }
+    }
+
+    in.close();
+
+    G4cout << "[ELResponseCache] " << cells_.size() << " cells read from "
+           << filename_ << G4endl;
+  }
+
+
+} // end namespace nexus
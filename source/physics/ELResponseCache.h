@@ -0,0 +1,123 @@
+// ----------------------------------------------------------------------------
+// nexus | ELResponseCache.h
+//
+// Sensor response to the EL light, learned during the simulation for the
+// cells of a grid in the (x, y) plane. The photons of the first electrons
+// reaching each cell are tracked, and their detections are counted per
+// sensor. Once enough electrons have been seen in a cell in the events
+// already completed, the response to the next ones is sampled from the
+// learned detection probabilities.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef EL_RESPONSE_CACHE_H
+#define EL_RESPONSE_CACHE_H
+
+#include "LightTable.h"
+
+#include <G4LorentzVector.hh>
+
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+class G4Track;
+
+
+namespace nexus {
+
+  class BaseDriftField;
+  class LightTableHits;
+  class SensorHit;
+
+  class ELResponseCache
+  {
+  public:
+    /// Constructor. The cache is read from the given file if it exists.
+    ELResponseCache(G4double cell_size, G4int min_electrons,
+                    const G4String& filename);
+    /// Destructor. The cache is saved to its file.
+    ~ELResponseCache();
+
+    /// Cache whose response is being learned, if any. The stacking
+    /// action and sensitive detectors report the photons to it.
+    static ELResponseCache* Learning();
+
+    /// Cell of the grid containing the given position
+    G4long FindCell(const G4ThreeVector&) const;
+
+    /// True if enough electrons have been seen in the cell
+    G4bool IsConverged(G4long cell) const;
+
+    /// Register an electron whose EL photons are
+    /// tracked to learn the response of the cell
+    void Learn(G4long cell, const G4Track& electron, G4double num_photons);
+
+    /// Follow the photons descending from a learning electron
+    void RegisterTrack(const G4Track*);
+
+    /// Count the detection of an optical photon by a sensor
+    void RecordDetection(const G4Track&, const G4String& sd_name,
+                         const SensorHit*, G4int counts);
+
+    /// Add to the sensor hits the detections of the photons emitted
+    /// along an EL step, sampled from the response of its cell
+    void Sample(G4long cell, G4int num_photons, BaseDriftField*,
+                const G4LorentzVector& initial_position,
+                const G4LorentzVector& final_position);
+
+  private:
+    void Load();
+    void Save() const;
+
+    /// Index of a sensor, which is added if it is not known yet
+    G4int SensorIndex(const G4String& sd_name, G4int id,
+                      const G4ThreeVector& position);
+
+    /// Forget the photons of the previous event, and add the
+    /// learning electrons of that event to their cells
+    void CheckEvent();
+
+    /// Add the learning electrons of the current event to their cells
+    void CommitLearning();
+
+  private:
+    struct Cell {
+      G4long electrons = 0; ///< Electrons whose photons have been tracked
+      G4double photons = 0.; ///< Photons emitted by those electrons
+      G4long pending_electrons = 0; ///< Learning electrons of the current event
+      G4double pending_photons = 0.; ///< Photons emitted by those electrons
+      std::unordered_map<G4int, G4double> detected; ///< Detections per sensor
+      G4bool frozen = false; ///< The response is no longer learned
+      std::vector<std::pair<G4int, G4double>> probs; ///< Detection probabilities, once frozen
+    };
+
+    /// Key of the cell with the given indices
+    static G4long CellKey(G4long ix, G4long iy);
+
+    G4double cell_size_;
+    G4int min_electrons_;
+    G4String filename_;
+
+    std::unordered_map<G4long, Cell> cells_;
+
+    std::vector<LightTable::Sensor> sensors_;
+    std::map<std::pair<G4String, G4int>, G4int> sensor_index_;
+    LightTableHits* hits_;
+
+    /// Learning electrons and photons descending from
+    /// them in the current event -> cell
+    std::unordered_map<G4int, G4long> ancestor_;
+    std::vector<G4long> learning_cells_; ///< Cells with learning electrons in the current event
+    G4int event_id_;
+
+    static ELResponseCache* learning_;
+  };
+
+  inline ELResponseCache* ELResponseCache::Learning()
+  { return learning_; }
+
+} // end namespace nexus
+
+#endif
@@ -10,6 +10,9 @@
 
 #include "IonizationElectron.h"
 #include "BaseDriftField.h"
+#include "RandomUtils.h"
+#include "ELResponseCache.h"
+#include "IntegralTableIO.h"
 
 #include <G4MaterialPropertiesTable.hh>
 #include <G4ParticleChange.hh>
@@ -17,6 +20,8 @@
 #include <Randomize.hh>
 #include <G4Poisson.hh>
 #include <G4GenericMessenger.hh>
+#include <G4StackedTrack.hh>
+#include <G4EventManager.hh>
 
 #include <CLHEP/Units/PhysicalConstants.h>
 
@@ -28,13 +33,16 @@ using namespace CLHEP;
 Electroluminescence::Electroluminescence(const G4String& process_name,
 					                               G4ProcessType type):
   G4VDiscreteProcess(process_name, type), theFastIntegralTable_(0),
-  table_generation_(false), photons_per_point_(0)
+  table_retrieved_(false), table_generation_(false), photons_per_point_(0), photon_weight_(1.),
+  angular_bias_(NO_BIAS), angular_bias_cos_cone_(0.), angular_bias_fraction_(0.9),
+  lazy_emission_(false), lazy_memory_budget_(100.),
+  response_cache_(false), response_cache_file_("el_response_cache.csv"),
+  response_cache_cell_size_(5.*mm), response_cache_electrons_(100), cache_(0)
 {
   ParticleChange_ = new G4ParticleChange();
+  ParticleChange_->SetSecondaryWeightByProcess(true);
   pParticleChange = ParticleChange_;
 
-  BuildThePhysicsTable();
-
    /// Messenger
   msg_ = new G4GenericMessenger(this, "/Physics/Electroluminescence/",
 				"Control commands of the Electroluminescence physics process.");
@@ -42,6 +50,43 @@ Electroluminescence::Electroluminescence(const G4String& process_name,
 			"EL Table generation");
   msg_->DeclareProperty("photons_per_point", photons_per_point_,
 			"Photon per point");
+  G4GenericMessenger::Command& bias_cmd =
+    msg_->DeclareMethod("angular_bias", &Electroluminescence::SetAngularBias,
+			"Emit the photons preferably toward the anode or the cathode, with weights compensating the bias");
+  bias_cmd.SetCandidates("none anode cathode");
+  G4GenericMessenger::Command& cone_cmd =
+    msg_->DeclareMethodWithUnit("angular_bias_cone", "deg", &Electroluminescence::SetAngularBiasCone,
+			        "Half-angle of the favoured cone around the drift direction");
+  cone_cmd.SetParameterName("angular_bias_cone", false);
+  cone_cmd.SetRange("angular_bias_cone>0. && angular_bias_cone<=180.");
+  G4GenericMessenger::Command& fraction_cmd =
+    msg_->DeclareProperty("angular_bias_fraction", angular_bias_fraction_,
+			  "Fraction of the photons emitted in the favoured cone");
+  fraction_cmd.SetParameterName("angular_bias_fraction", false);
+  fraction_cmd.SetRange("angular_bias_fraction>=0. && angular_bias_fraction<1.");
+  msg_->DeclareProperty("lazy_emission", lazy_emission_,
+			"Generate the photons in bounded batches when the stack is empty");
+  G4GenericMessenger::Command& budget_cmd =
+    msg_->DeclareProperty("lazy_memory_budget", lazy_memory_budget_,
+			  "Memory (in MB) for each batch of photons in lazy emission mode");
+  budget_cmd.SetParameterName("lazy_memory_budget", false);
+  budget_cmd.SetRange("lazy_memory_budget>0.");
+
+  msg_->DeclareProperty("response_cache", response_cache_,
+			"Learn the sensor response to the EL light of each cell and sample it");
+  msg_->DeclareProperty("response_cache_file", response_cache_file_,
+			"File with the learned EL response. It is read if it exists.");
+  G4GenericMessenger::Command& cell_cmd =
+    msg_->DeclarePropertyWithUnit("response_cache_cell_size", "mm",
+                                  response_cache_cell_size_,
+			          "Size in x and y of the cells of the EL response cache");
+  cell_cmd.SetParameterName("response_cache_cell_size", false);
+  cell_cmd.SetRange("response_cache_cell_size>0.");
+  G4GenericMessenger::Command& electrons_cmd =
+    msg_->DeclareProperty("response_cache_electrons", response_cache_electrons_,
+			  "Electrons whose photons are tracked in a cell before sampling its response");
+  electrons_cmd.SetParameterName("response_cache_electrons", false);
+  electrons_cmd.SetRange("response_cache_electrons>0");
 
  }
 
@@ -49,7 +94,8 @@ Electroluminescence::Electroluminescence(const G4String& process_name,
 
 Electroluminescence::~Electroluminescence()
 {
-  delete theFastIntegralTable_;
+  delete cache_;
+  DeleteIntegralTable(theFastIntegralTable_);
 }
 
 
@@ -61,6 +107,72 @@ G4bool Electroluminescence::IsApplicable(const G4ParticleDefinition& pdef)
 
 
 
+void Electroluminescence::SetAngularBias(const G4String& bias)
+{
+  if      (bias == "none")    angular_bias_ = NO_BIAS;
+  else if (bias == "anode")   angular_bias_ = ANODE;
+  else if (bias == "cathode") angular_bias_ = CATHODE;
+  else
+    G4Exception("[Electroluminescence]", "SetAngularBias()", FatalErrorInArgument,
+                ("Unknown angular bias " + bias +
+                 ". It must be none, anode or cathode.").c_str());
+}
+
+
+
+void Electroluminescence::SetAngularBiasCone(G4double cone)
+{
+  if (cone <= 0. || cone > pi)
+    G4Exception("[Electroluminescence]", "SetAngularBiasCone()", FatalErrorInArgument,
+                "The half-angle of the cone must be in (0, 180] deg.");
+  angular_bias_cos_cone_ = std::cos(cone);
+}
+
+
+
+void Electroluminescence::PreparePhysicsTable(const G4ParticleDefinition&)
+{
+  // Called before every build of the physics tables
+  table_retrieved_ = false;
+}
+
+
+
+void Electroluminescence::BuildPhysicsTable(const G4ParticleDefinition&)
+{
+  // Otherwise the table is built again, since the materials
+  // or their optical properties may have changed
+  if (!table_retrieved_) BuildThePhysicsTable();
+}
+
+
+
+G4bool Electroluminescence::StorePhysicsTable(const G4ParticleDefinition* pdef,
+                                              const G4String& directory, G4bool ascii)
+{
+  G4String filename =
+    GetPhysicsTableFileName(pdef, directory, "ELIntegral", ascii);
+  return StoreIntegralTable(theFastIntegralTable_, filename);
+}
+
+
+
+G4bool Electroluminescence::RetrievePhysicsTable(const G4ParticleDefinition* pdef,
+                                                 const G4String& directory, G4bool ascii)
+{
+  G4String filename =
+    GetPhysicsTableFileName(pdef, directory, "ELIntegral", ascii);
+  G4PhysicsTable* table = RetrieveIntegralTable(filename);
+  if (!table) return false;
+
+  DeleteIntegralTable(theFastIntegralTable_);
+  theFastIntegralTable_ = table;
+  table_retrieved_ = true;
+  return true;
+}
+
+
+
 G4VParticleChange*
 Electroluminescence::PostStepDoIt(const G4Track& track, const G4Step& step)
 {
@@ -97,15 +209,16 @@ Electroluminescence::PostStepDoIt(const G4Track& track, const G4Step& step)
     num_photons = G4int(G4RandGauss::shoot(mean, sigma) + 0.5);
   }
 
-  if (table_generation_)
+  // With photon bunching, each tracked photon stands for photon_weight_
+  // of them. Every photon is kept with probability 1/photon_weight_.
+  G4double photon_weight = track.GetWeight();
+  if (table_generation_) {
     num_photons = photons_per_point_;
-
-  ParticleChange_->SetNumberOfSecondaries(num_photons);
-
-  // Track secondaries first to avoid a memory bloat
-  if ((num_photons > 0) && (track.GetTrackStatus() == fAlive))
-    ParticleChange_->ProposeTrackStatus(fSuspend);
-
+  }
+  else if (photon_weight_ > 1. && num_photons > 0) {
+    num_photons = G4int(CLHEP::RandBinomial::shoot(num_photons, 1. / photon_weight_));
+    photon_weight *= photon_weight_;
+  }
 
   //////////////////////////////////////////////////////////////////
 
@@ -123,83 +236,220 @@ Electroluminescence::PostStepDoIt(const G4Track& track, const G4Step& step)
   G4MaterialPropertiesTable* mpt = mat->GetMaterialPropertiesTable();
   const G4MaterialPropertyVector* spectrum = mpt->GetProperty("ELSPECTRUM");
 
-  if (!spectrum) return G4VDiscreteProcess::PostStepDoIt(track, step);
+  if (!spectrum || num_photons <= 0)
+    return G4VDiscreteProcess::PostStepDoIt(track, step);
 
   G4PhysicsOrderedFreeVector* spectrum_integral =
     (G4PhysicsOrderedFreeVector*)(*theFastIntegralTable_)(mat->GetIndex());
 
+  // Once enough electrons have been seen in the (x, y) cell of the step,
+  // the detection of the photons is sampled instead of tracking them
+  if (response_cache_ && !table_generation_) {
+    if (!cache_) {
+      // The photons are followed to the sensors by the stacking action
+      if (!G4EventManager::GetEventManager()->GetUserStackingAction())
+        G4Exception("[Electroluminescence]", "PostStepDoIt()", FatalException,
+                    "The EL response cache needs the DefaultStackingAction (or one derived from it).");
+      cache_ = new ELResponseCache(response_cache_cell_size_,
+                                   response_cache_electrons_, response_cache_file_);
+    }
+
+    G4long cell = cache_->FindCell(position);
+    if (cache_->IsConverged(cell)) {
+      cache_->Sample(cell, RandomRound(num_photons * photon_weight), field,
+                     initial_position, final_position);
+      return G4VDiscreteProcess::PostStepDoIt(track, step);
+    }
+    cache_->Learn(cell, track, num_photons * photon_weight);
+  }
 
-  G4double sc_max = spectrum_integral->GetMaxValue();
+  // In lazy mode, only what is needed to generate the photons later is
+  // kept, including the seed of their own random number sequence
+  if (lazy_emission_) {
+    if (!G4EventManager::GetEventManager()->GetUserStackingAction())
+      G4Exception("[Electroluminescence]", "PostStepDoIt()", FatalException,
+                  "Lazy emission needs the DefaultStackingAction (or one derived from it).");
+
+    PendingEmission emission;
+    emission.initial_position = initial_position;
+    emission.final_position   = final_position;
+    emission.field            = field;
+    emission.spectrum         = spectrum_integral;
+    emission.weight           = photon_weight;
+    emission.seed             = G4RandFlat::shootInt(2147483647L);
+    emission.parent_id        = track.GetTrackID();
+    emission.num_photons      = num_photons;
+    emission.num_emitted      = 0;
+    pending_.push_back(emission);
+    return G4VDiscreteProcess::PostStepDoIt(track, step);
+  }
+
+  ParticleChange_->SetNumberOfSecondaries(num_photons);
+
+  // Track secondaries first to avoid a memory bloat
+  if (track.GetTrackStatus() == fAlive)
+    ParticleChange_->ProposeTrackStatus(fSuspend);
 
   for (G4int i=0; i<num_photons; i++) {
-    // Generate a random direction for the photon
-    // (EL is supposed isotropic)
-    G4double cos_theta = 1. - 2.*G4UniformRand();
-    G4double sin_theta = sqrt((1.-cos_theta)*(1.+cos_theta));
+    G4Track* secondary = CreatePhoton(field, spectrum_integral,
+                                      initial_position, final_position,
+                                      photon_weight);
+    secondary->SetParentID(track.GetTrackID());
+    ParticleChange_->AddSecondary(secondary);
+  }
+
+  return G4VDiscreteProcess::PostStepDoIt(track, step);
+}
+
 
-    G4double phi = twopi * G4UniformRand();
-    G4double sin_phi = sin(phi);
-    G4double cos_phi = cos(phi);
 
-    G4double px = sin_theta * cos_phi;
-    G4double py = sin_theta * sin_phi;
-    G4double pz = cos_theta;
+G4Track* Electroluminescence::CreatePhoton(BaseDriftField* field,
+                                           G4PhysicsOrderedFreeVector* spectrum_integral,
+                                           const G4LorentzVector& initial_position,
+                                           const G4LorentzVector& final_position,
+                                           G4double weight)
+{
+  // With angular bias, a fraction of the photons is emitted in a cone
+  // around the drift direction (electrons drift toward the anode)
+  G4ThreeVector bias_axis;
+  if (angular_bias_ != NO_BIAS) {
+    bias_axis = (final_position.vect() - initial_position.vect()).unit();
+    if (angular_bias_ == CATHODE) bias_axis = -bias_axis;
+  }
 
-    G4ThreeVector momentum(px, py, pz);
+  G4bool biased = (bias_axis.mag2() > 0.);
+  G4double cos_cone = angular_bias_cos_cone_;
+  G4bool in_cone = biased && (G4UniformRand() < angular_bias_fraction_);
 
-    // Determine photon polarization accordingly
-    G4double sx = cos_theta * cos_phi;
-    G4double sy = cos_theta * sin_phi;
-    G4double sz = -sin_theta;
+  // Generate a random direction for the photon
+  // (EL is supposed isotropic)
+  G4double cos_theta = in_cone ?
+    1. - (1. - cos_cone) * G4UniformRand() : 1. - 2.*G4UniformRand();
+  G4double sin_theta = sqrt((1.-cos_theta)*(1.+cos_theta));
 
-    G4ThreeVector polarization(sx, sy, sz);
-    G4ThreeVector perp = momentum.cross(polarization);
+  G4double phi = twopi * G4UniformRand();
+  G4double sin_phi = sin(phi);
+  G4double cos_phi = cos(phi);
 
-    phi = twopi * G4UniformRand();
-    sin_phi = sin(phi);
-    cos_phi = cos(phi);
+  G4double px = sin_theta * cos_phi;
+  G4double py = sin_theta * sin_phi;
+  G4double pz = cos_theta;
 
-    polarization = cos_phi * polarization + sin_phi * perp;
-    polarization = polarization.unit();
+  G4ThreeVector momentum(px, py, pz);
 
-    // Generate a new photon and set properties
-    G4DynamicParticle* photon =
-      new G4DynamicParticle(G4OpticalPhoton::Definition(), momentum);
+  // Determine photon polarization accordingly
+  G4double sx = cos_theta * cos_phi;
+  G4double sy = cos_theta * sin_phi;
+  G4double sz = -sin_theta;
 
-    photon->
-      SetPolarization(polarization.x(), polarization.y(), polarization.z());
+  G4ThreeVector polarization(sx, sy, sz);
 
-    // Determine photon energy
-    G4double sc_value = G4UniformRand()*sc_max;
-    G4double sampled_energy = spectrum_integral->GetEnergy(sc_value);
-    photon->SetKineticEnergy(sampled_energy);
+  // The cone is sampled around the z axis and then
+  // turned to point along the bias axis
+  if (in_cone) {
+    momentum.rotateUz(bias_axis);
+    polarization.rotateUz(bias_axis);
+  }
 
-    G4LorentzVector xyzt =
-      field->GeneratePointAlongDriftLine(initial_position, final_position);
+  G4ThreeVector perp = momentum.cross(polarization);
 
-    // Create the track
-    G4Track* secondary = new G4Track(photon, xyzt.t(), xyzt.v());
-    secondary->SetParentID(track.GetTrackID());
-    ParticleChange_->AddSecondary(secondary);
+  phi = twopi * G4UniformRand();
+  sin_phi = sin(phi);
+  cos_phi = cos(phi);
 
+  polarization = cos_phi * polarization + sin_phi * perp;
+  polarization = polarization.unit();
+
+  // The weight is the ratio of the isotropic density to the density
+  // of the mixture of isotropic and cone emission actually sampled
+  if (biased) {
+    G4double density = 1. - angular_bias_fraction_;
+    if (momentum.dot(bias_axis) >= cos_cone)
+      density += 2. * angular_bias_fraction_ / (1. - cos_cone);
+    weight /= density;
   }
 
-  return G4VDiscreteProcess::PostStepDoIt(track, step);
+  // Generate a new photon and set properties
+  G4DynamicParticle* photon =
+    new G4DynamicParticle(G4OpticalPhoton::Definition(), momentum);
+
+  photon->
+    SetPolarization(polarization.x(), polarization.y(), polarization.z());
+
+  // Determine photon energy
+  G4double sc_max = spectrum_integral->GetMaxValue();
+  G4double sc_value = G4UniformRand()*sc_max;
+  G4double sampled_energy = spectrum_integral->GetEnergy(sc_value);
+  photon->SetKineticEnergy(sampled_energy);
+
+  G4LorentzVector xyzt =
+    field->GeneratePointAlongDriftLine(initial_position, final_position);
+
+  // Create the track
+  G4Track* track = new G4Track(photon, xyzt.t(), xyzt.v());
+  track->SetWeight(weight);
+  return track;
 }
 
 
 
-void Electroluminescence::BuildThePhysicsTable()
+void Electroluminescence::EmitPendingPhotons(G4TrackVector& photons)
+{
+  if (pending_.empty()) return;
+
+  // Photons in a batch, so that their tracks, dynamic particles
+  // and stack entries fit in the memory budget
+  const size_t bytes_per_photon =
+    sizeof(G4Track) + sizeof(G4DynamicParticle) + sizeof(G4StackedTrack);
+  const size_t batch_size =
+    std::max(size_t(1), size_t(lazy_memory_budget_ * 1024. * 1024. / bytes_per_photon));
+
+  // Photons are generated with the random sequence of their emission,
+  // which is continued if an emission is split between batches
+  CLHEP::HepRandomEngine* engine = G4Random::getTheEngine();
+  G4Random::setTheEngine(&substream_);
+
+  while (!pending_.empty() && photons.size() < batch_size) {
+    PendingEmission& emission = pending_.front();
+    if (emission.num_emitted == 0)
+      substream_.setSeed(emission.seed, 0);
+
+    for (; emission.num_emitted < emission.num_photons &&
+           photons.size() < batch_size; ++emission.num_emitted) {
+      G4Track* photon = CreatePhoton(emission.field, emission.spectrum,
+                                     emission.initial_position,
+                                     emission.final_position,
+                                     emission.weight);
+      photon->SetParentID(emission.parent_id);
+      photon->SetCreatorProcess(this);
+      photons.push_back(photon);
+    }
+
+    if (emission.num_emitted == emission.num_photons)
+      pending_.pop_front();
+  }
+
+  G4Random::setTheEngine(engine);
+}
+
+
+
+void Electroluminescence::ClearPendingPhotons()
 {
-  if (theFastIntegralTable_) return;
+  pending_.clear();
+}
+
+
 
+void Electroluminescence::BuildThePhysicsTable()
+{
   const G4MaterialTable* theMaterialTable = G4Material::GetMaterialTable();
   G4int numOfMaterials = G4Material::GetNumberOfMaterials();
 
-  // create new physics table
+  // create new physics table, replacing the previous one
 
-  if(!theFastIntegralTable_)
-    theFastIntegralTable_ = new G4PhysicsTable(numOfMaterials);
+  DeleteIntegralTable(theFastIntegralTable_);
+  theFastIntegralTable_ = new G4PhysicsTable(numOfMaterials);
 
   for (G4int i=0 ; i<numOfMaterials; i++) {
 
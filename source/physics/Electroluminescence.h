@@ -11,6 +11,11 @@
 
 #include <G4VDiscreteProcess.hh>
 #include <G4PhysicsOrderedFreeVector.hh>
+#include <G4LorentzVector.hh>
+#include <G4TrackVector.hh>
+#include <CLHEP/Random/MixMaxRng.h>
+
+#include <deque>
 
 class G4ParticleChange;
 class G4GenericMessenger;
@@ -18,6 +23,9 @@ class G4GenericMessenger;
 
 namespace nexus {
 
+  class BaseDriftField;
+  class ELResponseCache;
+
   class Electroluminescence: public G4VDiscreteProcess
   {
   public:
@@ -30,6 +38,35 @@ namespace nexus {
     /// Returns true if particle is an ionization electron
     G4bool IsApplicable(const G4ParticleDefinition&);
 
+    /// Build the integral table of the EL spectra, unless it was
+    /// retrieved from the physics-table cache for this build
+    void PreparePhysicsTable(const G4ParticleDefinition&);
+    void BuildPhysicsTable(const G4ParticleDefinition&);
+    G4bool StorePhysicsTable(const G4ParticleDefinition*,
+                             const G4String& directory, G4bool ascii);
+    G4bool RetrievePhysicsTable(const G4ParticleDefinition*,
+                                const G4String& directory, G4bool ascii);
+
+    /// Track one photon for every 'weight' photons emitted,
+    /// giving it that statistical weight (photon bunching)
+    void SetPhotonWeight(G4double weight);
+
+    /// Emit the photons preferably toward the anode or
+    /// the cathode ("none", "anode" or "cathode")
+    void SetAngularBias(const G4String&);
+    /// Half-angle of the favoured cone around the drift direction
+    void SetAngularBiasCone(G4double);
+    /// Fraction of the photons emitted in the favoured cone
+    void SetAngularBiasFraction(G4double);
+
+    /// In lazy emission mode, generate the next batch of pending
+    /// photons, within the memory budget. The caller owns the tracks.
+    void EmitPendingPhotons(G4TrackVector&);
+    /// Discard the photons not generated yet
+    void ClearPendingPhotons();
+    /// True if there are photons not generated yet
+    G4bool HasPendingPhotons() const;
+
   public:
     /// This is the method that implements the EL light emission
     /// as a post-step process, that is, photons are generated as
@@ -37,12 +74,20 @@ namespace nexus {
     G4VParticleChange* PostStepDoIt(const G4Track&, const G4Step&);
 
   private:
+    /// Unit tests and benchmarks create photons outside a step
+    friend class ElectroluminescenceFixture;
 
     /// Returns infinity; i.e., the process does not limit the step,
     /// but sets the 'StronglyForced' condition for the DoIt to be
     /// invoked at every step.
     G4double GetMeanFreePath(const G4Track&, G4double, G4ForceCondition*);
 
+    /// Create a photon along the drift line of the step, with the given
+    /// weight times the correction of the angular bias, if any
+    G4Track* CreatePhoton(BaseDriftField*, G4PhysicsOrderedFreeVector*,
+                          const G4LorentzVector&, const G4LorentzVector&,
+                          G4double weight);
+
     void BuildThePhysicsTable();
     void ComputeCumulativeDistribution(const G4PhysicsOrderedFreeVector&,
                                        G4PhysicsOrderedFreeVector&);
@@ -51,13 +96,55 @@ namespace nexus {
     G4ParticleChange* ParticleChange_;
 
     G4PhysicsTable* theFastIntegralTable_;
+    G4bool table_retrieved_; ///< True if the table was retrieved since the last PreparePhysicsTable
 
     G4GenericMessenger* msg_;
 
     G4bool table_generation_;
     G4int photons_per_point_;
+
+    G4double photon_weight_; ///< Statistical weight of every tracked photon
+
+    enum bias_direction {NO_BIAS, ANODE, CATHODE};
+
+    bias_direction angular_bias_; ///< Direction favoured in the photon emission
+    G4double angular_bias_cos_cone_; ///< Cosine of the half-angle of the favoured cone
+    G4double angular_bias_fraction_; ///< Fraction of the photons emitted in the favoured cone
+
+    /// What is needed to generate the photons of an EL step later on
+    struct PendingEmission {
+      G4LorentzVector initial_position;
+      G4LorentzVector final_position;
+      BaseDriftField* field;
+      G4PhysicsOrderedFreeVector* spectrum;
+      G4double weight;
+      long seed;
+      G4int parent_id;
+      G4int num_photons;
+      G4int num_emitted;
+    };
+
+    G4bool lazy_emission_; ///< Generate the photons in batches when the stack is empty
+    G4double lazy_memory_budget_; ///< Memory (in MB) available for a batch of photons
+    std::deque<PendingEmission> pending_; ///< EL steps with photons not generated yet
+    CLHEP::MixMaxRng substream_; ///< Random engine of the photons of an EL step
+
+    G4bool response_cache_; ///< Sample the response of the cells already learned
+    G4String response_cache_file_; ///< File where the learned response is kept
+    G4double response_cache_cell_size_; ///< Size of the cells in x and y
+    G4int response_cache_electrons_; ///< Electrons tracked in a cell before sampling it
+    ELResponseCache* cache_;
   };
 
+  inline void Electroluminescence::SetPhotonWeight(G4double weight)
+  { photon_weight_ = weight; }
+
+  inline void Electroluminescence::SetAngularBiasFraction(G4double fraction)
+  { angular_bias_fraction_ = fraction; }
+
+  inline G4bool Electroluminescence::HasPendingPhotons() const
+  { return !pending_.empty(); }
+
 } // end namespace nexus
 
 #endif
@@ -0,0 +1,89 @@
+// ----------------------------------------------------------------------------
+// nexus | IntegralTableIO.cc
+//
+// Functions to store and retrieve the integral tables (one cumulative
+// distribution per material) of the nexus optical processes, so that they
+// can be kept in the physics-table cache together with the Geant4 ones.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "IntegralTableIO.h"
+
+#include <G4PhysicsTable.hh>
+#include <G4PhysicsOrderedFreeVector.hh>
+#include <G4Material.hh>
+
+#include <fstream>
+#include <limits>
+
+
+namespace nexus {
+
+  G4bool StoreIntegralTable(const G4PhysicsTable* table, const G4String& filename)
+  {
+    if (!table) return false;
+
+    std::ofstream out(filename);
+    if (!out) return false;
+
+    out.precision(std::numeric_limits<G4double>::max_digits10);
+
+    // Geant4 cannot read back vectors without points, so a
+    // plain format (points of each entry, then its pairs) is used
+    out << table->entries() << "\n";
+    for (size_t i=0; i<table->entries(); ++i) {
+      const G4PhysicsVector* vector = (*table)(i);
+      size_t npoints = vector ? vector->GetVectorLength() : 0;
+      out << npoints << "\n";
+      for (size_t j=0; j<npoints; ++j)
+        out << vector->Energy(j) << " " << (*vector)[j] << "\n";
+    }
+
+    return out.good();
+  }
+
+
+
+  G4PhysicsTable* RetrieveIntegralTable(const G4String& filename)
+  {
+    std::ifstream in(filename);
+    if (!in) return nullptr;
+
+    size_t nentries = 0;
+    in >> nentries;
+    if (!in || nentries != G4Material::GetNumberOfMaterials()) return nullptr;
+
+    G4PhysicsTable* table = new G4PhysicsTable(nentries);
+
+    for (size_t i=0; i<nentries; ++i) {
+      G4PhysicsOrderedFreeVector* vector = new G4PhysicsOrderedFreeVector();
+      table->insertAt(i, vector);
+
+      size_t npoints = 0;
+      in >> npoints;
+      for (size_t j=0; in && j<npoints; ++j) {
+        G4double energy, value;
+        in >> energy >> value;
+        vector->InsertValues(energy, value);
+      }
+
+      if (!in) {
+        DeleteIntegralTable(table);
+        return nullptr;
+      }
+    }
+
+    return table;
+  }
+
+
+
+  void DeleteIntegralTable(G4PhysicsTable* table)
+  {
+    if (!table) return;
+    table->clearAndDestroy();
+    delete table;
+  }
+
+} // end namespace nexus
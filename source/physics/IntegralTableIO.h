@@ -0,0 +1,34 @@
+// ----------------------------------------------------------------------------
+// nexus | IntegralTableIO.h
+//
+// Functions to store and retrieve the integral tables (one cumulative
+// distribution per material) of the nexus optical processes, so that they
+// can be kept in the physics-table cache together with the Geant4 ones.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef INTEGRAL_TABLE_IO_H
+#define INTEGRAL_TABLE_IO_H
+
+#include <globals.hh>
+
+class G4PhysicsTable;
+
+
+namespace nexus {
+
+  /// Write the table to a text file. Empty vectors (materials
+  /// without the relevant property) are kept as such.
+  G4bool StoreIntegralTable(const G4PhysicsTable*, const G4String& filename);
+
+  /// Read a table written by StoreIntegralTable. Returns null if the
+  /// file cannot be read or does not have one entry per material.
+  G4PhysicsTable* RetrieveIntegralTable(const G4String& filename);
+
+  /// Delete the table and its vectors (nothing to do for null)
+  void DeleteIntegralTable(G4PhysicsTable*);
+
+} // end namespace nexus
+
+#endif
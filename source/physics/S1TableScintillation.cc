@@ -0,0 +1,109 @@
+// ----------------------------------------------------------------------------
+// nexus | S1TableScintillation.cc
+//
+// Wrapper around the Geant4 scintillation process that does not track
+// the scintillation photons. Instead, the photons detected by each sensor
+// are sampled from an S1 light table at the position of the step, and
+// their arrival times from the time distributions of the table. No
+// photon track is ever created.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "S1TableScintillation.h"
+
+#include "LightTable.h"
+#include "LightTableHits.h"
+#include "SensorHit.h"
+#include "RandomUtils.h"
+
+#include <G4ParticleChange.hh>
+#include <G4EventManager.hh>
+#include <G4Event.hh>
+#include <Randomize.hh>
+
+
+namespace nexus {
+
+
+  S1TableScintillation::S1TableScintillation(const G4String& table_file,
+                                             const G4String& process_name):
+    ScintillationBase(process_name), table_file_(table_file), table_(0), hits_(0)
+  {
+  }
+
+
+
+  S1TableScintillation::~S1TableScintillation()
+  {
+    delete hits_;
+    delete table_;
+  }
+
+
+
+  void S1TableScintillation::Emit(const G4Track& track, const G4Step& step,
+                                  const std::vector<Component>& components)
+  {
+    // The sensitive detectors only exist once the geometry is built
+    if (!table_) {
+      table_ = new LightTable(table_file_);
+      hits_  = new LightTableHits(*table_);
+      probs_.assign(table_->GetSensors().size(), 0.);
+    }
+
+    // The table is evaluated once per step, at its middle point
+    G4ThreeVector position = 0.5 * (step.GetPreStepPoint()->GetPosition() +
+                                    step.GetPostStepPoint()->GetPosition());
+
+    // A sensor may be reported once per corner of the interpolation cell
+    table_->ForEachSensor(position, [&](G4int isensor, G4double prob) {
+      if (probs_[isensor] == 0.) sensors_.push_back(isensor);
+      probs_[isensor] += prob;
+    });
+
+    G4int num_photons = 0;
+    for (auto& component : components) num_photons += component.num_photons;
+
+    G4HCofThisEvent* hce =
+      G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetHCofThisEvent();
+
+    // Every emitted photon is detected by at most one sensor, so the
+    // detections are a multinomial thinning of the photons of the step,
+    // sampled as a sequence of binomials for the photons not assigned yet
+    G4int remaining = num_photons;
+    G4double remaining_prob = 1.;
+
+    for (G4int isensor : sensors_) {
+      G4double prob = probs_[isensor];
+      probs_[isensor] = 0.;
+      if (remaining == 0 || remaining_prob <= 0.) continue;
+
+      G4double p = (prob < remaining_prob) ? prob / remaining_prob : 1.;
+      G4int detected = G4int(CLHEP::RandBinomial::shoot(remaining, p));
+      remaining      -= detected;
+      remaining_prob -= prob;
+      if (detected == 0) continue;
+
+      SensorHit* hit = hits_->GetHit(isensor, hce);
+      if (!hit) continue;
+
+      for (G4int i=0; i<detected; i++) {
+        // Scintillation component of the photon, in proportion
+        // to the photons emitted by each of them
+        G4int iphoton = G4int(G4UniformRand() * num_photons);
+        size_t c = 0;
+        while (iphoton >= components[c].num_photons) iphoton -= components[c++].num_photons;
+
+        G4int counts = RandomRound(track.GetWeight());
+        if (counts == 0) continue;
+
+        G4double time = SampleTime(step, SampleFraction(track), components[c]);
+        hit->Fill(time + table_->SampleArrivalTime(position), counts);
+      }
+    }
+
+    sensors_.clear();
+  }
+
+} // end namespace nexus
@@ -0,0 +1,49 @@
+// ----------------------------------------------------------------------------
+// nexus | S1TableScintillation.h
+//
+// Wrapper around the Geant4 scintillation process that does not track
+// the scintillation photons. Instead, the photons detected by each sensor
+// are sampled from an S1 light table at the position of the step, and
+// their arrival times from the time distributions of the table. No
+// photon track is ever created.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef S1_TABLE_SCINTILLATION_H
+#define S1_TABLE_SCINTILLATION_H
+
+#include "ScintillationBase.h"
+
+
+namespace nexus {
+
+  class LightTable;
+  class LightTableHits;
+
+  class S1TableScintillation: public ScintillationBase
+  {
+  public:
+    /// Constructor, taking the S1 light table file
+    S1TableScintillation(const G4String& table_file,
+                         const G4String& process_name="Scintillation");
+    /// Destructor
+    ~S1TableScintillation();
+
+  private:
+    /// Add the detection of the photons of the step to the sensors
+    void Emit(const G4Track&, const G4Step&, const std::vector<Component>&);
+
+  private:
+    G4String table_file_;
+
+    LightTable* table_;
+    LightTableHits* hits_;
+
+    std::vector<G4double> probs_; ///< Detection probability of each sensor at the step
+    std::vector<G4int> sensors_;  ///< Sensors with a non-zero probability at the step
+  };
+
+} // end namespace nexus
+
+#endif
@@ -0,0 +1,276 @@
+// ----------------------------------------------------------------------------
+// nexus | ScintillationBase.cc
+//
+// Base class of the wrappers around the Geant4 scintillation process that
+// handle the scintillation photons in their own way. The number of photons
+// of each step and each scintillation component is computed (and
+// fluctuated) as G4Scintillation does, but no photon is created unless
+// the derived class asks for it.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "ScintillationBase.h"
+
+#include <G4Scintillation.hh>
+#include <G4ParticleChange.hh>
+#include <G4MaterialPropertiesTable.hh>
+#include <G4EmSaturation.hh>
+#include <G4OpticalPhoton.hh>
+#include <G4Poisson.hh>
+#include <Randomize.hh>
+
+#include <CLHEP/Units/PhysicalConstants.h>
+
+using namespace CLHEP;
+
+
+namespace nexus {
+
+
+  ScintillationBase::ScintillationBase(const G4String& process_name):
+    G4WrapperProcess(process_name, fElectromagnetic), particle_change_(0)
+  {
+    particle_change_ = new G4ParticleChange();
+    pParticleChange = particle_change_;
+  }
+
+
+
+  ScintillationBase::~ScintillationBase()
+  {
+    // The wrapped process is owned by the physics list that created it
+    pRegProcess = 0;
+    delete particle_change_;
+  }
+
+
+
+  G4Scintillation* ScintillationBase::GetScintillation() const
+  {
+    G4Scintillation* scint = dynamic_cast<G4Scintillation*>(pRegProcess);
+    if (!scint)
+      G4Exception("[ScintillationBase]", "GetScintillation()", FatalException,
+                  "The wrapped process is not a G4Scintillation.");
+    return scint;
+  }
+
+
+
+  G4VParticleChange*
+  ScintillationBase::PostStepDoIt(const G4Track& track, const G4Step& step)
+  {
+    particle_change_->Initialize(track);
+    particle_change_->SetNumberOfSecondaries(0);
+
+    if (ComputeComponents(track, step))
+      Emit(track, step, components_);
+
+    return particle_change_;
+  }
+
+
+
+  G4VParticleChange*
+  ScintillationBase::AtRestDoIt(const G4Track& track, const G4Step& step)
+  {
+    // As in G4Scintillation
+    return PostStepDoIt(track, step);
+  }
+
+
+
+  G4bool ScintillationBase::ComputeComponents(const G4Track& track, const G4Step& step)
+  {
+    components_.clear();
+
+    G4MaterialPropertiesTable* mpt =
+      track.GetMaterial()->GetMaterialPropertiesTable();
+    if (!mpt) return false;
+
+    G4int num_components = 1;
+    if      (mpt->GetProperty("SCINTILLATIONCOMPONENT3")) num_components = 3;
+    else if (mpt->GetProperty("SCINTILLATIONCOMPONENT2")) num_components = 2;
+    else if (!mpt->GetProperty("SCINTILLATIONCOMPONENT1")) return false;
+
+    G4Scintillation* scint = GetScintillation();
+
+    G4double yields[3] = {1., 0., 0.};
+    G4double time_constants[3] = {0., 0., 0.};
+    G4double rise_times[3] = {0., 0., 0.};
+    const char* keys[3] = {"1", "2", "3"};
+
+    G4double mean;
+    if (scint->GetScintillationByParticleType()) {
+      mean = scint->GetScintillationYieldByParticleType(track, step,
+               yields[0], yields[1], yields[2],
+               time_constants[0], time_constants[1], time_constants[2]);
+    }
+    else {
+      for (G4int i=0; i<3; i++) {
+        G4String key = G4String("SCINTILLATIONYIELD") + keys[i];
+        if (mpt->ConstPropertyExists(key)) yields[i] = mpt->GetConstProperty(key);
+      }
+      for (G4int i=0; i<num_components; i++)
+        time_constants[i] =
+          mpt->GetConstProperty(G4String("SCINTILLATIONTIMECONSTANT") + keys[i]);
+
+      // Birks' quenching, if any
+      G4EmSaturation* saturation = scint->GetSaturation();
+      mean = mpt->GetConstProperty("SCINTILLATIONYIELD") *
+        (saturation ? saturation->VisibleEnergyDepositionAtAStep(&step) :
+                      step.GetTotalEnergyDeposit());
+    }
+
+    if (scint->GetFiniteRiseTime()) {
+      for (G4int i=0; i<num_components; i++) {
+        G4String key = G4String("SCINTILLATIONRISETIME") + keys[i];
+        if (mpt->ConstPropertyExists(key)) rise_times[i] = mpt->GetConstProperty(key);
+      }
+    }
+
+    // Fluctuation of the number of photons
+    G4int num_photons;
+    if (mean > 10.) {
+      G4double resolution = mpt->ConstPropertyExists("RESOLUTIONSCALE") ?
+        mpt->GetConstProperty("RESOLUTIONSCALE") : 1.;
+      num_photons = G4lrint(G4RandGauss::shoot(mean, resolution * std::sqrt(mean)));
+    }
+    else {
+      num_photons = G4int(G4Poisson(mean));
+    }
+
+    if (num_photons <= 0) return false;
+
+    // Split of the photons among the components, as in G4Scintillation
+    G4double sum_yields = yields[0] + yields[1] + yields[2];
+    G4PhysicsTable* tables[3] = {scint->GetIntegralTable1(),
+                                 scint->GetIntegralTable2(),
+                                 scint->GetIntegralTable3()};
+    G4ScintillationType types[3] = {Fast, Medium, Slow};
+    size_t material_index = track.GetMaterial()->GetIndex();
+
+    for (G4int i=0; i<num_components; i++) {
+      Component component;
+      if (num_components == 1)
+        component.num_photons = num_photons;
+      else if (i == 1 && num_components == 2)
+        component.num_photons = num_photons - components_[0].num_photons;
+      else
+        component.num_photons = G4int(yields[i] / sum_yields * num_photons);
+
+      component.time_constant = time_constants[i];
+      component.rise_time = rise_times[i];
+      component.spectrum = tables[i] ?
+        (G4PhysicsOrderedFreeVector*)(*tables[i])(material_index) : 0;
+      component.type = types[i];
+
+      // A component without spectrum emits no photons, yet it
+      // is kept so that the split of the others is preserved
+      if (!component.spectrum) component.num_photons = 0;
+      components_.push_back(component);
+    }
+
+    for (auto& component : components_)
+      if (component.num_photons > 0) return true;
+
+    return false;
+  }
+
+
+
+  G4double ScintillationBase::SampleFraction(const G4Track& track) const
+  {
+    if (track.GetDefinition()->GetPDGCharge() == 0.) return 1.;
+    return G4UniformRand();
+  }
+
+
+
+  G4double ScintillationBase::SampleTime(const G4Step& step, G4double fraction,
+                                         const Component& component) const
+  {
+    const G4StepPoint* pre  = step.GetPreStepPoint();
+    const G4StepPoint* post = step.GetPostStepPoint();
+
+    // Time of flight to the emission point
+    G4double delta = fraction * step.GetStepLength();
+    G4double delta_time = 0.;
+    if (delta > 0.)
+      delta_time = delta / (pre->GetVelocity() +
+                            fraction * (post->GetVelocity() - pre->GetVelocity()) / 2.);
+
+    // Scintillation decay
+    if (component.rise_time == 0.)
+      delta_time -= component.time_constant * std::log(G4UniformRand());
+    else
+      delta_time += SampleRiseTime(component.rise_time, component.time_constant);
+
+    return pre->GetGlobalTime() + delta_time;
+  }
+
+
+
+  G4double ScintillationBase::SampleRiseTime(G4double rise_time,
+                                             G4double decay_time) const
+  {
+    // Rejection sampling of the bi-exponential distribution
+    // with an exponential envelope, as in G4Scintillation
+    G4double d = (rise_time + decay_time) / decay_time;
+    while (true) {
+      G4double t = -decay_time * std::log(1. - G4UniformRand());
+      G4double envelope = d * std::exp(-t / decay_time) / decay_time;
+      G4double bi_exp = std::exp(-t / decay_time) * (1. - std::exp(-t / rise_time)) /
+        decay_time / decay_time * (rise_time + decay_time);
+      if (G4UniformRand() <= bi_exp / envelope) return t;
+    }
+  }
+
+
+
+  G4Track* ScintillationBase::CreatePhoton(const G4Track& track, const G4Step& step,
+                                           const Component& component,
+                                           G4double weight) const
+  {
+    // Energy sampled from the integral of the spectrum
+    G4double sc_max = component.spectrum->GetMaxValue();
+    G4double sampled_energy = component.spectrum->GetEnergy(G4UniformRand() * sc_max);
+
+    // Isotropic direction
+    G4double cos_theta = 1. - 2. * G4UniformRand();
+    G4double sin_theta = std::sqrt((1. - cos_theta) * (1. + cos_theta));
+
+    G4double phi = twopi * G4UniformRand();
+    G4double sin_phi = std::sin(phi);
+    G4double cos_phi = std::cos(phi);
+
+    G4ThreeVector momentum(sin_theta * cos_phi, sin_theta * sin_phi, cos_theta);
+
+    // Random linear polarization perpendicular to the momentum
+    G4ThreeVector polarization(cos_theta * cos_phi, cos_theta * sin_phi, -sin_theta);
+    G4ThreeVector perp = momentum.cross(polarization);
+
+    phi = twopi * G4UniformRand();
+    polarization = (std::cos(phi) * polarization + std::sin(phi) * perp).unit();
+
+    G4DynamicParticle* photon =
+      new G4DynamicParticle(G4OpticalPhoton::Definition(), momentum);
+    photon->SetPolarization(polarization.x(), polarization.y(), polarization.z());
+    photon->SetKineticEnergy(sampled_energy);
+
+    G4double fraction = SampleFraction(track);
+    G4double time = SampleTime(step, fraction, component);
+    G4ThreeVector position =
+      step.GetPreStepPoint()->GetPosition() + fraction * step.GetDeltaPosition();
+
+    G4Track* secondary = new G4Track(photon, time, position);
+    secondary->SetTouchableHandle(step.GetPreStepPoint()->GetTouchableHandle());
+    secondary->SetParentID(track.GetTrackID());
+    secondary->SetWeight(weight);
+    if (GetScintillation()->GetScintillationTrackInfo())
+      secondary->SetUserInformation(new G4ScintillationTrackInformation(component.type));
+
+    return secondary;
+  }
+
+} // end namespace nexus
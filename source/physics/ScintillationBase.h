@@ -0,0 +1,87 @@
+// ----------------------------------------------------------------------------
+// nexus | ScintillationBase.h
+//
+// Base class of the wrappers around the Geant4 scintillation process that
+// handle the scintillation photons in their own way. The number of photons
+// of each step and each scintillation component is computed (and
+// fluctuated) as G4Scintillation does, but no photon is created unless
+// the derived class asks for it.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef SCINTILLATION_BASE_H
+#define SCINTILLATION_BASE_H
+
+#include <G4WrapperProcess.hh>
+#include <G4PhysicsOrderedFreeVector.hh>
+#include <G4ScintillationTrackInformation.hh>
+
+#include <vector>
+
+class G4ParticleChange;
+class G4Scintillation;
+
+
+namespace nexus {
+
+  class ScintillationBase: public G4WrapperProcess
+  {
+  public:
+    /// Constructor
+    ScintillationBase(const G4String& process_name);
+    /// Destructor
+    virtual ~ScintillationBase();
+
+    G4VParticleChange* PostStepDoIt(const G4Track&, const G4Step&);
+    G4VParticleChange* AtRestDoIt(const G4Track&, const G4Step&);
+
+  protected:
+    /// Photons of a scintillation component emitted in a step
+    struct Component {
+      G4int num_photons;
+      G4double time_constant;
+      G4double rise_time;
+      G4PhysicsOrderedFreeVector* spectrum; ///< Integral of the emission spectrum
+      G4ScintillationType type;
+    };
+
+    /// Handle the photons emitted in the step. It is only called
+    /// if there are any, with the particle change initialized.
+    virtual void Emit(const G4Track&, const G4Step&,
+                      const std::vector<Component>&) = 0;
+
+    /// Fraction of the step where a photon is emitted: random for
+    /// charged particles, the end of the step for neutral ones
+    G4double SampleFraction(const G4Track&) const;
+
+    /// Emission time of a photon of the component
+    /// emitted at the given fraction of the step
+    G4double SampleTime(const G4Step&, G4double fraction, const Component&) const;
+
+    /// Create a photon of the component as G4Scintillation does,
+    /// with the given statistical weight
+    G4Track* CreatePhoton(const G4Track&, const G4Step&,
+                          const Component&, G4double weight) const;
+
+    /// The wrapped process
+    G4Scintillation* GetScintillation() const;
+
+  protected:
+    G4ParticleChange* particle_change_;
+
+  private:
+    /// Compute the number of photons of each component of the step.
+    /// False if no photon is emitted.
+    G4bool ComputeComponents(const G4Track&, const G4Step&);
+
+    /// Emission time after the excitation for a finite rise time
+    G4double SampleRiseTime(G4double rise_time, G4double decay_time) const;
+
+  private:
+    std::vector<Component> components_;
+  };
+
+} // end namespace nexus
+
+#endif
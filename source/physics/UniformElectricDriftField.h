@@ -46,6 +46,8 @@ namespace nexus {
     void SetCathodePosition(G4double);
     G4double GetCathodePosition() const;
 
+    EAxis GetAxis() const;
+
     void SetDriftVelocity(G4double);
     G4double GetDriftVelocity() const;
 
@@ -101,6 +103,9 @@ namespace nexus {
   inline G4double UniformElectricDriftField::GetCathodePosition() const
   { return cathode_pos_; }
 
+  inline EAxis UniformElectricDriftField::GetAxis() const
+  { return axis_; }
+
   inline void UniformElectricDriftField::SetDriftVelocity(G4double dv)
   { drift_velocity_ = dv; }
 
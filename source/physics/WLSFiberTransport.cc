@@ -0,0 +1,260 @@
+// ----------------------------------------------------------------------------
+// nexus | WLSFiberTransport.cc
+//
+// Fast simulation model for the transport of optical photons along the core
+// of a wavelength shifting fiber. Photons trapped by total internal
+// reflection are moved in one go close to the fiber end they travel to,
+// with the corresponding time of flight and attenuation. The core must be
+// a full cylinder or cylindrical shell, where the transverse position
+// the photon reaches the end with is computed from its helical path.
+// The last stretch, including the detection by the fiber sensor, is
+// tracked as usual.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "WLSFiberTransport.h"
+
+#include <G4OpticalPhoton.hh>
+#include <G4Material.hh>
+#include <G4MaterialPropertiesTable.hh>
+#include <G4LogicalVolume.hh>
+#include <G4Region.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4Tubs.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+#include <Randomize.hh>
+
+
+namespace nexus {
+
+  namespace {
+
+    /// Value of a material property at the given photon
+    /// energy, or 0 if the material does not define it
+    G4double PropertyValue(const G4Material* material,
+                           const G4String& name, G4double energy)
+    {
+      G4MaterialPropertiesTable* mpt = material->GetMaterialPropertiesTable();
+      if (!mpt) return 0.;
+      G4MaterialPropertyVector* property = mpt->GetProperty(name);
+      if (!property) return 0.;
+      return property->Value(energy);
+    }
+
+
+    /// Move a photon the given transverse distance inside a tube of
+    /// radii r_in and r_out, reflecting it on both walls. The reflections
+    /// keep the distance b from the path to the axis, so the path is made
+    /// of identical chords rotated by a constant angle around the axis.
+    void PropagateInTube(G4double r_in, G4double r_out, G4double distance,
+                         G4ThreeVector& position, G4ThreeVector& direction)
+    {
+      G4double s = direction.perp();
+      if (s <= 0. || distance <= 0.) return;
+
+      G4ThreeVector u(direction.x()/s, direction.y()/s, 0.);
+      G4ThreeVector p(position.x(), position.y(), 0.);
+
+      // Position along the current chord, measured from
+      // its point of closest approach to the axis
+      G4double t0 = p.dot(u);
+      G4double lz = p.x() * u.y() - p.y() * u.x();
+      G4double b  = std::min(std::abs(lz), r_out);
+      G4double sense = (lz < 0.) ? -1. : 1.;
+
+      G4double t_out = std::sqrt(r_out*r_out - b*b);
+      G4bool hits_inner = (b < r_in);
+      G4double t_in = hits_inner ? std::sqrt(r_in*r_in - b*b) : 0.;
+
+      // Walk to the first wall
+      G4bool on_outer = !(hits_inner && t0 < 0.);
+      G4double first = std::max((on_outer ? t_out : -t_in) - t0, 0.);
+      if (distance <= first) {
+        p += distance * u;
+        position.setX(p.x());
+        position.setY(p.y());
+        return;
+      }
+
+      // Length of the chords between consecutive reflections
+      // and angle between their end points
+      G4double chord, dphi;
+      if (hits_inner) {
+        chord = t_out - t_in;
+        dphi  = std::atan2(t_out, b) - std::atan2(t_in, b);
+      }
+      else {
+        chord = 2. * t_out;
+        dphi  = 2. * std::atan2(t_out, b);
+      }
+
+      G4ThreeVector hit = p + first * u;
+      if (chord <= 0.) { // Grazing the outer wall
+        position.setX(hit.x());
+        position.setY(hit.y());
+        return;
+      }
+
+      // Skip the whole chords and walk the rest of the last one
+      G4double rest = distance - first;
+      G4double n = std::floor(rest / chord);
+      rest -= n * chord;
+      if (hits_inner && std::fmod(n, 2.) == 1.) on_outer = !on_outer;
+
+      G4double phi = hit.phi() + sense * n * dphi;
+      G4double r_from = on_outer ? r_out : r_in;
+      G4double r_to   = (hits_inner && on_outer) ? r_in : r_out;
+      G4ThreeVector from(r_from * std::cos(phi), r_from * std::sin(phi), 0.);
+      G4ThreeVector to(r_to * std::cos(phi + sense * dphi),
+                       r_to * std::sin(phi + sense * dphi), 0.);
+
+      G4ThreeVector v = (to - from).unit();
+      p = from + rest * v;
+
+      position.setX(p.x());
+      position.setY(p.y());
+      direction.setX(s * v.x());
+      direction.setY(s * v.y());
+    }
+
+  }
+
+
+
+  WLSFiberTransport::WLSFiberTransport(G4Region* region):
+    G4VFastSimulationModel(GetModelName(), region),
+    end_margin_(1.*mm)
+  {
+    // The transverse path of the photons is
+    // only computed for cylindrical cores
+    std::vector<G4LogicalVolume*>::iterator it = region->GetRootLogicalVolumeIterator();
+    for (size_t i=0; i<region->GetNumberOfRootVolumes(); ++i, ++it) {
+      G4Tubs* tube = dynamic_cast<G4Tubs*>((*it)->GetSolid());
+      if (!tube || tube->GetDeltaPhiAngle() < twopi) {
+        G4Exception("[WLSFiberTransport]", "WLSFiberTransport()", FatalException,
+                    ("The fiber core " + (*it)->GetName() +
+                     " must be a full cylinder or cylindrical shell.").c_str());
+      }
+    }
+  }
+
+
+
+  WLSFiberTransport::~WLSFiberTransport()
+  {
+  }
+
+
+
+  G4String WLSFiberTransport::GetModelName()
+  {
+    return "WLSFiberTransport";
+  }
+
+
+
+  G4bool WLSFiberTransport::IsApplicable(const G4ParticleDefinition& pdef)
+  {
+    return (&pdef == G4OpticalPhoton::Definition());
+  }
+
+
+
+  G4bool WLSFiberTransport::ModelTrigger(const G4FastTrack& ftrack)
+  {
+    // Photons in the daughters of the core (e.g., a mirrored end)
+    // are left to the usual tracking
+    const G4Track* track = ftrack.GetPrimaryTrack();
+    if (track->GetVolume() != ftrack.GetEnvelopePhysicalVolume()) return false;
+
+    const G4Material* core = ftrack.GetEnvelopeLogicalVolume()->GetMaterial();
+    const G4Material* clad = ftrack.GetEnvelopePhysicalVolume()->GetMotherLogical()->GetMaterial();
+
+    G4double energy = track->GetKineticEnergy();
+    G4double n_core = PropertyValue(core, "RINDEX", energy);
+    G4double n_clad = PropertyValue(clad, "RINDEX", energy);
+    if (n_core <= 0. || n_clad <= 0. || n_clad >= n_core) return false;
+
+    // A photon whose angle to the fiber axis is below the complement of
+    // the critical angle is totally reflected at any side of the core,
+    // however skew its path.
+    // Photons trapped only by a skew path or by an outer cladding are
+    // tracked as usual.
+    if (std::abs(ftrack.GetPrimaryTrackLocalDirection().z()) < n_clad / n_core)
+      return false;
+
+    return (DistanceToEnd(ftrack) > 2. * end_margin_);
+  }
+
+
+
+  void WLSFiberTransport::DoIt(const G4FastTrack& ftrack, G4FastStep& fstep)
+  {
+    const G4Track* track = ftrack.GetPrimaryTrack();
+    const G4Material* core = ftrack.GetEnvelopeLogicalVolume()->GetMaterial();
+    G4double energy = track->GetKineticEnergy();
+
+    G4ThreeVector position  = ftrack.GetPrimaryTrackLocalPosition();
+    G4ThreeVector direction = ftrack.GetPrimaryTrackLocalDirection();
+    G4double dir_z = direction.z();
+
+    G4double distance = DistanceToEnd(ftrack) - end_margin_;
+    G4double path_length = distance / std::abs(dir_z);
+
+    // Absorption in the core. Photons absorbed by the shifter are counted
+    // as lost: the light trapped in the fiber has already been shifted
+    // and is hardly absorbed again.
+    G4double attenuation = 0.;
+    G4double abs_length = PropertyValue(core, "ABSLENGTH", energy);
+    G4double wls_length = PropertyValue(core, "WLSABSLENGTH", energy);
+    if (abs_length > 0.) attenuation += 1. / abs_length;
+    if (wls_length > 0.) attenuation += 1. / wls_length;
+
+    if (attenuation > 0.) {
+      G4double absorption = -std::log(G4UniformRand()) / attenuation;
+      if (absorption < path_length) {
+        fstep.KillPrimaryTrack();
+        fstep.ProposePrimaryTrackPathLength(absorption);
+        return;
+      }
+    }
+
+    // Time of flight at the group velocity of the photon
+    G4double velocity = PropertyValue(core, "GROUPVEL", energy);
+    if (velocity <= 0.) velocity = c_light / PropertyValue(core, "RINDEX", energy);
+
+    // The photon winds around the axis of the core as it is
+    // reflected, so it reaches the end at a different azimuth.
+    // The polarization is turned as much as the direction.
+    const G4Tubs* core_solid = static_cast<const G4Tubs*>(ftrack.GetEnvelopeSolid());
+    G4double dir_phi = direction.phi();
+    PropagateInTube(core_solid->GetInnerRadius(), core_solid->GetOuterRadius(),
+                    path_length * direction.perp(), position, direction);
+    position.setZ(position.z() + (dir_z > 0. ? distance : -distance));
+
+    G4ThreeVector polarization =
+      ftrack.GetInverseAffineTransformation()->TransformAxis(track->GetPolarization());
+    polarization.rotateZ(direction.phi() - dir_phi);
+
+    fstep.ProposePrimaryTrackFinalPosition(position);
+    fstep.ProposePrimaryTrackFinalMomentumDirection(direction);
+    fstep.ProposePrimaryTrackFinalPolarization(polarization);
+    fstep.ProposePrimaryTrackFinalTime(track->GetGlobalTime() + path_length / velocity);
+    fstep.ProposePrimaryTrackPathLength(path_length);
+  }
+
+
+
+  G4double WLSFiberTransport::DistanceToEnd(const G4FastTrack& ftrack) const
+  {
+    G4ThreeVector pmin, pmax;
+    ftrack.GetEnvelopeSolid()->BoundingLimits(pmin, pmax);
+
+    G4double z = ftrack.GetPrimaryTrackLocalPosition().z();
+    return (ftrack.GetPrimaryTrackLocalDirection().z() > 0.) ? pmax.z() - z : z - pmin.z();
+  }
+
+
+} // end namespace nexus
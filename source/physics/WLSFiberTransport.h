@@ -0,0 +1,58 @@
+// ----------------------------------------------------------------------------
+// nexus | WLSFiberTransport.h
+//
+// Fast simulation model for the transport of optical photons along the core
+// of a wavelength shifting fiber. Photons trapped by total internal
+// reflection are moved in one go close to the fiber end they travel to,
+// with the corresponding time of flight and attenuation. The core must be
+// a full cylinder or cylindrical shell, where the transverse position
+// the photon reaches the end with is computed from its helical path.
+// The last stretch, including the detection by the fiber sensor, is
+// tracked as usual.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef WLS_FIBER_TRANSPORT_H
+#define WLS_FIBER_TRANSPORT_H
+
+#include <G4VFastSimulationModel.hh>
+
+
+namespace nexus {
+
+  class WLSFiberTransport: public G4VFastSimulationModel
+  {
+  public:
+    /// Constructor. The root logical volumes of the region must be
+    /// fiber cores made of a G4Tubs spanning 360 degrees, with their
+    /// axis along the local z axis.
+    WLSFiberTransport(G4Region* region);
+    /// Destructor
+    ~WLSFiberTransport();
+
+    /// This model is only valid for optical photons
+    G4bool IsApplicable(const G4ParticleDefinition&);
+
+    /// True for photons trapped in the core that are not
+    /// already close to the end they travel to
+    G4bool ModelTrigger(const G4FastTrack&);
+
+    /// Move the photon along the fiber or absorb it
+    void DoIt(const G4FastTrack&, G4FastStep&);
+
+    /// Name of the model, used to find out whether it is in use
+    static G4String GetModelName();
+
+  private:
+    /// Distance along the fiber axis from the photon to the end
+    /// of the core it travels to
+    G4double DistanceToEnd(const G4FastTrack&) const;
+
+  private:
+    G4double end_margin_; ///< Length of the core ends tracked as usual
+  };
+
+} // end namespace nexus
+
+#endif
@@ -14,6 +14,7 @@
 // ----------------------------------------------------------------------------
 
 #include "WavelengthShifting.h"
+#include "IntegralTableIO.h"
 
 #include <G4OpticalPhoton.hh>
 #include <Randomize.hh>
@@ -26,24 +27,19 @@ namespace nexus {
   using namespace CLHEP;
 
   WavelengthShifting::WavelengthShifting(const G4String& name, G4ProcessType type):
-    G4VDiscreteProcess(name, type), wlsIntegralTable_(0)
+    G4VDiscreteProcess(name, type), wlsIntegralTable_(0), table_retrieved_(false)
   {
     ParticleChange_ = new G4ParticleChange();
     pParticleChange = ParticleChange_;
 
     WLSTimeGeneratorProfile_ =
       new G4WLSTimeGeneratorProfileExponential("WLSTimeGeneratorProfileExponential");
-
-    BuildThePhysicsTable();
   }
 
   WavelengthShifting::~WavelengthShifting()
   {
     delete ParticleChange_;
-    if (wlsIntegralTable_ != 0) {
-      wlsIntegralTable_->clearAndDestroy();
-      delete wlsIntegralTable_;
-    }
+    DeleteIntegralTable(wlsIntegralTable_);
     delete WLSTimeGeneratorProfile_;
   }
 
@@ -52,6 +48,38 @@ namespace nexus {
     return ( &aParticleType == G4OpticalPhoton::Definition() );
   }
 
+  void WavelengthShifting::PreparePhysicsTable(const G4ParticleDefinition&)
+  {
+    table_retrieved_ = false;
+  }
+
+  void WavelengthShifting::BuildPhysicsTable(const G4ParticleDefinition&)
+  {
+    if (!table_retrieved_) BuildThePhysicsTable();
+  }
+
+  G4bool WavelengthShifting::StorePhysicsTable(const G4ParticleDefinition* pdef,
+                                               const G4String& directory, G4bool ascii)
+  {
+    G4String filename =
+      GetPhysicsTableFileName(pdef, directory, "WLSIntegral", ascii);
+    return StoreIntegralTable(wlsIntegralTable_, filename);
+  }
+
+  G4bool WavelengthShifting::RetrievePhysicsTable(const G4ParticleDefinition* pdef,
+                                                  const G4String& directory, G4bool ascii)
+  {
+    G4String filename =
+      GetPhysicsTableFileName(pdef, directory, "WLSIntegral", ascii);
+    G4PhysicsTable* table = RetrieveIntegralTable(filename);
+    if (!table) return false;
+
+    DeleteIntegralTable(wlsIntegralTable_);
+    wlsIntegralTable_ = table;
+    table_retrieved_ = true;
+    return true;
+  }
+
   G4VParticleChange* WavelengthShifting::PostStepDoIt(const G4Track& track,const G4Step& step)
   {
     ParticleChange_->Initialize(track);
@@ -152,15 +180,13 @@ namespace nexus {
 
   void WavelengthShifting::BuildThePhysicsTable()
   {
-    if (wlsIntegralTable_) return;
-
     const G4MaterialTable* theMaterialTable =
       G4Material::GetMaterialTable();
     G4int numOfMaterials = G4Material::GetNumberOfMaterials();
 
-    // create new physics table
-    if(!wlsIntegralTable_)
-      wlsIntegralTable_ = new G4PhysicsTable(numOfMaterials);
+    // create new physics table, replacing the previous one
+    DeleteIntegralTable(wlsIntegralTable_);
+    wlsIntegralTable_ = new G4PhysicsTable(numOfMaterials);
 
     // loop for materials
 
@@ -36,6 +36,13 @@ namespace nexus {
     G4VParticleChange* PostStepDoIt(const G4Track& aTrack, const G4Step& aStep);
     G4double GetMeanFreePath(const G4Track& track, G4double, G4ForceCondition*);
 
+    // Integral table of the WLS spectra, which can be kept in the physics-table cache.
+    // It is built again at every build of the physics tables, unless retrieved for it.
+    void PreparePhysicsTable(const G4ParticleDefinition&);
+    void BuildPhysicsTable(const G4ParticleDefinition&);
+    G4bool StorePhysicsTable(const G4ParticleDefinition*, const G4String& directory, G4bool ascii);
+    G4bool RetrievePhysicsTable(const G4ParticleDefinition*, const G4String& directory, G4bool ascii);
+
   private:
     void BuildThePhysicsTable();
     void ComputeCumulativeDistribution(const G4MaterialPropertyVector& pdf, G4PhysicsOrderedFreeVector& cdf);
@@ -43,6 +50,7 @@ namespace nexus {
   private:
     G4ParticleChange* ParticleChange_;
     G4PhysicsTable* wlsIntegralTable_;
+    G4bool table_retrieved_;
     G4VWLSTimeGeneratorProfile*  WLSTimeGeneratorProfile_;
 
   };
@@ -0,0 +1,66 @@
+// ----------------------------------------------------------------------------
+// nexus | WeightedScintillation.cc
+//
+// Wrapper around the Geant4 scintillation process that tracks only
+// one photon out of every W, with statistical weight W (photon bunching).
+// The number of photons kept is drawn before any of them is created.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "WeightedScintillation.h"
+
+#include <G4Scintillation.hh>
+#include <G4ParticleChange.hh>
+#include <Randomize.hh>
+
+
+namespace nexus {
+
+
+  WeightedScintillation::WeightedScintillation(G4double weight,
+                                               const G4String& process_name):
+    ScintillationBase(process_name), weight_(weight)
+  {
+    particle_change_->SetSecondaryWeightByProcess(true);
+  }
+
+
+
+  WeightedScintillation::~WeightedScintillation()
+  {
+  }
+
+
+
+  void WeightedScintillation::Emit(const G4Track& track, const G4Step& step,
+                                   const std::vector<Component>& components)
+  {
+    G4Scintillation* scint = GetScintillation();
+    if (!scint->GetStackPhotons()) return;
+
+    // Every photon is kept independently with probability 1/W, so the
+    // number kept of each component is binomial on the number emitted
+    std::vector<G4int> num_kept;
+    G4int total = 0;
+    for (auto& component : components) {
+      G4int n = component.num_photons > 0 ?
+        G4int(CLHEP::RandBinomial::shoot(component.num_photons, 1. / weight_)) : 0;
+      num_kept.push_back(n);
+      total += n;
+    }
+
+    if (total == 0) return;
+
+    particle_change_->SetNumberOfSecondaries(total);
+
+    G4double weight = weight_ * track.GetWeight();
+    for (size_t i=0; i<components.size(); i++)
+      for (G4int j=0; j<num_kept[i]; j++)
+        particle_change_->AddSecondary(CreatePhoton(track, step, components[i], weight));
+
+    if (scint->GetTrackSecondariesFirst() && track.GetTrackStatus() == fAlive)
+      particle_change_->ProposeTrackStatus(fSuspend);
+  }
+
+} // end namespace nexus
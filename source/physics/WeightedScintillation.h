@@ -0,0 +1,38 @@
+// ----------------------------------------------------------------------------
+// nexus | WeightedScintillation.h
+//
+// Wrapper around the Geant4 scintillation process that tracks only
+// one photon out of every W, with statistical weight W (photon bunching).
+// The number of photons kept is drawn before any of them is created.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef WEIGHTED_SCINTILLATION_H
+#define WEIGHTED_SCINTILLATION_H
+
+#include "ScintillationBase.h"
+
+
+namespace nexus {
+
+  class WeightedScintillation: public ScintillationBase
+  {
+  public:
+    /// Constructor, taking the weight W of every tracked photon
+    WeightedScintillation(G4double weight,
+                          const G4String& process_name="Scintillation");
+    /// Destructor
+    ~WeightedScintillation();
+
+  private:
+    /// Keep each photon with probability 1/W and create only those
+    void Emit(const G4Track&, const G4Step&, const std::vector<Component>&);
+
+  private:
+    G4double weight_; ///< Statistical weight of every tracked photon
+  };
+
+} // end namespace nexus
+
+#endif
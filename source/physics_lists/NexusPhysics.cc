@@ -13,6 +13,9 @@
 #include "IonizationDrift.h"
 #include "Electroluminescence.h"
 #include "OpPhotoelectricEffect.h"
+#include "WeightedScintillation.h"
+#include "S1TableScintillation.h"
+#include "WLSFiberTransport.h"
 
 #include <G4GenericMessenger.hh>
 #include <G4OpticalPhoton.hh>
@@ -20,6 +23,7 @@
 #include <G4ProcessTable.hh>
 #include <G4StepLimiter.hh>
 #include <G4FastSimulationManagerProcess.hh>
+#include <G4GlobalFastSimulationManager.hh>
 #include <G4PhysicsConstructorFactory.hh>
 
 
@@ -33,7 +37,8 @@ namespace nexus {
 
   NexusPhysics::NexusPhysics():
     G4VPhysicsConstructor("NexusPhysics"),
-    clustering_(true), drift_(true), electroluminescence_(true), photoelectric_(false)
+    clustering_(true), drift_(true), electroluminescence_(true), photoelectric_(false),
+    photon_weight_(1.), s1_table_(""), s1_full_tracking_(false)
   {
     msg_ = new G4GenericMessenger(this, "/PhysicsList/Nexus/",
       "Control commands of the nexus physics list.");
@@ -50,6 +55,18 @@ namespace nexus {
     msg_->DeclareProperty("photoelectric", photoelectric_,
       "Switch on/off the photoelectric effect.");
 
+    G4GenericMessenger::Command& weight_cmd =
+      msg_->DeclareProperty("photon_weight", photon_weight_,
+        "Number of EL and scintillation photons represented by each tracked photon.");
+    weight_cmd.SetParameterName("photon_weight", false);
+    weight_cmd.SetRange("photon_weight>=1.");
+
+    msg_->DeclareProperty("s1_table", s1_table_,
+      "S1 light table from which the detected scintillation photons are sampled, instead of tracking them.");
+
+    msg_->DeclareProperty("s1_full_tracking", s1_full_tracking_,
+      "Track the scintillation photons even if an S1 table is given (for validation).");
+
   }
 
 
@@ -96,9 +113,32 @@ namespace nexus {
 
     if (electroluminescence_) {
       Electroluminescence* el = new Electroluminescence();
+      el->SetPhotonWeight(photon_weight_);
       pmanager->AddDiscreteProcess(el);
     }
 
+    // Replace the scintillation process, if any, by the S1 table
+    // fast simulation or by its weighted version
+
+    if (s1_table_ != "" && !s1_full_tracking_) {
+      S1TableScintillation* s1 = new S1TableScintillation(s1_table_);
+      if (!WrapScintillation(s1)) {
+        delete s1;
+        G4Exception("[NexusPhysics]", "ConstructProcess()", JustWarning,
+          "No scintillation process found: the S1 table will not be used. "
+          "G4OpticalPhysics has to be registered before NexusPhysics.");
+      }
+    }
+    else if (photon_weight_ > 1.) {
+      WeightedScintillation* wscint = new WeightedScintillation(photon_weight_);
+      if (!WrapScintillation(wscint)) {
+        delete wscint;
+        G4Exception("[NexusPhysics]", "ConstructProcess()", JustWarning,
+          "No scintillation process found: the photon weight will only apply to EL. "
+          "G4OpticalPhysics has to be registered before NexusPhysics.");
+      }
+    }
+
 
     // Add clustering to all pertinent particles
 
@@ -119,6 +159,16 @@ namespace nexus {
       }
     }
 
+    // Parametrize the transport of optical photons in the regions where
+    // the geometry has attached a fast simulation model (WLS fibers).
+    // The geometry is always constructed before the physics processes.
+
+    if (G4GlobalFastSimulationManager::GetGlobalFastSimulationManager()->
+        GetFastSimulationModel(WLSFiberTransport::GetModelName())) {
+      pmanager = G4OpticalPhoton::Definition()->GetProcessManager();
+      pmanager->AddDiscreteProcess(new G4FastSimulationManagerProcess());
+    }
+
     // Add photoelectric effect to optical photons
 
     if (photoelectric_) {
@@ -137,4 +187,34 @@ namespace nexus {
     }
   }
 
+
+
+  G4bool NexusPhysics::WrapScintillation(G4WrapperProcess* wrapper)
+  {
+    G4bool found = false;
+
+    auto aParticleIterator = GetParticleIterator();
+    aParticleIterator->reset();
+    while ((*aParticleIterator)()) {
+      G4ParticleDefinition* particle = aParticleIterator->value();
+      G4VProcess* scint = G4ProcessTable::GetProcessTable()->
+        FindProcess("Scintillation", particle);
+      if (!scint || scint == wrapper) continue;
+
+      if (!found) {
+        wrapper->RegisterProcess(scint);
+        wrapper->SetProcessSubType(scint->GetProcessSubType());
+        found = true;
+      }
+
+      G4ProcessManager* pmanager = particle->GetProcessManager();
+      pmanager->RemoveProcess(scint);
+      pmanager->AddProcess(wrapper);
+      pmanager->SetProcessOrderingToLast(wrapper, idxAtRest);
+      pmanager->SetProcessOrderingToLast(wrapper, idxPostStep);
+    }
+
+    return found;
+  }
+
 } // end namespace nexus
@@ -12,6 +12,7 @@
 #include <G4VPhysicsConstructor.hh>
 
 class G4GenericMessenger;
+class G4WrapperProcess;
 
 
 namespace nexus {
@@ -29,11 +30,19 @@ namespace nexus {
     /// Construct all required physics processes (Geant4 mandatory method)
     virtual void ConstructProcess();
 
+  private:
+    /// Replace the scintillation process of all particles by a wrapper
+    /// around it. Returns false if no scintillation process was found.
+    G4bool WrapScintillation(G4WrapperProcess*);
+
   private:
     G4bool clustering_;          ///< Switch on/of the ionization clustering
     G4bool drift_;               ///< Switch on/of the ionization drift
     G4bool electroluminescence_; ///< Switch on/off the electroluminescence
     G4bool photoelectric_;       ///< Switch on/off the photoelectric effect
+    G4double photon_weight_;     ///< Weight of the tracked EL and scintillation photons
+    G4String s1_table_;          ///< S1 light table replacing the tracking of scintillation photons
+    G4bool s1_full_tracking_;    ///< Track the scintillation photons even if an S1 table is given
 
     G4GenericMessenger* msg_;
   };
@@ -0,0 +1,102 @@
+// ----------------------------------------------------------------------------
+// nexus | LightTableHits.cc
+//
+// Gives access to the sensor hits of the current event of the sensors
+// of a light table, so that a parametrized response can be added to them.
+// The hits belong to the collections of the corresponding SensorSD,
+// and are shared with the optical photons detected in the usual way.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "LightTableHits.h"
+
+#include "SensorSD.h"
+#include "SensorHit.h"
+
+#include <G4SDManager.hh>
+#include <G4HCofThisEvent.hh>
+#include <G4EventManager.hh>
+#include <G4Event.hh>
+
+
+namespace nexus {
+
+
+  LightTableHits::LightTableHits(const LightTable& table):
+    LightTableHits(table.GetSensors())
+  {
+  }
+
+
+
+  LightTableHits::LightTableHits(const std::vector<LightTable::Sensor>& sensors):
+    sensors_(sensors), event_id_(-1)
+  {
+    AddNewSensors();
+  }
+
+
+
+  void LightTableHits::AddNewSensors()
+  {
+    G4SDManager* sdmgr = G4SDManager::GetSDMpointer();
+
+    for (size_t i=hcids_.size(); i<sensors_.size(); ++i) {
+      const LightTable::Sensor& sensor = sensors_[i];
+      SensorSD* sd = dynamic_cast<SensorSD*>
+        (sdmgr->FindSensitiveDetector(sensor.sd_name, false));
+      if (!sd) {
+        G4Exception("[LightTableHits]", "AddNewSensors()", FatalException,
+                    ("The sensitive detector " + sensor.sd_name +
+                     " of the light table is not in the geometry.").c_str());
+      }
+      hcids_.push_back(sdmgr->GetCollectionID(sensor.sd_name + "/" +
+                                              SensorSD::GetCollectionUniqueName()));
+      binsizes_.push_back(sd->GetTimeBinning());
+    }
+
+    hits_.resize(hcids_.size(), 0);
+  }
+
+
+
+  LightTableHits::~LightTableHits()
+  {
+  }
+
+
+
+  SensorHit* LightTableHits::GetHit(G4int isensor, G4HCofThisEvent* hce)
+  {
+    G4int event_id = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+    if (event_id != event_id_) {
+      hits_.assign(hcids_.size(), 0);
+      event_id_ = event_id;
+    }
+
+    if (isensor >= G4int(hcids_.size())) AddNewSensors();
+    if (hits_[isensor]) return hits_[isensor];
+
+    SensorHitsCollection* hits =
+      static_cast<SensorHitsCollection*>(hce->GetHC(hcids_[isensor]));
+    if (!hits) return 0;
+
+    // The hit may have been created by a detected photon
+    // or by another light table
+    const LightTable::Sensor& sensor = sensors_[isensor];
+    for (size_t i=0; i<hits->entries(); ++i) {
+      if ((*hits)[i]->GetSensorID() == sensor.id) {
+        hits_[isensor] = (*hits)[i];
+        return hits_[isensor];
+      }
+    }
+
+    SensorHit* hit = new SensorHit(sensor.id, sensor.position, binsizes_[isensor]);
+    hits->insert(hit);
+    hits_[isensor] = hit;
+    return hit;
+  }
+
+
+} // end namespace nexus
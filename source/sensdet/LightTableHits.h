@@ -0,0 +1,65 @@
+// ----------------------------------------------------------------------------
+// nexus | LightTableHits.h
+//
+// Gives access to the sensor hits of the current event of the sensors
+// of a light table, so that a parametrized response can be added to them.
+// The hits belong to the collections of the corresponding SensorSD,
+// and are shared with the optical photons detected in the usual way.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef LIGHT_TABLE_HITS_H
+#define LIGHT_TABLE_HITS_H
+
+#include "LightTable.h"
+
+#include <vector>
+
+class G4HCofThisEvent;
+
+
+namespace nexus {
+
+  class SensorHit;
+
+  class LightTableHits
+  {
+  public:
+    /// Constructor. The sensitive detectors of all the
+    /// sensors of the table must exist.
+    LightTableHits(const LightTable&);
+    /// Constructor for a list of sensors, which may grow
+    /// as long as this object is alive
+    LightTableHits(const std::vector<LightTable::Sensor>&);
+    /// Destructor
+    ~LightTableHits();
+
+    /// Time binning of a sensor of the table
+    G4double GetBinSize(G4int isensor) const;
+
+    /// Hit of the current event of a sensor of the table,
+    /// which is created if the sensor has no hit yet
+    SensorHit* GetHit(G4int isensor, G4HCofThisEvent*);
+
+  private:
+    /// Find the hits collection and time binning of
+    /// the sensors added to the list since last call
+    void AddNewSensors();
+
+  private:
+    const std::vector<LightTable::Sensor>& sensors_;
+
+    std::vector<G4int> hcids_;       ///< Hits collection of each sensor
+    std::vector<G4double> binsizes_; ///< Time binning of each sensor
+
+    std::vector<SensorHit*> hits_; ///< Hits of the current event, found so far
+    G4int event_id_; ///< ID of the current event
+  };
+
+  inline G4double LightTableHits::GetBinSize(G4int isensor) const
+  { return binsizes_[isensor]; }
+
+} // end namespace nexus
+
+#endif
@@ -9,6 +9,10 @@
 
 #include "SensorSD.h"
 
+#include "RandomUtils.h"
+#include "OpticalAcceptanceMap.h"
+#include "ELResponseCache.h"
+
 #include <G4OpticalPhoton.hh>
 #include <G4SDManager.hh>
 #include <G4ProcessManager.hh>
@@ -85,8 +89,21 @@ namespace nexus {
       HC_->insert(hit);
     }
 
+    // A weighted photon stands for several detected photons. Non-integer
+    // weights are rounded at random so that the mean charge is kept.
     G4double time = step->GetPostStepPoint()->GetGlobalTime();
-    hit->Fill(time);
+    G4double weight = step->GetTrack()->GetWeight();
+    G4int counts = (weight == 1.) ? 1 : RandomRound(weight);
+    if (counts > 0) hit->Fill(time, counts);
+
+    // Feed the optical acceptance map, if it is being built
+    if (OpticalAcceptanceMap* map = OpticalAcceptanceMap::Building())
+      map->RecordDetection(step->GetTrack()->GetTrackID());
+
+    // Teach the EL response cache, if the photon comes from a learning electron
+    ELResponseCache* cache = ELResponseCache::Learning();
+    if (cache && counts > 0)
+      cache->RecordDetection(*step->GetTrack(), GetName(), hit, counts);
 
     return true;
   }
@@ -0,0 +1,25 @@
+#include "OpticalMaterialProperties.h"
+
+#include <G4MaterialPropertiesTable.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <catch.hpp>
+
+
+TEST_CASE("OpticalMaterialProperties::SharedTables") {
+  // Tables built with the same parameters are shared,
+  // those built with different parameters are not
+
+  G4MaterialPropertiesTable* gxe = opticalprops::GXe(15 * bar, 295 * kelvin);
+
+  REQUIRE(opticalprops::GXe(15 * bar, 295 * kelvin) == gxe);
+  REQUIRE(opticalprops::GXe(10 * bar, 295 * kelvin) != gxe);
+  REQUIRE(opticalprops::GXe(15 * bar, 295 * kelvin, 1000/MeV) != gxe);
+
+  G4MaterialPropertiesTable* grid = opticalprops::FakeGrid(15 * bar, 295 * kelvin, .95);
+  REQUIRE(grid != gxe);
+  REQUIRE(opticalprops::FakeGrid(15 * bar, 295 * kelvin, .95) == grid);
+  REQUIRE(grid->GetProperty("RINDEX") == gxe->GetProperty("RINDEX"));
+
+  REQUIRE(opticalprops::TPB() == opticalprops::TPB());
+}
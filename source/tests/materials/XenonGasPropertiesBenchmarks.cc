@@ -0,0 +1,13 @@
+#include "XenonProperties.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <catch.hpp>
+
+// Benchmark of the xenon density lookup.
+// It is built into nexus-test-bench.
+
+TEST_CASE("XenonProperties benchmarks", "[bench]") {
+
+  BENCHMARK("GetGasDensity") { return GetGasDensity(15.*bar, 295.*kelvin); };
+}
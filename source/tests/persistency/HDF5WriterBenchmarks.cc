@@ -0,0 +1,33 @@
+#include "HDF5Writer.h"
+
+#include <catch.hpp>
+
+#include <filesystem>
+
+// Benchmarks of the writing of the rows of an event to the output file.
+// They are built into nexus-test-bench.
+
+TEST_CASE("HDF5Writer benchmarks", "[bench]") {
+
+  std::string filename =
+    (std::filesystem::temp_directory_path() / "nexus_hdf5writer_bench.h5").string();
+
+  nexus::HDF5Writer writer;
+  writer.Open(filename, false, false);
+
+  int64_t event = 0;
+
+  // An event with 1000 sensor time bins and 100 ionization hits
+  BENCHMARK("HDF5Writer event of 1000 sensor rows and 100 hits") {
+    for (unsigned int i=0; i<1000; ++i)
+      writer.WriteSensorDataInfo(event, i % 60, i / 60, 1 + i % 7);
+    for (int i=0; i<100; ++i)
+      writer.WriteHitInfo(false, event, 1, i, 0.1f*i, 0.2f*i, 0.3f*i, 1.f, 0.01f, "", 1);
+    writer.WriteEventIndex(event, 0);
+    writer.Flush();
+    ++event;
+  };
+
+  writer.Close();
+  std::filesystem::remove(filename);
+}
@@ -0,0 +1,47 @@
+#include "ElectroluminescenceFixture.h"
+#include "UniformElectricDriftField.h"
+
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicsOrderedFreeVector.hh>
+#include <G4Track.hh>
+#include <Randomize.hh>
+
+#include <cmath>
+
+#include <catch.hpp>
+
+// Benchmarks of the generation of EL photons: direction, polarization,
+// energy sampled from the spectrum and point along the drift line.
+// They are built into nexus-test-bench.
+
+TEST_CASE("Electroluminescence benchmarks", "[bench]") {
+
+  nexus::Electroluminescence el;
+
+  // Cumulative distribution of a spectrum around 7.2 eV,
+  // with as many points as the xenon one
+  G4PhysicsOrderedFreeVector spectrum_integral;
+  G4double integral = 0.;
+  for (G4int i=0; i<100; ++i) {
+    G4double energy = 6.*eV + i * 0.025*eV;
+    integral += std::exp(-0.5 * std::pow((energy - 7.2*eV) / (0.15*eV), 2));
+    spectrum_integral.InsertValues(energy, integral);
+  }
+
+  nexus::UniformElectricDriftField field(0.*mm, 10.*mm, kZAxis);
+  G4LorentzVector initial_position(0., 0., 10.*mm, 0.);
+  G4LorentzVector final_position  (0., 0.,  0.*mm, 1.*microsecond);
+
+  BENCHMARK("Electroluminescence::CreatePhoton") {
+    G4Track* photon =
+      nexus::ElectroluminescenceFixture::CreatePhoton(el, &field, &spectrum_integral,
+                                                      initial_position, final_position, 1.);
+    G4double energy = photon->GetKineticEnergy();
+    delete photon;
+    return energy;
+  };
+
+  BENCHMARK("EL photon energy") {
+    return spectrum_integral.GetEnergy(G4UniformRand() * spectrum_integral.GetMaxValue());
+  };
+}
@@ -0,0 +1,27 @@
+#ifndef ELECTROLUMINESCENCE_FIXTURE_H
+#define ELECTROLUMINESCENCE_FIXTURE_H
+
+#include "Electroluminescence.h"
+
+// Access to the photon generation of the EL process outside
+// a step, for the unit tests and the benchmarks.
+
+namespace nexus {
+
+  class ElectroluminescenceFixture
+  {
+  public:
+    static G4Track* CreatePhoton(Electroluminescence& el, BaseDriftField* field,
+                                 G4PhysicsOrderedFreeVector* spectrum_integral,
+                                 const G4LorentzVector& initial_position,
+                                 const G4LorentzVector& final_position,
+                                 G4double weight)
+    {
+      return el.CreatePhoton(field, spectrum_integral,
+                             initial_position, final_position, weight);
+    }
+  };
+
+}
+
+#endif
@@ -0,0 +1,61 @@
+#include "ElectroluminescenceFixture.h"
+#include "UniformElectricDriftField.h"
+
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicsOrderedFreeVector.hh>
+#include <G4Track.hh>
+
+#include <catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+
+TEST_CASE("Electroluminescence angular bias weights") {
+
+  nexus::Electroluminescence el;
+
+  G4PhysicsOrderedFreeVector spectrum_integral;
+  spectrum_integral.InsertValues(7.0*eV, 0.);
+  spectrum_integral.InsertValues(7.4*eV, 1.);
+
+  // The electron drifts toward the anode, along -z
+  nexus::UniformElectricDriftField field(0.*mm, 10.*mm, kZAxis);
+  G4LorentzVector initial_position(0., 0., 10.*mm, 0.);
+  G4LorentzVector final_position  (0., 0.,  0.*mm, 1.*microsecond);
+
+  // The weights compensate the bias: averaged over the photons emitted
+  // they give 1 over the whole sphere and the isotropic fraction of the
+  // photons in any other region, such as the hemisphere toward the anode
+  const G4String biases[] = {"none", "anode", "cathode"};
+  const G4double cones[]  = {30.*deg, 90.*deg, 180.*deg};
+  const G4int n = 100000;
+
+  for (const G4String& bias : biases) {
+    for (G4double cone : cones) {
+
+      el.SetAngularBias(bias);
+      el.SetAngularBiasCone(cone);
+      el.SetAngularBiasFraction(0.9);
+
+      G4double sum = 0., sum2 = 0., toward_anode = 0.;
+      for (G4int i=0; i<n; i++) {
+        G4Track* photon =
+          nexus::ElectroluminescenceFixture::CreatePhoton(el, &field, &spectrum_integral,
+                                                          initial_position, final_position, 1.);
+        G4double weight = photon->GetWeight();
+        sum  += weight;
+        sum2 += weight * weight;
+        if (photon->GetMomentumDirection().z() < 0.) toward_anode += weight;
+        delete photon;
+      }
+
+      G4double mean  = sum / n;
+      G4double sigma = std::sqrt(std::max(sum2 / n - mean * mean, 0.) / n);
+
+      INFO("bias " << bias << ", cone " << cone / deg << " deg");
+      REQUIRE(std::abs(mean - 1.) <= 5. * sigma + 1.e-12);
+      REQUIRE(toward_anode / n == Approx(0.5).margin(0.04));
+    }
+  }
+}
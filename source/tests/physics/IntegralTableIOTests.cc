@@ -0,0 +1,61 @@
+#include "IntegralTableIO.h"
+
+#include <G4NistManager.hh>
+#include <G4Material.hh>
+#include <G4PhysicsTable.hh>
+#include <G4PhysicsOrderedFreeVector.hh>
+#include <G4SystemOfUnits.hh>
+
+#include <catch.hpp>
+
+#include <cstdio>
+
+
+TEST_CASE("Integral table store and retrieve") {
+  // The tables kept in the physics-table cache are read back as they were
+  // written, and only for the materials they were built for
+
+  G4NistManager::Instance()->FindOrBuildMaterial("G4_AIR");
+  G4NistManager::Instance()->FindOrBuildMaterial("G4_WATER");
+  size_t nmaterials = G4Material::GetNumberOfMaterials();
+
+  // A cumulative distribution for the first material,
+  // none (an empty vector) for the others
+  G4PhysicsTable* table = new G4PhysicsTable(nmaterials);
+  for (size_t i=0; i<nmaterials; ++i) {
+    G4PhysicsOrderedFreeVector* vector = new G4PhysicsOrderedFreeVector();
+    if (i == 0) {
+      vector->InsertValues(2.0*eV, 0.);
+      vector->InsertValues(2.5*eV, 1./3.);
+      vector->InsertValues(3.0*eV, 1.);
+    }
+    table->insertAt(i, vector);
+  }
+
+  const char* filename = "integral_table_test.dat";
+  REQUIRE(nexus::StoreIntegralTable(table, filename));
+
+  G4PhysicsTable* retrieved = nexus::RetrieveIntegralTable(filename);
+  REQUIRE(retrieved);
+  REQUIRE(retrieved->entries() == nmaterials);
+  for (size_t i=0; i<nmaterials; ++i) {
+    const G4PhysicsVector* stored = (*table)(i);
+    const G4PhysicsVector* read   = (*retrieved)(i);
+    REQUIRE(read->GetVectorLength() == stored->GetVectorLength());
+    for (size_t j=0; j<stored->GetVectorLength(); ++j) {
+      REQUIRE(read->Energy(j) == stored->Energy(j));
+      REQUIRE((*read)[j] == (*stored)[j]);
+    }
+  }
+  nexus::DeleteIntegralTable(retrieved);
+
+  // Once the material table has changed, the stored
+  // table is not valid anymore and must be built again
+  new G4Material("IntegralTableTest", 1., 1.*g/mole, 1.*g/cm3);
+  REQUIRE(!nexus::RetrieveIntegralTable(filename));
+
+  std::remove(filename);
+  REQUIRE(!nexus::RetrieveIntegralTable(filename));
+
+  nexus::DeleteIntegralTable(table);
+}
@@ -0,0 +1,24 @@
+#include "SensorHit.h"
+
+#include <G4SystemOfUnits.hh>
+#include <Randomize.hh>
+
+#include <catch.hpp>
+
+// Benchmarks of the filling of the sensor time histograms.
+// They are built into nexus-test-bench.
+
+TEST_CASE("SensorHit benchmarks", "[bench]") {
+
+  // Detections spread over an S2 signal of 10 microseconds
+  nexus::SensorHit pmt_hit (0,    G4ThreeVector(), 25.*ns);
+  nexus::SensorHit sipm_hit(1000, G4ThreeVector(), 1.*microsecond);
+
+  BENCHMARK("SensorHit::Fill 25 ns bins") {
+    pmt_hit.Fill(10.*microsecond * G4UniformRand());
+  };
+
+  BENCHMARK("SensorHit::Fill 1 mus bins") {
+    sipm_hit.Fill(10.*microsecond * G4UniformRand());
+  };
+}
@@ -0,0 +1,58 @@
+#include <LightTable.h>
+
+#include <catch.hpp>
+
+#include <fstream>
+#include <cstdio>
+
+
+TEST_CASE("Light table interpolation") {
+  // This test checks that the light table values are trilinearly
+  // interpolated and that the table is constant along axes
+  // with a single point
+
+  const char* filename = "light_table_test.csv";
+  std::ofstream file(filename);
+  file << "# test table\n"
+       << "sensor,0,/PMT,0,0,0\n"
+       << "sensor,7,/SiPM,1,1,1\n"
+       << "binning,2,2,1\n"
+       << "region,0,0,5,10,10,5\n"
+       << "point,0,0,0,1,0\n"
+       << "point,1,0,0,0,0\n"
+       << "point,0,1,0,1,2\n"
+       << "point,1,1,0,0,2\n";
+  file.close();
+
+  nexus::LightTable table(filename);
+  std::remove(filename);
+
+  REQUIRE(table.GetSensors().size() == 2);
+  REQUIRE(table.GetSensors()[1].id == 7);
+
+  SECTION ("Center of the table") {
+    G4double values[2] = {0., 0.};
+    table.ForEachSensor(G4ThreeVector(5., 5., 100.),
+                        [&](G4int i, G4double value){ values[i] += value; });
+    REQUIRE(values[0] == Approx(0.5));
+    REQUIRE(values[1] == Approx(1.));
+  }
+
+  SECTION ("Grid point") {
+    G4double values[2] = {0., 0.};
+    table.ForEachSensor(G4ThreeVector(0., 10., 5.),
+                        [&](G4int i, G4double value){ values[i] += value; });
+    REQUIRE(values[0] == Approx(1.));
+    REQUIRE(values[1] == Approx(2.));
+  }
+
+  SECTION ("Outside the table") {
+    REQUIRE_FALSE(table.Contains(G4ThreeVector(11., 0., 5.)));
+    REQUIRE      (table.Contains(G4ThreeVector(10., 10., -3.)));
+
+    G4int calls = 0;
+    table.ForEachSensor(G4ThreeVector(-1., 0., 5.),
+                        [&](G4int, G4double){ ++calls; });
+    REQUIRE(calls == 0);
+  }
+}
@@ -0,0 +1,67 @@
+#include <OpticalAcceptanceMap.h>
+
+#include <G4Track.hh>
+#include <G4DynamicParticle.hh>
+#include <G4OpticalPhoton.hh>
+
+#include <catch.hpp>
+
+#include <cstdio>
+
+
+namespace {
+
+  G4Track* Photon(G4int id, const G4ThreeVector& pos, const G4ThreeVector& dir)
+  {
+    auto particle = new G4DynamicParticle(G4OpticalPhoton::Definition(), dir, 2.5e-6);
+    auto track = new G4Track(particle, 0., pos);
+    track->SetTrackID(id);
+    return track;
+  }
+
+}
+
+
+TEST_CASE("Optical acceptance map") {
+  // This test checks that the map built in a calibration is saved and
+  // read back, and that only the cells with enough emitted photons
+  // and no detections are culled
+
+  const char* filename = "optical_acceptance_test.csv";
+  std::remove(filename);
+
+  const G4ThreeVector region_min(0., 0., 0.), region_max(10., 10., 10.);
+  const G4ThreeVector seen(1., 1., 1.), dark(9., 9., 9.), up(0., 0., 1.);
+
+  {
+    nexus::OpticalAcceptanceMap map(filename, false, region_min, region_max,
+                                    2, 2, 2, 1, 1);
+    REQUIRE(map.IsBuilding());
+    REQUIRE(nexus::OpticalAcceptanceMap::Building() == &map);
+    REQUIRE(map.FindCell(G4ThreeVector(11., 1., 1.), up) == -1);
+
+    for (G4int i=1; i<=10; ++i) {
+      G4Track* photon = Photon(i, i % 2 ? seen : dark, up);
+      map.RegisterPhoton(photon, false);
+      delete photon;
+    }
+    // Every photon counts once, however many times it is detected
+    map.RecordDetection(1);
+    map.RecordDetection(1);
+    map.ClearEvent();
+  }
+
+  REQUIRE(nexus::OpticalAcceptanceMap::Building() == 0);
+
+  nexus::OpticalAcceptanceMap map(filename, false, region_min, region_max,
+                                  2, 2, 2, 1, 1);
+  std::remove(filename);
+
+  REQUIRE_FALSE(map.IsBuilding());
+  REQUIRE(map.Cull(5) == 1);
+  REQUIRE_FALSE(map.IsCulled(map.FindCell(seen, up)));
+  REQUIRE      (map.IsCulled(map.FindCell(dark, up)));
+
+  // Too few photons in the dark cell to cull it
+  REQUIRE(map.Cull(6) == 0);
+}
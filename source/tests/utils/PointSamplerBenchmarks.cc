@@ -0,0 +1,55 @@
+#include "BoxPointSampler.h"
+#include "BoxPointSamplerLegacy.h"
+#include "CylinderPointSampler.h"
+#include "CylinderPointSamplerLegacy.h"
+#include "SpherePointSampler.h"
+#include "PolygonPointSampler.h"
+#include "SegmentPointSampler.h"
+#include "RandomUtils.h"
+
+#include <G4SystemOfUnits.hh>
+
+#include <catch.hpp>
+
+// Benchmarks of the vertex generation of the point samplers.
+// They are built into nexus-test-bench.
+
+TEST_CASE("PointSampler benchmarks", "[bench]") {
+
+  auto box = nexus::BoxPointSampler(100.*mm, 150.*mm, 200.*mm, 5.*mm);
+
+  BENCHMARK("BoxPointSampler VOLUME")     { return box.GenerateVertex(nexus::VOLUME);     };
+  BENCHMARK("BoxPointSampler INSIDE")     { return box.GenerateVertex(nexus::INSIDE);     };
+  BENCHMARK("BoxPointSampler INNER_SURF") { return box.GenerateVertex(nexus::INNER_SURF); };
+
+  auto cylinder = nexus::CylinderPointSampler(200.*mm, 220.*mm, 500.*mm);
+
+  BENCHMARK("CylinderPointSampler VOLUME")     { return cylinder.GenerateVertex(nexus::VOLUME);     };
+  BENCHMARK("CylinderPointSampler OUTER_SURF") { return cylinder.GenerateVertex(nexus::OUTER_SURF); };
+
+  auto sphere = nexus::SpherePointSampler(100.*mm, 110.*mm);
+
+  BENCHMARK("SpherePointSampler VOLUME")     { return sphere.GenerateVertex(nexus::VOLUME);     };
+  BENCHMARK("SpherePointSampler OUTER_SURF") { return sphere.GenerateVertex(nexus::OUTER_SURF); };
+
+  // The inside of the polygon is sampled by rejection
+  auto polygon = nexus::PolygonPointSampler(100.*mm, 110.*mm, 300.*mm, 6);
+
+  BENCHMARK("PolygonPointSampler INSIDE") { return polygon.GenerateVertex(nexus::INSIDE); };
+  BENCHMARK("PolygonPointSampler VOLUME") { return polygon.GenerateVertex(nexus::VOLUME); };
+
+  auto box_legacy = nexus::BoxPointSamplerLegacy(200.*mm, 300.*mm, 400.*mm, 5.*mm);
+
+  BENCHMARK("BoxPointSamplerLegacy INSIDE")     { return box_legacy.GenerateVertex("INSIDE");     };
+  BENCHMARK("BoxPointSamplerLegacy WHOLE_VOL")  { return box_legacy.GenerateVertex("WHOLE_VOL");  };
+
+  auto cylinder_legacy = nexus::CylinderPointSamplerLegacy(200.*mm, 1000.*mm, 20.*mm, 20.*mm);
+
+  BENCHMARK("CylinderPointSamplerLegacy INSIDE")    { return cylinder_legacy.GenerateVertex("INSIDE");    };
+  BENCHMARK("CylinderPointSamplerLegacy WHOLE_VOL") { return cylinder_legacy.GenerateVertex("WHOLE_VOL"); };
+
+  auto segment = nexus::SegmentPointSampler(G4LorentzVector(0., 0., 0., 0.),
+                                            G4LorentzVector(1.*mm, 2.*mm, 3.*mm, 1.*ns));
+
+  BENCHMARK("SegmentPointSampler") { return segment.Shoot(); };
+}
@@ -41,3 +41,77 @@ TEST_CASE("Direction Function") {
   }
 
 }
+
+
+TEST_CASE("Random rounding") {
+
+  // This test checks that RandomUtils::RandomRound returns one of the
+  // two integers around the given value and keeps its mean.
+
+  REQUIRE(nexus::RandomRound(0.) == 0);
+  REQUIRE(nexus::RandomRound(7.) == 7);
+
+  const G4double value = 2.3;
+  const G4int n = 100000;
+
+  G4double sum = 0.;
+  for (G4int i=0; i<n; i++) {
+    G4int rounded = nexus::RandomRound(value);
+    REQUIRE((rounded == 2 || rounded == 3));
+    sum += rounded;
+  }
+
+  // The standard deviation of the mean is sqrt(0.3*0.7/n) ~ 0.0015
+  REQUIRE(sum/n == Approx(value).margin(0.01));
+}
+
+
+TEST_CASE("Alias sampler") {
+
+  // This test checks that RandomUtils::AliasSampler returns the
+  // indices of the entries with the frequencies given by their
+  // weights, and never those of the empty entries.
+
+  std::vector<G4double> weights = {1., 0., 3., 0.5, 10., 0.};
+  G4double total = 0.;
+  for (auto w : weights) total += w;
+
+  nexus::AliasSampler sampler(weights);
+  REQUIRE(sampler.GetSize() == G4int(weights.size()));
+
+  const G4int n = 200000;
+
+  std::vector<G4int> counts(weights.size(), 0);
+  for (G4int i=0; i<n; i++) {
+    G4int index = sampler.Sample();
+    REQUIRE(index >= 0);
+    REQUIRE(index < sampler.GetSize());
+    counts[index]++;
+  }
+
+  // The batched sampling follows the same distribution
+  std::vector<G4int> indices(n);
+  sampler.Sample(indices);
+  std::vector<G4int> batch_counts(weights.size(), 0);
+  for (auto index : indices) {
+    REQUIRE(index >= 0);
+    REQUIRE(index < sampler.GetSize());
+    batch_counts[index]++;
+  }
+
+  for (size_t i=0; i<weights.size(); i++) {
+    // The standard deviation of the frequencies is below 0.0012
+    G4double p = weights[i]/total;
+    REQUIRE(G4double(counts[i])/n       == Approx(p).margin(0.006));
+    REQUIRE(G4double(batch_counts[i])/n == Approx(p).margin(0.006));
+    if (weights[i] == 0.) {
+      REQUIRE(counts[i] == 0);
+      REQUIRE(batch_counts[i] == 0);
+    }
+  }
+
+  // A distribution with a single entry always returns it
+  nexus::AliasSampler single({2.});
+  for (G4int i=0; i<100; i++)
+    REQUIRE(single.Sample() == 0);
+}
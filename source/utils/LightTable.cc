@@ -0,0 +1,194 @@
+// ----------------------------------------------------------------------------
+// nexus | LightTable.cc
+//
+// Light table on a regular 3D grid of points, giving the probability of
+// each sensor to detect a photon (or the mean number of detected photons
+// per ionization electron, for S2 tables) emitted at any of the points.
+// Values between points are trilinearly interpolated.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "LightTable.h"
+
+#include <G4SystemOfUnits.hh>
+#include <Randomize.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+
+namespace nexus {
+
+
+  LightTable::LightTable(const G4String& filename):
+    nbins_(), time_bin_(0.)
+  {
+    ReadFile(filename);
+  }
+
+
+
+  LightTable::~LightTable()
+  {
+  }
+
+
+
+  void LightTable::ReadFile(const G4String& filename)
+  {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+      G4Exception("[LightTable]", "ReadFile()", FatalException,
+                  ("Could not open the light table " + filename).c_str());
+    }
+
+    G4bool binning = false, region = false;
+    std::vector<std::vector<std::pair<G4int, G4float>>> points;
+
+    std::string line;
+    while (std::getline(in, line)) {
+      if (line.empty() || line[0] == '#') continue;
+
+      std::istringstream ss(line);
+      std::string header, value;
+      std::getline(ss, header, ',');
+
+      if (header == "sensor") {
+        Sensor sensor;
+        std::getline(ss, value, ',');
+        sensor.id = std::stoi(value);
+        std::getline(ss, value, ',');
+        sensor.sd_name = value;
+        G4double xyz[3];
+        for (G4int i=0; i<3; ++i) {
+          std::getline(ss, value, ',');
+          xyz[i] = std::stod(value) * mm;
+        }
+        sensor.position.set(xyz[0], xyz[1], xyz[2]);
+        sensors_.push_back(sensor);
+        continue;
+      }
+
+      std::vector<G4double> values;
+      while (std::getline(ss, value, ','))
+        values.push_back(std::stod(value));
+
+      if (header == "binning" && values.size() == 3) {
+        for (G4int i=0; i<3; ++i) nbins_[i] = G4int(values[i]);
+        if (nbins_[0] < 1 || nbins_[1] < 1 || nbins_[2] < 1) break;
+        points.resize(size_t(nbins_[0]) * nbins_[1] * nbins_[2]);
+        binning = true;
+      }
+      else if (header == "time_binning" && values.size() == 1) {
+        time_bin_ = values[0] * ns;
+      }
+      else if (header == "time" && binning && values.size() > 3) {
+        G4int ix = G4int(values[0]), iy = G4int(values[1]), iz = G4int(values[2]);
+        if (ix < 0 || ix >= nbins_[0] ||
+            iy < 0 || iy >= nbins_[1] ||
+            iz < 0 || iz >= nbins_[2]) continue;
+
+        if (time_cdf_.empty()) time_cdf_.resize(points.size());
+        auto& cdf = time_cdf_[(size_t(ix) * nbins_[1] + iy) * nbins_[2] + iz];
+        G4double sum = 0.;
+        for (size_t i=3; i<values.size(); ++i) {
+          sum += values[i];
+          cdf.push_back(sum);
+        }
+        if (sum <= 0.) cdf.clear();
+        for (auto& c : cdf) c /= sum;
+      }
+      else if (header == "region" && values.size() == 6) {
+        region_min_.set(values[0]*mm, values[1]*mm, values[2]*mm);
+        region_max_.set(values[3]*mm, values[4]*mm, values[5]*mm);
+        region = true;
+      }
+      else if (header == "point" && binning &&
+               values.size() == 3 + sensors_.size()) {
+        G4int ix = G4int(values[0]), iy = G4int(values[1]), iz = G4int(values[2]);
+        if (ix < 0 || ix >= nbins_[0] ||
+            iy < 0 || iy >= nbins_[1] ||
+            iz < 0 || iz >= nbins_[2]) continue;
+
+        auto& point = points[(size_t(ix) * nbins_[1] + iy) * nbins_[2] + iz];
+        for (size_t i=0; i<sensors_.size(); ++i)
+          if (values[3+i] > 0.) point.emplace_back(i, values[3+i]);
+      }
+    }
+
+    in.close();
+
+    if (!time_cdf_.empty() && time_bin_ <= 0.) {
+      G4Exception("[LightTable]", "ReadFile()", FatalException,
+                  ("The light table " + filename +
+                   " has time distributions but no valid time binning.").c_str());
+    }
+
+    if (!binning || !region || sensors_.empty()) {
+      G4Exception("[LightTable]", "ReadFile()", FatalException,
+                  ("The light table " + filename +
+                   " lacks its sensors, binning or region.").c_str());
+    }
+
+    // Only the non-zero values are kept, contiguously
+    first_.reserve(points.size() + 1);
+    first_.push_back(0);
+    for (const auto& point : points) {
+      for (const auto& value : point) {
+        sensor_.push_back(value.first);
+        value_ .push_back(value.second);
+      }
+      first_.push_back(sensor_.size());
+    }
+  }
+
+
+
+  G4bool LightTable::Locate(const G4ThreeVector& pos,
+                            G4int* index, G4double* frac) const
+  {
+    for (G4int axis=0; axis<3; ++axis) {
+      index[axis] = 0;
+      frac [axis] = 0.;
+
+      // Constant along axes with a single point
+      if (nbins_[axis] == 1) continue;
+
+      G4double step = (region_max_[axis] - region_min_[axis]) / (nbins_[axis] - 1);
+      G4double t = (pos[axis] - region_min_[axis]) / step;
+      if (t < 0. || t > nbins_[axis] - 1) return false;
+
+      index[axis] = std::min(G4int(t), nbins_[axis] - 2);
+      frac [axis] = t - index[axis];
+    }
+    return true;
+  }
+
+
+
+  G4double LightTable::SampleArrivalTime(const G4ThreeVector& pos) const
+  {
+    if (time_cdf_.empty()) return 0.;
+
+    G4int index[3];
+    G4double frac[3];
+    if (!Locate(pos, index, frac)) return 0.;
+
+    G4int point[3];
+    for (G4int axis=0; axis<3; ++axis)
+      point[axis] = index[axis] + (frac[axis] > 0.5 ? 1 : 0);
+
+    const auto& cdf =
+      time_cdf_[(size_t(point[0]) * nbins_[1] + point[1]) * nbins_[2] + point[2]];
+    if (cdf.empty()) return 0.;
+
+    // Uniform within the sampled bin
+    size_t bin = std::lower_bound(cdf.begin(), cdf.end(), G4UniformRand()) - cdf.begin();
+    bin = std::min(bin, cdf.size() - 1);
+    return (bin + G4UniformRand()) * time_bin_;
+  }
+
+
+} // end namespace nexus
@@ -0,0 +1,124 @@
+// ----------------------------------------------------------------------------
+// nexus | LightTable.h
+//
+// Light table on a regular 3D grid of points, giving the probability of
+// each sensor to detect a photon (or the mean number of detected photons
+// per ionization electron, for S2 tables) emitted at any of the points.
+// Values between points are trilinearly interpolated.
+//
+// The table is read from a csv file with the following rows:
+//   sensor,<id>,<sensitive detector name>,<x>,<y>,<z>   (one per sensor, mm)
+//   binning,<nx>,<ny>,<nz>
+//   region,<xmin>,<ymin>,<zmin>,<xmax>,<ymax>,<zmax>   (mm)
+//   point,<ix>,<iy>,<iz>,<value of sensor 0>,<value of sensor 1>,...
+// The points are at the edges of the region (at its center for axes
+// with a single point, along which the table is taken as constant).
+// Optionally, the distribution of the arrival times of the photons
+// emitted at each point can be given with the rows:
+//   time_binning,<bin width>   (ns)
+//   time,<ix>,<iy>,<iz>,<value of bin 0>,<value of bin 1>,...
+// Lines starting with # are ignored.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef LIGHT_TABLE_H
+#define LIGHT_TABLE_H
+
+#include <G4ThreeVector.hh>
+#include <globals.hh>
+
+#include <vector>
+
+
+namespace nexus {
+
+  class LightTable
+  {
+  public:
+    struct Sensor {
+      G4int id;
+      G4String sd_name;
+      G4ThreeVector position;
+    };
+
+  public:
+    /// Constructor reading the table from a file
+    LightTable(const G4String& filename);
+    /// Destructor
+    ~LightTable();
+
+    const std::vector<Sensor>& GetSensors() const;
+
+    /// True if the point is covered by the table
+    G4bool Contains(const G4ThreeVector& pos) const;
+
+    /// Call f(sensor index, value) for the sensors with a non-zero value
+    /// at the given point. A sensor may be reported more than once,
+    /// in which case its values add up.
+    template <typename F>
+    void ForEachSensor(const G4ThreeVector& pos, F&& f) const;
+
+    /// Random arrival time of a photon emitted at the given point, taken
+    /// from the distribution of the closest point. Zero if the table
+    /// has no time distributions.
+    G4double SampleArrivalTime(const G4ThreeVector& pos) const;
+
+  private:
+    void ReadFile(const G4String& filename);
+
+    /// Lower grid point of the cell containing pos, and the
+    /// fractional position in the cell. False if pos is outside.
+    G4bool Locate(const G4ThreeVector& pos, G4int* index, G4double* frac) const;
+
+  private:
+    std::vector<Sensor> sensors_;
+
+    G4int nbins_[3];
+    G4ThreeVector region_min_, region_max_;
+
+    // Non-zero values, stored point after point
+    std::vector<size_t> first_;  ///< First value of each point
+    std::vector<G4int> sensor_;  ///< Sensor index of each value
+    std::vector<G4float> value_;
+
+    G4double time_bin_; ///< Width of the bins of the time distributions
+    std::vector<std::vector<G4double>> time_cdf_; ///< Cumulative time distribution of each point
+  };
+
+
+  // INLINE DEFINITIONS //////////////////////////////////////////////
+
+  inline const std::vector<LightTable::Sensor>& LightTable::GetSensors() const
+  { return sensors_; }
+
+  inline G4bool LightTable::Contains(const G4ThreeVector& pos) const
+  { G4int index[3]; G4double frac[3]; return Locate(pos, index, frac); }
+
+  template <typename F>
+  void LightTable::ForEachSensor(const G4ThreeVector& pos, F&& f) const
+  {
+    G4int index[3];
+    G4double frac[3];
+    if (!Locate(pos, index, frac)) return;
+
+    // Loop over the corners of the cell
+    for (G4int corner=0; corner<8; ++corner) {
+      G4double weight = 1.;
+      G4int point[3];
+      for (G4int axis=0; axis<3; ++axis) {
+        G4bool upper = (corner >> axis) & 1;
+        weight *= upper ? frac[axis] : 1. - frac[axis];
+        point[axis] = index[axis] + upper;
+      }
+      if (weight <= 0.) continue;
+
+      size_t ipoint = (size_t(point[0]) * nbins_[1] + point[1]) * nbins_[2] + point[2];
+      for (size_t k=first_[ipoint]; k<first_[ipoint+1]; ++k)
+        f(sensor_[k], weight * value_[k]);
+    }
+  }
+
+} // end namespace nexus
+
+#endif
@@ -0,0 +1,229 @@
+// ----------------------------------------------------------------------------
+// nexus | OpticalAcceptanceMap.cc
+//
+// Map of the fraction of the optical photons emitted from each
+// (position, direction) cell that reach a sensor. It is built during a
+// calibration run, in which the sensitive detectors report the detected
+// photons to it, and cached in a file.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#include "OpticalAcceptanceMap.h"
+
+#include <G4Track.hh>
+#include <G4SystemOfUnits.hh>
+#include <G4PhysicalConstants.hh>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+
+namespace nexus {
+
+
+  OpticalAcceptanceMap* OpticalAcceptanceMap::building_map_ = 0;
+
+
+
+  OpticalAcceptanceMap::OpticalAcceptanceMap(const G4String& filename, G4bool rebuild,
+                                             const G4ThreeVector& region_min,
+                                             const G4ThreeVector& region_max,
+                                             G4int nx, G4int ny, G4int nz,
+                                             G4int ncostheta, G4int nphi):
+    filename_(filename), region_min_(region_min), region_max_(region_max),
+    nx_(nx), ny_(ny), nz_(nz), ncostheta_(ncostheta), nphi_(nphi), building_(false)
+  {
+    if (nx_ < 1 || ny_ < 1 || nz_ < 1 || ncostheta_ < 1 || nphi_ < 1 ||
+        region_min_.x() >= region_max_.x() ||
+        region_min_.y() >= region_max_.y() ||
+        region_min_.z() >= region_max_.z()) {
+      G4Exception("[OpticalAcceptanceMap]", "OpticalAcceptanceMap()",
+                  FatalException, "The region or binning of the acceptance map is not valid.");
+    }
+
+    const size_t ncells = size_t(nx_) * ny_ * nz_ * ncostheta_ * nphi_;
+    emitted_ .assign(ncells, 0);
+    detected_.assign(ncells, 0);
+
+    std::ifstream cached(filename_);
+    building_ = rebuild || !cached.good();
+    cached.close();
+
+    if (building_) building_map_ = this;
+    else Load();
+  }
+
+
+
+  OpticalAcceptanceMap::~OpticalAcceptanceMap()
+  {
+    if (building_) {
+      Save();
+      building_map_ = 0;
+    }
+  }
+
+
+
+  G4int OpticalAcceptanceMap::Cull(G4int min_photons)
+  {
+    culled_.assign(emitted_.size(), 0);
+    G4int nculled = 0;
+    for (size_t i=0; i<emitted_.size(); ++i) {
+      if (emitted_[i] >= min_photons && detected_[i] == 0) {
+        culled_[i] = 1;
+        ++nculled;
+      }
+    }
+    return nculled;
+  }
+
+
+
+  G4int OpticalAcceptanceMap::FindCell(const G4ThreeVector& pos,
+                                       const G4ThreeVector& dir) const
+  {
+    G4ThreeVector rel = pos - region_min_;
+    G4ThreeVector size = region_max_ - region_min_;
+
+    G4int ix = G4int(rel.x() / size.x() * nx_);
+    G4int iy = G4int(rel.y() / size.y() * ny_);
+    G4int iz = G4int(rel.z() / size.z() * nz_);
+
+    if (rel.x() < 0. || ix >= nx_ ||
+        rel.y() < 0. || iy >= ny_ ||
+        rel.z() < 0. || iz >= nz_) return -1;
+
+    G4int icos = std::min(G4int(0.5 * (dir.cosTheta() + 1.) * ncostheta_), ncostheta_ - 1);
+    G4int iphi = std::min(G4int((dir.phi() + pi) / twopi * nphi_), nphi_ - 1);
+
+    return (((ix * ny_ + iy) * nz_ + iz) * ncostheta_ + icos) * nphi_ + iphi;
+  }
+
+
+
+  void OpticalAcceptanceMap::RegisterPhoton(const G4Track* track, G4bool reemitted)
+  {
+    G4int id = track->GetTrackID();
+    if (reemitted) {
+      auto parent = ancestor_.find(track->GetParentID());
+      if (parent != ancestor_.end()) ancestor_[id] = parent->second;
+      return;
+    }
+
+    G4int cell = FindCell(track->GetPosition(), track->GetMomentumDirection());
+    if (cell >= 0) {
+      ancestor_[id] = id;
+      cell_[id] = cell;
+      ++emitted_[cell];
+    }
+  }
+
+
+
+  void OpticalAcceptanceMap::RecordDetection(G4int track_id)
+  {
+    auto it = ancestor_.find(track_id);
+    if (it == ancestor_.end()) return;
+
+    // Each emitted photon counts once, however many of its
+    // reemissions or steps reach a sensor
+    if (seen_.insert(it->second).second)
+      ++detected_[cell_[it->second]];
+  }
+
+
+
+  void OpticalAcceptanceMap::ClearEvent()
+  {
+    ancestor_.clear();
+    cell_.clear();
+    seen_.clear();
+  }
+
+
+
+  void OpticalAcceptanceMap::DiscardEvent()
+  {
+    for (const auto& emitted : cell_) --emitted_[emitted.second];
+    ClearEvent();
+  }
+
+
+
+  void OpticalAcceptanceMap::Save() const
+  {
+    std::ofstream out(filename_);
+    if (!out.is_open()) {
+      G4Exception("[OpticalAcceptanceMap]", "Save()",
+                  JustWarning, ("Could not write the acceptance map to " + filename_).c_str());
+      return;
+    }
+
+    out << "binning," << nx_ << "," << ny_ << "," << nz_ << ","
+        << ncostheta_ << "," << nphi_ << "\n";
+    out << "region," << region_min_.x()/mm << "," << region_min_.y()/mm << ","
+        << region_min_.z()/mm << "," << region_max_.x()/mm << ","
+        << region_max_.y()/mm << "," << region_max_.z()/mm << "\n";
+
+    for (size_t i=0; i<emitted_.size(); ++i) {
+      if (emitted_[i] == 0) continue;
+      out << "cell," << i << "," << emitted_[i] << "," << detected_[i] << "\n";
+    }
+
+    out.close();
+  }
+
+
+
+  void OpticalAcceptanceMap::Load()
+  {
+    std::ifstream in(filename_);
+    if (!in.is_open()) {
+      G4Exception("[OpticalAcceptanceMap]", "Load()",
+                  FatalException, ("Could not read the acceptance map " + filename_).c_str());
+    }
+
+    // The map is only valid for the binning it was built with
+    G4bool binning_ok = false, region_ok = false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+      std::istringstream ss(line);
+      std::string header, value;
+      std::getline(ss, header, ',');
+
+      std::vector<G4double> values;
+      while (std::getline(ss, value, ','))
+        values.push_back(std::stod(value));
+
+      if (header == "binning" && values.size() == 5) {
+        binning_ok = (values[0] == nx_ && values[1] == ny_ && values[2] == nz_ &&
+                      values[3] == ncostheta_ && values[4] == nphi_);
+      }
+      else if (header == "region" && values.size() == 6) {
+        G4ThreeVector vmin(values[0]*mm, values[1]*mm, values[2]*mm);
+        G4ThreeVector vmax(values[3]*mm, values[4]*mm, values[5]*mm);
+        region_ok = ((vmin - region_min_).mag() < 1.e-3*mm &&
+                     (vmax - region_max_).mag() < 1.e-3*mm);
+      }
+      else if (header == "cell" && values.size() == 3) {
+        size_t i = size_t(values[0]);
+        if (i >= emitted_.size()) continue;
+        emitted_[i]  = G4long(values[1]);
+        detected_[i] = G4long(values[2]);
+      }
+    }
+
+    in.close();
+
+    if (!binning_ok || !region_ok) {
+      G4Exception("[OpticalAcceptanceMap]", "Load()", FatalException,
+                  ("The acceptance map " + filename_ +
+                   " was built with a different region or binning.").c_str());
+    }
+  }
+
+} // end namespace nexus
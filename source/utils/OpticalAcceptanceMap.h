@@ -0,0 +1,109 @@
+// ----------------------------------------------------------------------------
+// nexus | OpticalAcceptanceMap.h
+//
+// Map of the fraction of the optical photons emitted from each
+// (position, direction) cell that reach a sensor. It is built during a
+// calibration run, in which the sensitive detectors report the detected
+// photons to it, and cached in a file.
+//
+// The NEXT Collaboration
+// ----------------------------------------------------------------------------
+
+#ifndef OPTICAL_ACCEPTANCE_MAP_H
+#define OPTICAL_ACCEPTANCE_MAP_H
+
+#include <G4ThreeVector.hh>
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+
+class G4Track;
+
+
+namespace nexus {
+
+  class OpticalAcceptanceMap
+  {
+  public:
+    /// Constructor. The map is read from the given file, unless it does
+    /// not exist or a rebuild is requested, in which case it is built.
+    OpticalAcceptanceMap(const G4String& filename, G4bool rebuild,
+                         const G4ThreeVector& region_min,
+                         const G4ThreeVector& region_max,
+                         G4int nx, G4int ny, G4int nz,
+                         G4int ncostheta, G4int nphi);
+    /// Destructor. The map is saved here if it has been built.
+    ~OpticalAcceptanceMap();
+
+    /// Map being built, if any. Sensitive detectors
+    /// report the detected photons to it.
+    static OpticalAcceptanceMap* Building();
+
+    G4bool IsBuilding() const;
+
+    /// Mark as culled the cells from which at least min_photons photons
+    /// have been emitted and none was detected. Returns how many they are.
+    G4int Cull(G4int min_photons);
+
+    /// True if no photon emitted from the cell is expected to be detected
+    G4bool IsCulled(G4int cell) const;
+
+    /// Index of the (position, direction) cell of a photon,
+    /// or -1 if it is outside the mapped region
+    G4int FindCell(const G4ThreeVector& pos, const G4ThreeVector& dir) const;
+
+    /// Count a new optical photon while building the map. Photons
+    /// reemitted by wavelength shifting count as their ancestor.
+    void RegisterPhoton(const G4Track*, G4bool reemitted);
+
+    /// Record that an optical photon has reached a sensor
+    void RecordDetection(G4int track_id);
+
+    /// Forget the photons of the current event
+    void ClearEvent();
+
+    /// Take back the photons of the current event, which were not tracked
+    void DiscardEvent();
+
+    /// Number of cells
+    size_t GetNumberOfCells() const;
+
+  private:
+    void Load();
+    void Save() const;
+
+  private:
+    G4String filename_;
+    G4ThreeVector region_min_, region_max_;
+    G4int nx_, ny_, nz_;
+    G4int ncostheta_, nphi_;
+    G4bool building_;
+
+    std::vector<G4long> emitted_;  ///< Photons emitted per cell
+    std::vector<G4long> detected_; ///< Photons (or their reemissions) detected per cell
+    std::vector<char> culled_;     ///< Cells with no detected photons
+
+    // Bookkeeping of the current event while building the map
+    std::unordered_map<G4int, G4int> ancestor_; ///< Photon track ID -> emitted photon
+    std::unordered_map<G4int, G4int> cell_;     ///< Emitted photon -> cell
+    std::unordered_set<G4int> seen_;            ///< Emitted photons already detected
+
+    static OpticalAcceptanceMap* building_map_;
+  };
+
+  inline OpticalAcceptanceMap* OpticalAcceptanceMap::Building()
+  { return building_map_; }
+
+  inline G4bool OpticalAcceptanceMap::IsBuilding() const
+  { return building_; }
+
+  inline G4bool OpticalAcceptanceMap::IsCulled(G4int cell) const
+  { return cell >= 0 && !culled_.empty() && culled_[cell]; }
+
+  inline size_t OpticalAcceptanceMap::GetNumberOfCells() const
+  { return emitted_.size(); }
+
+} // end namespace nexus
+
+#endif
@@ -34,12 +34,6 @@ namespace nexus {
                           cosTheta).unit();
   }
 
-  G4int GetRandBinIndex(G4RandGeneral *fRandomGeneral, std::vector<G4double> intensity){
-
-    return round(fRandomGeneral->fire()*intensity.size());
-
-  }
-
   G4double Sample(G4double sample, G4bool smear, G4double smearval){
 
     // Apply Gaussian smearing to smooth from bin-to-bin
@@ -52,6 +46,13 @@ namespace nexus {
 
   }
 
+  G4int RandomRound(G4double value){
+
+    G4int n = G4int(value);
+    return (G4UniformRand() < value - n) ? n + 1 : n;
+
+  }
+
   G4bool CheckOutOfBound(G4double min, G4double max, G4double val){
 
     // Out of bounds
@@ -85,4 +86,74 @@ namespace nexus {
 
   }
 
+
+
+  AliasSampler::AliasSampler()
+  {
+  }
+
+  AliasSampler::AliasSampler(const std::vector<G4double>& weights)
+  {
+    SetWeights(weights);
+  }
+
+  void AliasSampler::SetWeights(const std::vector<G4double>& weights){
+
+    G4int n = weights.size();
+
+    G4double total = 0.;
+    for (auto w : weights) {
+      if (w < 0.)
+        G4Exception("[AliasSampler]", "SetWeights()", FatalException,
+                    "Negative weight in the distribution to sample.");
+      total += w;
+    }
+    if (total <= 0.)
+      G4Exception("[AliasSampler]", "SetWeights()", FatalException,
+                  "The distribution to sample is empty.");
+
+    prob_.assign(n, 1.);
+    alias_.resize(n);
+    for (G4int i=0; i<n; i++) alias_[i] = i;
+
+    // Weights scaled to a mean of one, split into the entries
+    // below and above the mean, which are paired to fill the columns
+    std::vector<G4double> scaled(n);
+    std::vector<G4int> small, large;
+    for (G4int i=0; i<n; i++) {
+      scaled[i] = weights[i] * n / total;
+      if (scaled[i] < 1.) small.push_back(i);
+      else                large.push_back(i);
+    }
+
+    while (!small.empty() && !large.empty()) {
+      G4int s = small.back(); small.pop_back();
+      G4int l = large.back();
+
+      prob_[s]  = scaled[s];
+      alias_[s] = l;
+
+      scaled[l] -= 1. - scaled[s];
+      if (scaled[l] < 1.) {
+        large.pop_back();
+        small.push_back(l);
+      }
+    }
+
+    // The remaining entries are full up to rounding errors
+    for (auto i : small) prob_[i] = 1.;
+    for (auto i : large) prob_[i] = 1.;
+
+  }
+
+  void AliasSampler::Sample(std::vector<G4int>& indices) const{
+
+    std::vector<G4double> rnd(indices.size());
+    G4Random::getTheEngine()->flatArray(rnd.size(), rnd.data());
+
+    for (size_t i=0; i<indices.size(); i++)
+      indices[i] = Pick(rnd[i]);
+
+  }
+
 }
@@ -10,6 +10,9 @@
 
 #include <Randomize.hh>
 
+#include <vector>
+#include <algorithm>
+
 
 #ifndef RAND_U_H
 #define RAND_U_H
@@ -21,12 +24,13 @@ namespace nexus {
     G4ThreeVector RandomDirectionInRange(G4double costheta_min, G4double costheta_max,
                                        G4double phi_min, G4double phi_max);
 
-    /// Get the random bin index of histogram distribution
-    G4int GetRandBinIndex(G4RandGeneral *fRandomGeneral, std::vector<G4double> value);
-
     /// Get the value of the random sample
     G4double Sample(G4double sample, G4bool smear, G4double smearval);
 
+    /// Round a non-negative value up or down at random, with the
+    /// probabilities that keep its mean (e.g., 2.3 gives 3 30% of the time)
+    G4int RandomRound(G4double value);
+
     /// Check if the sampled value is out of bounds
     G4bool CheckOutOfBound(G4double min, G4double max, G4double val);
     
@@ -39,6 +43,56 @@ namespace nexus {
   enum vtx_region {VOLUME, INSIDE, INNER_SURF, OUTER_SURF, CENTER};
 
 
+  /// Sampler of the index of a discrete distribution (e.g., the bins
+  /// of a histogram), given the weights of its entries. It uses the
+  /// alias method of Walker and Vose, which draws one random number
+  /// per sample and takes the same time whatever the number of entries.
+
+  class AliasSampler
+  {
+  public:
+    /// Constructor of an empty sampler, to be set with SetWeights
+    AliasSampler();
+    /// Constructor, given the (non-negative) weights of the entries
+    AliasSampler(const std::vector<G4double>& weights);
+
+    /// Build the tables for the given weights
+    void SetWeights(const std::vector<G4double>& weights);
+
+    /// Returns an index in [0, size) with a
+    /// probability proportional to its weight
+    G4int Sample() const;
+
+    /// Fill the vector with indices sampled as above,
+    /// drawing all the random numbers needed at once
+    void Sample(std::vector<G4int>& indices) const;
+
+    /// Returns the number of entries of the distribution
+    G4int GetSize() const;
+
+  private:
+    G4int Pick(G4double rnd) const;
+
+  private:
+    std::vector<G4double> prob_; ///< Probability of keeping each entry
+    std::vector<G4int> alias_;   ///< Entry chosen otherwise
+  };
+
+  inline G4int AliasSampler::GetSize() const { return prob_.size(); }
+
+  inline G4int AliasSampler::Pick(G4double rnd) const
+  {
+    // The integer part of rnd*size selects an entry uniformly
+    // and the fractional part decides between it and its alias
+    G4double u = rnd * prob_.size();
+    G4int i = std::min(G4int(u), G4int(prob_.size()) - 1);
+    return (u - i < prob_[i]) ? i : alias_[i];
+  }
+
+  inline G4int AliasSampler::Sample() const { return Pick(G4UniformRand()); }
+
+
+
 }
 
 #endif